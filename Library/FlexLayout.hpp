@@ -1,9 +1,14 @@
 ﻿#pragma once
 #include "FlexLayout/Box.hpp"
+#include "FlexLayout/BoxRef.hpp"
+#include "FlexLayout/BoxRange.hpp"
 #include "FlexLayout/UIBox.hpp"
 #include "FlexLayout/Label.hpp"
 #include "FlexLayout/Layout.hpp"
 #include "FlexLayout/Util/StyleValueHelper.hpp"
 #include "FlexLayout/Libraries.hpp"
 #include "FlexLayout/SimpleGUI.hpp"
+#include "FlexLayout/VirtualList.hpp"
 #include "FlexLayout/Debugger.hpp"
+#include "FlexLayout/MemoryReport.hpp"
+#include "FlexLayout/LayoutSnapshot.hpp"
@@ -1,5 +1,8 @@
 ﻿#include "Box.hpp"
+#include <limits>
+#include <utility>
 #include "Label.hpp"
+#include "BoxRange.hpp"
 #include "Internal/FlexBoxNode.hpp"
 
 #include "Internal/NodeComponent/LayoutComponent.hpp"
@@ -34,6 +37,27 @@ namespace FlexLayout
 			.setPropergateOffset(propergate);
 	}
 
+	Vec2 Box::scrollOffset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.scrollOffset();
+	}
+
+	void Box::setScrollOffset(Vec2 scrollOffset)
+	{
+		m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.setScrollOffset(scrollOffset);
+	}
+
+	Vec2 Box::maxScrollOffset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.maxScrollOffset();
+	}
+
 	Thickness Box::margin() const
 	{
 		return m_node
@@ -279,6 +303,31 @@ namespace FlexLayout
 		return !m_node->children().isEmpty();
 	}
 
+	ChildBoxRange Box::childRange() const
+	{
+		return ChildBoxRange{ *m_node };
+	}
+
+	DescendantBoxRange Box::descendants() const
+	{
+		return DescendantBoxRange{ *m_node };
+	}
+
+	PostOrderDescendantBoxRange Box::descendantsPostOrder() const
+	{
+		return PostOrderDescendantBoxRange{ *m_node };
+	}
+
+	AncestorBoxRange Box::ancestors() const
+	{
+		return AncestorBoxRange{ *m_node };
+	}
+
+	SiblingBoxRange Box::siblings() const
+	{
+		return SiblingBoxRange{ *m_node };
+	}
+
 	Box Box::removeChild(Box child)
 	{
 		m_node->removeChild(child.m_node);
@@ -290,6 +339,67 @@ namespace FlexLayout
 		m_node->setChildren(newChildren.map([](const auto& child) { return child.m_node; }));
 	}
 
+	void Box::reconcileChildren(
+		const s3d::Array<s3d::String>& keys,
+		const std::function<Box(s3d::StringView key)>& create,
+		const std::function<void(Box& child, s3d::StringView key)>& update)
+	{
+		assert(create);
+
+		constexpr size_t NoChild = std::numeric_limits<size_t>::max();
+
+		// 既存の子ノードをキーで検索できるようにする
+		// 同じキーの子ノードは出現順に連結し、先頭から順に再利用する
+		const auto& children = m_node->children();
+		HashTable<String, size_t> existing(children.size());
+		Array<size_t> nextSameKey(children.size(), NoChild);
+		for (size_t i = children.size(); i-- > 0;)
+		{
+			if (auto key = children[i]->getProperty(U"key"))
+			{
+				if (auto [itr, inserted] = existing.emplace(std::move(*key), i); not inserted)
+				{
+					nextSameKey[i] = std::exchange(itr->second, i);
+				}
+			}
+		}
+
+		Array<std::shared_ptr<Internal::FlexBoxNode>> newChildren(Arg::reserve = keys.size());
+		for (const auto& key : keys)
+		{
+			if (auto itr = existing.find(key); itr != existing.end())
+			{
+				const size_t index = itr->second;
+				newChildren.push_back(children[index]);
+
+				if (nextSameKey[index] == NoChild)
+				{
+					existing.erase(itr);
+				}
+				else
+				{
+					itr->second = nextSameKey[index];
+				}
+				continue;
+			}
+
+			auto node = create(key).m_node;
+			node->setProperty(U"key", key);
+			newChildren.push_back(std::move(node));
+		}
+
+		m_node->reconcileChildren(newChildren);
+
+		if (update)
+		{
+			for (auto [idx, key] : Indexed(keys))
+			{
+				Box child{ newChildren[idx] };
+				update(child, key);
+			}
+		}
+	}
+
 	s3d::String Box::textContent() const
 	{
 		if (m_node->isTextNode())
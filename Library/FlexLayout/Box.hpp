@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <functional>
 #include <Siv3D/Font.hpp>
 #include "Style/StyleValue.hpp"
 #include "Thickness.hpp"
@@ -11,6 +12,25 @@ namespace FlexLayout
 		struct Accessor;
 	}
 	class Label;
+	class BoxRef;
+
+	template <class Traversal>
+	class BoxRange;
+
+	namespace detail
+	{
+		struct ChildTraversal;
+		struct SiblingTraversal;
+		struct AncestorTraversal;
+		struct PreOrderTraversal;
+		struct PostOrderTraversal;
+	}
+
+	using ChildBoxRange = BoxRange<detail::ChildTraversal>;
+	using SiblingBoxRange = BoxRange<detail::SiblingTraversal>;
+	using AncestorBoxRange = BoxRange<detail::AncestorTraversal>;
+	using DescendantBoxRange = BoxRange<detail::PreOrderTraversal>;
+	using PostOrderDescendantBoxRange = BoxRange<detail::PostOrderTraversal>;
 
 	class UIState;
 	template <class State>
@@ -39,6 +59,17 @@ namespace FlexLayout
 		/// @details falseの場合、子要素のオフセットの基準位置を{ 0, 0 }にします。Transform2Dなどユーザーが座標変換を行う際に無効にします。
 		void setPropergateOffset(bool propergate);
 
+		/// @brief スクロール量を取得する
+		s3d::Vec2 scrollOffset() const;
+
+		/// @brief スクロール量を設定する
+		/// @details overflowがscrollまたはhiddenの場合に子要素の表示位置をずらします。レイアウトの再計算は行わず、子要素のオフセットのみ更新します。
+		/// @remark 値は0から`maxScrollOffset()`の範囲に制限されます
+		void setScrollOffset(s3d::Vec2 scrollOffset);
+
+		/// @brief スクロール可能な最大量を取得する
+		s3d::Vec2 maxScrollOffset() const;
+
 		/// @brief マージンの計算幅を取得
 		Thickness margin() const;
 
@@ -163,6 +194,22 @@ namespace FlexLayout
 		/// @brief 子ノードを取得する
 		s3d::Array<Box> children() const;
 
+		/// @brief 子ノードを順に辿る範囲を取得する
+		/// @remark `children()`と異なり、配列を作成しません
+		ChildBoxRange childRange() const;
+
+		/// @brief 自身を除く子孫ノードを行きがけ順に辿る範囲を取得する
+		DescendantBoxRange descendants() const;
+
+		/// @brief 自身を除く子孫ノードを帰りがけ順に辿る範囲を取得する
+		PostOrderDescendantBoxRange descendantsPostOrder() const;
+
+		/// @brief 親ノードからルート要素までを辿る範囲を取得する
+		AncestorBoxRange ancestors() const;
+
+		/// @brief 自身を除く兄弟ノードを辿る範囲を取得する
+		SiblingBoxRange siblings() const;
+
 		/// @brief 子ノードをすべて削除する
 		void removeChildren();
 
@@ -213,6 +260,18 @@ namespace FlexLayout
 			replaceChildren({ newChildren... });
 		}
 
+		/// @brief キーに対応する子ノードを再利用しながら子ノードを構築し直す
+		/// @remark 子ノードのキーは`key`属性に保存されます。既存の子ノードは切り離さずに並べ替えられるため、スタイルの再適用やレイアウト結果の破棄が発生しません
+		/// @param keys 新しい子ノードのキー (重複したキーは、同じキーを持つ既存の子ノードと出現順に対応付けられます)
+		/// @param create 既存の子ノードが存在しないキーに対して、新しいノードを生成する関数
+		/// @param update 並べ替えの後、各子ノードの内容を更新する関数 (省略可)
+		/// @throw FlexLayout::InvalidTreeOperationError 不正なツリーを作成した場合
+		void reconcileChildren(
+			const s3d::Array<s3d::String>& keys,
+			const std::function<Box(s3d::StringView key)>& create,
+			const std::function<void(Box& child, s3d::StringView key)>& update = nullptr
+		);
+
 		// Text
 
 		s3d::String textContent() const;
@@ -267,6 +326,8 @@ namespace FlexLayout
 
 		friend Internal::Accessor;
 
+		friend BoxRef;
+
 		std::shared_ptr<Internal::FlexBoxNode> m_node;
 
 	private:
@@ -0,0 +1,142 @@
+﻿#include "BoxRange.hpp"
+#include "Internal/FlexBoxNode.hpp"
+#include "Internal/NodeComponent/XmlAttributeComponent.hpp"
+#include "Internal/NodeComponent/UIComponent.hpp"
+
+namespace FlexLayout::detail
+{
+	static Internal::FlexBoxNode* FirstChild(const Internal::FlexBoxNode& node)
+	{
+		const auto& children = node.children();
+		return children.isEmpty() ? nullptr : children.front().get();
+	}
+
+	/// @brief 最初の子要素を葉まで辿る
+	static Internal::FlexBoxNode* FirstLeaf(Internal::FlexBoxNode* node)
+	{
+		while (auto child = FirstChild(*node))
+		{
+			node = child;
+		}
+		return node;
+	}
+
+	Internal::FlexBoxNode* ChildTraversal::First(const Internal::FlexBoxNode& origin)
+	{
+		return FirstChild(origin);
+	}
+
+	Internal::FlexBoxNode* ChildTraversal::Next(const Internal::FlexBoxNode&, const Internal::FlexBoxNode& current)
+	{
+		return current.nextSibling();
+	}
+
+	Internal::FlexBoxNode* SiblingTraversal::First(const Internal::FlexBoxNode& origin)
+	{
+		auto parent = origin.parent();
+		if (not parent)
+		{
+			return nullptr;
+		}
+
+		auto first = FirstChild(*parent);
+		return first == &origin ? origin.nextSibling() : first;
+	}
+
+	Internal::FlexBoxNode* SiblingTraversal::Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current)
+	{
+		auto next = current.nextSibling();
+		return next == &origin ? origin.nextSibling() : next;
+	}
+
+	Internal::FlexBoxNode* AncestorTraversal::First(const Internal::FlexBoxNode& origin)
+	{
+		return origin.parent();
+	}
+
+	Internal::FlexBoxNode* AncestorTraversal::Next(const Internal::FlexBoxNode&, const Internal::FlexBoxNode& current)
+	{
+		return current.parent();
+	}
+
+	Internal::FlexBoxNode* PreOrderTraversal::First(const Internal::FlexBoxNode& origin)
+	{
+		return FirstChild(origin);
+	}
+
+	Internal::FlexBoxNode* PreOrderTraversal::Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current)
+	{
+		if (auto child = FirstChild(current))
+		{
+			return child;
+		}
+
+		// 次の兄弟要素が見つかるまで親要素へ戻る
+		for (auto node = &current; node != &origin; node = node->parent())
+		{
+			if (auto sibling = node->nextSibling())
+			{
+				return sibling;
+			}
+		}
+
+		return nullptr;
+	}
+
+	Internal::FlexBoxNode* PostOrderTraversal::First(const Internal::FlexBoxNode& origin)
+	{
+		auto child = FirstChild(origin);
+		return child ? FirstLeaf(child) : nullptr;
+	}
+
+	Internal::FlexBoxNode* PostOrderTraversal::Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current)
+	{
+		if (auto sibling = current.nextSibling())
+		{
+			return FirstLeaf(sibling);
+		}
+
+		auto parent = current.parent();
+		return parent == &origin ? nullptr : parent;
+	}
+
+	bool BoxFilter::matches(const Internal::FlexBoxNode& node) const
+	{
+		const auto& attributes = node.getComponent<Internal::Component::XmlAttributeComponent>();
+
+		if (tagName != Internal::Atom::None && attributes.tagAtom() != tagName)
+		{
+			return false;
+		}
+
+		if (className != Internal::Atom::None && not attributes.hasClass(className))
+		{
+			return false;
+		}
+
+		if (matchesState)
+		{
+			auto state = node.isUINode()
+				? node.getComponent<Internal::Component::UIComponent>().state()
+				: nullptr;
+
+			if (not (state && matchesState(*state)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	Internal::Atom BoxFilter::FindAtom(s3d::StringView str)
+	{
+		// 空文字列のアトム (None) は「絞り込まない」を表すため、どの要素にも一致しない値にする
+		if (str.isEmpty())
+		{
+			return Internal::Atom::Invalid;
+		}
+
+		return Internal::AtomTable::Find(str);
+	}
+}
@@ -0,0 +1,227 @@
+﻿#pragma once
+#include <iterator>
+#include <ranges>
+#include "BoxRef.hpp"
+#include "UIState.hpp"
+
+namespace FlexLayout
+{
+	namespace Internal
+	{
+		enum class Atom : s3d::uint32;
+	}
+
+	namespace detail
+	{
+		/// @brief 子要素を先頭から順に辿る
+		struct ChildTraversal
+		{
+			static Internal::FlexBoxNode* First(const Internal::FlexBoxNode& origin);
+
+			static Internal::FlexBoxNode* Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current);
+		};
+
+		/// @brief 自身を除く兄弟要素を先頭から順に辿る
+		struct SiblingTraversal
+		{
+			static Internal::FlexBoxNode* First(const Internal::FlexBoxNode& origin);
+
+			static Internal::FlexBoxNode* Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current);
+		};
+
+		/// @brief 親要素からルート要素まで順に辿る
+		struct AncestorTraversal
+		{
+			static Internal::FlexBoxNode* First(const Internal::FlexBoxNode& origin);
+
+			static Internal::FlexBoxNode* Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current);
+		};
+
+		/// @brief 自身を除く子孫要素を行きがけ順に辿る
+		struct PreOrderTraversal
+		{
+			static Internal::FlexBoxNode* First(const Internal::FlexBoxNode& origin);
+
+			static Internal::FlexBoxNode* Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current);
+		};
+
+		/// @brief 自身を除く子孫要素を帰りがけ順に辿る
+		struct PostOrderTraversal
+		{
+			static Internal::FlexBoxNode* First(const Internal::FlexBoxNode& origin);
+
+			static Internal::FlexBoxNode* Next(const Internal::FlexBoxNode& origin, const Internal::FlexBoxNode& current);
+		};
+
+		/// @brief 範囲の要素を絞り込む条件
+		struct BoxFilter
+		{
+			/// @brief タグ名のアトム (0の場合は絞り込まない)
+			Internal::Atom tagName{};
+
+			/// @brief クラス名のアトム (0の場合は絞り込まない)
+			Internal::Atom className{};
+
+			bool (*matchesState)(const UIState&) = nullptr;
+
+			bool empty() const noexcept
+			{
+				return tagName == Internal::Atom{} && className == Internal::Atom{} && (not matchesState);
+			}
+
+			bool matches(const Internal::FlexBoxNode& node) const;
+
+			/// @brief 絞り込みに使用するアトムを取得する
+			/// @remark 未登録の文字列や空文字列の場合、どの要素にも一致しない値を返します
+			static Internal::Atom FindAtom(s3d::StringView str);
+		};
+
+		template <class State>
+		bool IsStateOf(const UIState& state)
+		{
+			return dynamic_cast<const State*>(&state) != nullptr;
+		}
+	}
+
+	/// @brief ノードを辿るイテレータ
+	/// @remark 走査中にツリーを変更した場合の動作は未定義です
+	template <class Traversal>
+	class BoxIterator
+	{
+	public:
+
+		using value_type = BoxRef;
+
+		using reference = BoxRef;
+
+		using difference_type = std::ptrdiff_t;
+
+		using iterator_concept = std::forward_iterator_tag;
+
+		using iterator_category = std::input_iterator_tag;
+
+		BoxIterator() = default;
+
+		BoxIterator(const Internal::FlexBoxNode& origin, Internal::FlexBoxNode* current, const detail::BoxFilter& filter)
+			: m_origin(&origin)
+			, m_current(current)
+			, m_filter(filter)
+		{
+			skipUnmatched();
+		}
+
+		BoxRef operator*() const
+		{
+			assert(m_current);
+			return BoxRef{ *m_current };
+		}
+
+		BoxIterator& operator++()
+		{
+			assert(m_current);
+			m_current = Traversal::Next(*m_origin, *m_current);
+			skipUnmatched();
+			return *this;
+		}
+
+		BoxIterator operator++(int)
+		{
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		[[nodiscard]]
+		friend bool operator==(const BoxIterator& lhs, const BoxIterator& rhs) noexcept
+		{
+			return lhs.m_current == rhs.m_current;
+		}
+
+	private:
+
+		const Internal::FlexBoxNode* m_origin = nullptr;
+
+		Internal::FlexBoxNode* m_current = nullptr;
+
+		detail::BoxFilter m_filter;
+
+		void skipUnmatched()
+		{
+			if (m_filter.empty())
+			{
+				return;
+			}
+
+			while (m_current && (not m_filter.matches(*m_current)))
+			{
+				m_current = Traversal::Next(*m_origin, *m_current);
+			}
+		}
+	};
+
+	/// @brief ノードを辿る遅延評価の範囲
+	/// @details 内部の子要素の配列を直接辿るため、メモリ確保や参照カウントの操作を行いません。
+	/// `std::ranges`のアルゴリズムやビューと組み合わせて使用できます
+	/// @remark 走査中にツリーを変更した場合の動作は未定義です
+	template <class Traversal>
+	class BoxRange : public std::ranges::view_interface<BoxRange<Traversal>>
+	{
+	public:
+
+		using iterator = BoxIterator<Traversal>;
+
+		BoxRange() = default;
+
+		explicit BoxRange(Internal::FlexBoxNode& origin) noexcept
+			: m_origin(&origin)
+		{ }
+
+		iterator begin() const
+		{
+			return m_origin
+				? iterator{ *m_origin, Traversal::First(*m_origin), m_filter }
+				: iterator{};
+		}
+
+		iterator end() const { return iterator{}; }
+
+		/// @brief タグ名で絞り込む
+		/// @remark XMLから読み込んだタグ名は小文字で保存されています
+		[[nodiscard]]
+		BoxRange withTag(s3d::StringView tagName) const
+		{
+			auto result = *this;
+			result.m_filter.tagName = detail::BoxFilter::FindAtom(tagName);
+			return result;
+		}
+
+		/// @brief クラス名で絞り込む
+		[[nodiscard]]
+		BoxRange withClass(s3d::StringView className) const
+		{
+			auto result = *this;
+			result.m_filter.className = detail::BoxFilter::FindAtom(className);
+			return result;
+		}
+
+		/// @brief UIの種類で絞り込む
+		template <class State>
+		[[nodiscard]]
+		BoxRange ofType() const
+		{
+			static_assert(std::is_base_of_v<UIState, State>);
+			auto result = *this;
+			result.m_filter.matchesState = &detail::IsStateOf<State>;
+			return result;
+		}
+
+	private:
+
+		Internal::FlexBoxNode* m_origin = nullptr;
+
+		detail::BoxFilter m_filter;
+	};
+}
+
+template <class Traversal>
+inline constexpr bool std::ranges::enable_borrowed_range<FlexLayout::BoxRange<Traversal>> = true;
@@ -0,0 +1,260 @@
+﻿#include "BoxRef.hpp"
+#include "Label.hpp"
+#include "BoxRange.hpp"
+#include "Internal/FlexBoxNode.hpp"
+
+#include "Internal/NodeComponent/LayoutComponent.hpp"
+#include "Internal/NodeComponent/StyleComponent.hpp"
+#include "Internal/NodeComponent/XmlAttributeComponent.hpp"
+#include "Internal/NodeComponent/TextComponent.hpp"
+#include "Internal/NodeComponent/UIComponent.hpp"
+
+namespace FlexLayout
+{
+	BoxRef::BoxRef(const Box& box) noexcept
+		: m_node(box.m_node.get())
+	{
+		assert(m_node);
+	}
+
+	Box BoxRef::lock() const
+	{
+		return Box{ m_node->shared_from_this() };
+	}
+
+	Optional<Vec2> BoxRef::offset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.layoutOffset();
+	}
+
+	bool BoxRef::propergateOffset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.propergateOffset();
+	}
+
+	Vec2 BoxRef::scrollOffset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.scrollOffset();
+	}
+
+	Vec2 BoxRef::maxScrollOffset() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.maxScrollOffset();
+	}
+
+	Thickness BoxRef::margin() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.margin();
+	}
+
+	Thickness BoxRef::border() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.border();
+	}
+
+	Thickness BoxRef::padding() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.padding();
+	}
+
+	RectF BoxRef::localMarginAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.localMarginAreaRect();
+	}
+
+	RectF BoxRef::localBorderAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.localBorderAreaRect();
+	}
+
+	RectF BoxRef::localPaddingAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.localPaddingAreaRect();
+	}
+
+	RectF BoxRef::localContentAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.localContentAreaRect();
+	}
+
+	Optional<RectF> BoxRef::marginAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.marginAreaRect();
+	}
+
+	Optional<RectF> BoxRef::borderAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.borderAreaRect();
+	}
+
+	Optional<RectF> BoxRef::paddingAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.paddingAreaRect();
+	}
+
+	Optional<RectF> BoxRef::contentAreaRect() const
+	{
+		return m_node
+			->getComponent<Internal::Component::LayoutComponent>()
+			.contentAreaRect();
+	}
+
+	Array<StyleValue> BoxRef::getStyle(const StringView styleName) const
+	{
+		return m_node
+			->getComponent<Internal::Component::StyleComponent>()
+			.getStyle(Internal::StylePropertyGroup::Inline, styleName);
+	}
+
+	s3d::Font BoxRef::font() const
+	{
+		return m_node
+			->getComponent<Internal::Component::StyleComponent>()
+			.font();
+	}
+
+	Optional<BoxRef> BoxRef::parent() const
+	{
+		return m_node->parent()
+			? MakeOptional(BoxRef{ *m_node->parent() })
+			: none;
+	}
+
+	bool BoxRef::contains(BoxRef node) const
+	{
+		// 親をたどるだけで判定できるため、shared_ptrを経由しない
+		for (const Internal::FlexBoxNode* current = node.m_node; current; current = current->parent())
+		{
+			if (current == m_node)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	BoxRef BoxRef::getRootNode() const
+	{
+		return BoxRef{ m_node->getRoot() };
+	}
+
+	bool BoxRef::hasChildNodes() const
+	{
+		return !m_node->children().isEmpty();
+	}
+
+	ChildBoxRange BoxRef::childRange() const
+	{
+		return ChildBoxRange{ *m_node };
+	}
+
+	DescendantBoxRange BoxRef::descendants() const
+	{
+		return DescendantBoxRange{ *m_node };
+	}
+
+	PostOrderDescendantBoxRange BoxRef::descendantsPostOrder() const
+	{
+		return PostOrderDescendantBoxRange{ *m_node };
+	}
+
+	AncestorBoxRange BoxRef::ancestors() const
+	{
+		return AncestorBoxRange{ *m_node };
+	}
+
+	SiblingBoxRange BoxRef::siblings() const
+	{
+		return SiblingBoxRange{ *m_node };
+	}
+
+	s3d::String BoxRef::textContent() const
+	{
+		if (m_node->isTextNode())
+		{
+			auto view = m_node
+				->getComponent<Internal::Component::TextComponent>()
+				.text();
+			return String{ view };
+		}
+		else if (m_node->isUINode())
+		{
+			return m_node
+				->getComponent<Internal::Component::UIComponent>()
+				.textContent();
+		}
+
+		return U"";
+	}
+
+	Optional<String> BoxRef::getAttribute(s3d::StringView name) const
+	{
+		return m_node->getProperty(name);
+	}
+
+	bool BoxRef::hasAttribute(s3d::StringView name) const
+	{
+		return m_node->getProperty(name).has_value();
+	}
+
+	Optional<BoxRef> BoxRef::getElementById(StringView id) const
+	{
+		auto impl = m_node
+			->getComponent<Internal::Component::XmlAttributeComponent>()
+			.lookupNodeById(id);
+
+		if (impl)
+		{
+			return BoxRef{ *impl };
+		}
+
+		return none;
+	}
+
+	Optional<Label> BoxRef::asLabel() const
+	{
+		if (m_node->isTextNode())
+		{
+			return Label{ m_node->shared_from_this() };
+		}
+		return none;
+	}
+
+	void BoxRef::drawFrame(const ColorF& color) const
+	{
+		auto& component = m_node->getComponent<Internal::Component::LayoutComponent>();
+
+		if (auto rect = component.borderAreaRect())
+		{
+			component.border().drawPadding(*rect, color);
+		}
+	}
+}
@@ -0,0 +1,166 @@
+﻿#pragma once
+#include "Box.hpp"
+
+namespace FlexLayout
+{
+	/// @brief ノードを所有しない軽量なBoxの参照
+	/// @details Boxと同じ参照系のAPIを持ちますが、参照カウントを操作しないため、毎フレームの更新・描画処理などで使用します。
+	/// 参照先のノードが破棄された後は使用できません。保持する必要がある場合は`lock()`でBoxに変換してください。
+	class BoxRef
+	{
+	public:
+
+		explicit BoxRef(Internal::FlexBoxNode& node) noexcept
+			: m_node(&node)
+		{ }
+
+		BoxRef(const Box& box) noexcept;
+
+	public:
+
+		/// @brief ノードを所有するBoxに変換する
+		Box lock() const;
+
+		// Layout
+
+		/// @brief ローカル座標からグローバル座標へのオフセットを取得する
+		s3d::Optional<s3d::Vec2> offset() const;
+
+		/// @brief 親要素のオフセットを子要素に伝播させるか
+		bool propergateOffset() const;
+
+		/// @brief スクロール量を取得する
+		s3d::Vec2 scrollOffset() const;
+
+		/// @brief スクロール可能な最大量を取得する
+		s3d::Vec2 maxScrollOffset() const;
+
+		/// @brief マージンの計算幅を取得
+		Thickness margin() const;
+
+		/// @brief ボーダーの計算幅を取得
+		Thickness border() const;
+
+		/// @brief パディングの計算幅を取得
+		Thickness padding() const;
+
+		/// @brief 親要素が基準としたマージン領域(マージンの外側)の矩形を取得する
+		s3d::RectF localMarginAreaRect() const;
+
+		/// @brief 親要素が基準としたボーダー領域(マージンの内側,枠の外側)の矩形を取得する
+		s3d::RectF localBorderAreaRect() const;
+
+		/// @brief 親要素が基準としたパディング領域(枠の内側,パディングの外側)の矩形を取得する
+		s3d::RectF localPaddingAreaRect() const;
+
+		/// @brief 親要素が基準としたコンテンツ領域(パディングの内側)の矩形を取得する
+		s3d::RectF localContentAreaRect() const;
+
+		/// @brief 親要素を基準とした矩形を取得する
+		inline s3d::RectF localRect() const { return localBorderAreaRect(); }
+
+		/// @brief マージン領域(マージンの外側)の矩形を取得する
+		s3d::Optional<s3d::RectF> marginAreaRect() const;
+
+		/// @brief ボーダー領域(マージンの内側,枠の外側)の矩形を取得する
+		s3d::Optional<s3d::RectF> borderAreaRect() const;
+
+		/// @brief パディング領域(枠の内側,パディングの外側)の矩形を取得する
+		s3d::Optional<s3d::RectF> paddingAreaRect() const;
+
+		/// @brief コンテンツ領域(パディングの内側)の矩形を取得する
+		s3d::Optional<s3d::RectF> contentAreaRect() const;
+
+		/// @brief 計算した矩形を取得する
+		inline s3d::Optional<s3d::RectF> rect() const { return borderAreaRect(); }
+
+		// Inline Styles
+
+		/// @brief 指定されたスタイルの値を取得する
+		/// @return 値が設定されていない場合は空の配列を返す
+		s3d::Array<StyleValue> getStyle(const s3d::StringView styleName) const;
+
+		// Font
+
+		/// @brief フォントの設定値を取得する
+		s3d::Font font() const;
+
+		// Tree
+
+		/// @brief 親ノードを取得する
+		/// @return 親ノードが存在しない場合はnone
+		s3d::Optional<BoxRef> parent() const;
+
+		/// @brief このノード内に指定されたノードが存在するかどうかを判定する
+		/// @return このノードと同一の場合、または子,孫ノードの場合はtrue
+		bool contains(BoxRef node) const;
+
+		/// @brief ルート要素を取得する
+		/// @return ツリーのルート要素、親ノードが存在しない場合は自身を返します
+		BoxRef getRootNode() const;
+
+		/// @brief 子ノードを持っているかを判定する
+		bool hasChildNodes() const;
+
+		/// @brief 子ノードを順に辿る範囲を取得する
+		ChildBoxRange childRange() const;
+
+		/// @brief 自身を除く子孫ノードを行きがけ順に辿る範囲を取得する
+		DescendantBoxRange descendants() const;
+
+		/// @brief 自身を除く子孫ノードを帰りがけ順に辿る範囲を取得する
+		PostOrderDescendantBoxRange descendantsPostOrder() const;
+
+		/// @brief 親ノードからルート要素までを辿る範囲を取得する
+		AncestorBoxRange ancestors() const;
+
+		/// @brief 自身を除く兄弟ノードを辿る範囲を取得する
+		SiblingBoxRange siblings() const;
+
+		// Text
+
+		s3d::String textContent() const;
+
+		// Attributes
+
+		/// @brief 属性の値を取得する
+		/// @param name 属性名
+		/// @return 設定値、登録されていない場合はnone
+		s3d::Optional<s3d::String> getAttribute(s3d::StringView name) const;
+
+		/// @brief 属性が存在するかを判定する
+		/// @param name 属性名
+		/// @return 存在する場合はtrue
+		bool hasAttribute(s3d::StringView name) const;
+
+		// Query
+
+		s3d::Optional<BoxRef> getElementById(s3d::StringView id) const;
+
+		// Others
+
+		/// @brief Labelのインスタンスに変換する
+		s3d::Optional<Label> asLabel() const;
+
+		template <class State>
+		s3d::Optional<UIBox<State>> as() const;
+
+		/// @brief 枠線を描画する
+		/// @param color 枠線の色
+		void drawFrame(const s3d::ColorF& color = s3d::Palette::White) const;
+
+		[[nodiscard]]
+		friend bool operator==(const BoxRef& lhs, const BoxRef& rhs) noexcept
+		{
+			return lhs.m_node == rhs.m_node;
+		}
+
+	private:
+
+		friend Internal::Accessor;
+
+		Internal::FlexBoxNode* m_node;
+	};
+
+	static_assert(std::is_trivially_copyable_v<BoxRef>);
+}
@@ -3,8 +3,15 @@
 #include <Siv3D/Window.hpp>
 #include <Siv3D/WindowState.hpp>
 #include <vector>
+#include <Siv3D/HashSet.hpp>
+#include <yoga/node/Node.h>
+#include "Internal/TreeTraversal.hpp"
+#include "Internal/ShapingCache.hpp"
 #include "Internal/NodeComponent/XmlAttributeComponent.hpp"
 #include "Internal/NodeComponent/LayoutComponent.hpp"
+#include "Internal/NodeComponent/StyleComponent.hpp"
+#include "Internal/NodeComponent/TextComponent.hpp"
+#include "Internal/NodeComponent/UIComponent.hpp"
 
 using namespace s3d;
 
@@ -184,4 +191,94 @@ namespace FlexLayout
 		}
 		return true;
 	}
+
+	MemoryUsageReport Debugger::MemoryReport(const Box& root)
+	{
+		using namespace Internal::Component;
+
+		MemoryUsageReport report;
+
+		// コピーオンライトで共有されているテーブルは1度だけ計上する
+		HashSet<const void*> styleTables;
+
+		// 同じ文字列のテキストノードで共有されているシェーピング結果は1度だけ計上する
+		HashSet<const void*> shapedTexts;
+
+		Internal::TraversePreOrder(*Internal::Accessor::GetNode(root), [&](const Internal::FlexBoxNode& node)
+			{
+				report.nodes.add(sizeof(Internal::FlexBoxNode) + node.children().capacity() * sizeof(std::shared_ptr<Internal::FlexBoxNode>));
+				const auto* yogaNode = facebook::yoga::resolveRef(node.yogaNode());
+				report.yogaNodes.add(sizeof(facebook::yoga::Node) + yogaNode->getChildren().capacity() * sizeof(facebook::yoga::Node*));
+				report.layoutComponents.add(sizeof(LayoutComponent));
+
+				const auto& style = node.getComponent<StyleComponent>();
+				report.styleComponents.add(sizeof(StyleComponent) + style.allocatedBytes());
+
+				const auto& table = style.styleTable();
+				if (table.identity() && styleTables.emplace(table.identity()).second)
+				{
+					size_t tableBytes = sizeof(Internal::StylePropertyTable::container_type);
+					for (const auto& group : table)
+					{
+						tableBytes += group.capacity() * sizeof(Internal::StyleProperty);
+						for (const auto& property : group)
+						{
+							report.styleValues.add(
+								property.value().capacity() * sizeof(Style::StyleValue),
+								property.removed() ? 0 : 1);
+						}
+					}
+					report.styleTables.add(tableBytes);
+				}
+
+				const auto& xmlAttr = node.getComponent<XmlAttributeComponent>();
+				report.xmlAttributeComponents.add(sizeof(XmlAttributeComponent) + xmlAttr.allocatedBytes());
+
+				if (node.isTextNode())
+				{
+					const auto& text = node.getComponent<TextComponent>();
+					report.textComponents.add(sizeof(TextComponent) + text.allocatedBytes());
+					size_t glyphCacheBytes = text.lineCacheBytes();
+					if (const auto& shaped = text.shapedText(); shaped && shapedTexts.emplace(shaped.get()).second)
+					{
+						glyphCacheBytes += sizeof(Internal::ShapedText) + shaped->allocatedBytes();
+					}
+					report.glyphCaches.add(glyphCacheBytes);
+				}
+
+				if (node.isUINode())
+				{
+					const auto& ui = node.getComponent<UIComponent>();
+					report.uiComponents.add(sizeof(UIComponent) + ui.textContent().capacity() * sizeof(String::value_type));
+
+					if (const auto state = ui.state())
+					{
+						report.uiStates.add(state->memoryUsage());
+					}
+				}
+
+				// インラインに格納された属性はノード本体に含まれる
+				const auto& properties = node.getAdditionalProperties();
+				report.additionalProperties.add(properties.allocatedBytes(), properties.size());
+			});
+
+		return report;
+	}
+
+	ShapingCacheStats Debugger::GetShapingCacheStats()
+	{
+		const auto stats = Internal::ShapingCache::GetStats();
+		return {
+			.hits = stats.hits,
+			.misses = stats.misses,
+			.evictions = stats.evictions,
+			.entries = stats.entries,
+			.capacity = stats.capacity,
+		};
+	}
+
+	void Debugger::ResetShapingCacheStats()
+	{
+		Internal::ShapingCache::ResetStats();
+	}
 }
@@ -1,9 +1,34 @@
 ﻿#pragma once
 #include <Siv3D/Cursor.hpp>
 #include "Box.hpp"
+#include "MemoryReport.hpp"
 
 namespace FlexLayout
 {
+	/// @brief テキストノードで共有するシェーピング結果のキャッシュの統計
+	struct ShapingCacheStats
+	{
+		size_t hits = 0;
+
+		size_t misses = 0;
+
+		/// @brief 容量を超えたため追い出した数
+		size_t evictions = 0;
+
+		/// @brief 保持している結果の数
+		size_t entries = 0;
+
+		/// @brief 保持する結果の最大数
+		size_t capacity = 0;
+
+		/// @brief ヒット率 (問い合わせがない場合は0)
+		double hitRate() const noexcept
+		{
+			const size_t total = hits + misses;
+			return total ? static_cast<double>(hits) / total : 0.0;
+		}
+	};
+
 	class Debugger
 	{
 	public:
@@ -21,5 +46,16 @@ namespace FlexLayout
 		/// @brief カーソルを合わせているノードのレイアウト領域を描画
 		/// @remark propergateOffsetフラグがfalseのノードの子要素は無視されます
 		static bool DrawHoveredBoxLayout(const Box& root, const s3d::Vec2& cursorPos = s3d::Cursor::PosF());
+
+		/// @brief サブツリーのメモリ使用量を集計する
+		/// @param root 集計を開始するノード (集計対象に含まれます)
+		static MemoryUsageReport MemoryReport(const Box& root);
+
+		/// @brief シェーピング結果のキャッシュの統計を取得する
+		/// @remark キャッシュはプロセス全体で共有されるため、すべてのツリーの値の合計です
+		static ShapingCacheStats GetShapingCacheStats();
+
+		/// @brief シェーピング結果のキャッシュのヒット数・ミス数・追い出し数を0に戻す
+		static void ResetShapingCacheStats();
 	};
 }
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include "Common.hpp"
+
+namespace FlexLayout
+{
+	enum class Overflow
+	{
+		Visible,
+		Hidden,
+		Scroll
+	};
+
+	template<>
+	struct Style::detail::style_enum_traits<Overflow>
+	{
+		static constexpr std::array<s3d::StringView, 3> names{
+			U"visible",
+			U"hidden",
+			U"scroll"
+		};
+
+#if FLEXLAYOUT_ENABLE_CONV_TO_YOGA
+		static constexpr std::array<YGOverflow, 3> to_yoga{
+			YGOverflowVisible,
+			YGOverflowHidden,
+			YGOverflowScroll
+		};
+#endif
+	};
+}
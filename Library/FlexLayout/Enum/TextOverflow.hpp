@@ -0,0 +1,20 @@
+﻿#pragma once
+#include "Common.hpp"
+
+namespace FlexLayout
+{
+	enum class TextOverflow
+	{
+		Clip,
+		Ellipsis
+	};
+
+	template<>
+	struct Style::detail::style_enum_traits<TextOverflow>
+	{
+		static constexpr std::array<s3d::StringView, 2> names{
+			U"clip",
+			U"ellipsis"
+		};
+	};
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+#include "Common.hpp"
+
+namespace FlexLayout
+{
+	enum class WhiteSpace
+	{
+		Normal,
+		Nowrap
+	};
+
+	template<>
+	struct Style::detail::style_enum_traits<WhiteSpace>
+	{
+		static constexpr std::array<s3d::StringView, 2> names{
+			U"normal",
+			U"nowrap"
+		};
+	};
+}
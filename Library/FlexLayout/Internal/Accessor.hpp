@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "../Box.hpp"
+#include "../BoxRef.hpp"
 #include "FlexBoxNode.hpp"
 #include "../UIState.hpp"
 
@@ -11,5 +12,10 @@ namespace FlexLayout::Internal
 		{
 			return box.m_node;
 		}
+
+		static FlexBoxNode& GetNode(FlexLayout::BoxRef box)
+		{
+			return *box.m_node;
+		}
 	};
 }
@@ -0,0 +1,95 @@
+﻿#include <deque>
+#include <mutex>
+#include <Siv3D/HashTable.hpp>
+#include "Atom.hpp"
+
+namespace FlexLayout::Internal
+{
+	namespace detail
+	{
+		struct AtomTableStorage
+		{
+			std::mutex mutex;
+
+			/// @brief 登録した文字列 (アトムの値 - 1 番目)
+			/// @remark 要素の参照が無効にならないようにdequeを使用します
+			std::deque<String> strings;
+
+			/// @brief stringsの要素を参照するキー
+			HashTable<StringView, Atom> atoms;
+		};
+
+		static AtomTableStorage& GetAtomTableStorage()
+		{
+			static AtomTableStorage storage;
+			return storage;
+		}
+	}
+
+	Atom AtomTable::Intern(StringView str)
+	{
+		if (str.isEmpty())
+		{
+			return Atom::None;
+		}
+
+		auto& storage = detail::GetAtomTableStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		if (auto itr = storage.atoms.find(str); itr != storage.atoms.end())
+		{
+			return itr->second;
+		}
+
+		assert(storage.strings.size() + 1 < static_cast<size_t>(Atom::Invalid));
+
+		const auto atom = static_cast<Atom>(storage.strings.size() + 1);
+		const auto& stored = storage.strings.emplace_back(str);
+		storage.atoms.emplace(StringView{ stored }, atom);
+		return atom;
+	}
+
+	Atom AtomTable::Find(StringView str)
+	{
+		if (str.isEmpty())
+		{
+			return Atom::None;
+		}
+
+		auto& storage = detail::GetAtomTableStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		if (auto itr = storage.atoms.find(str); itr != storage.atoms.end())
+		{
+			return itr->second;
+		}
+
+		return Atom::Invalid;
+	}
+
+	const String& AtomTable::ToString(Atom atom)
+	{
+		static const String Empty;
+
+		if (atom == Atom::None || atom == Atom::Invalid)
+		{
+			return Empty;
+		}
+
+		auto& storage = detail::GetAtomTableStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		const size_t index = static_cast<size_t>(atom) - 1;
+		assert(index < storage.strings.size());
+
+		return storage.strings[index];
+	}
+
+	size_t AtomTable::Size()
+	{
+		auto& storage = detail::GetAtomTableStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		return storage.strings.size();
+	}
+}
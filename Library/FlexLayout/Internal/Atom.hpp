@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <Siv3D/String.hpp>
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	/// @brief インターン化したタグ名・ID・クラス名を表す整数
+	/// @remark 同じ文字列からは常に同じ値が得られるため、文字列の比較を整数の比較に置き換えられます
+	enum class Atom : uint32
+	{
+		/// @brief 空文字列
+		None = 0,
+
+		/// @brief どの文字列とも一致しない値 (未登録の文字列の検索結果)
+		Invalid = 0xFFFFFFFF,
+	};
+
+	/// @brief プロセス全体で共有するアトムの表
+	/// @remark スレッドセーフです。登録した文字列は解放されません
+	struct AtomTable
+	{
+		/// @brief 文字列を登録してアトムを取得する
+		/// @return 空文字列の場合は`Atom::None`
+		static Atom Intern(StringView str);
+
+		/// @brief 登録済みの文字列のアトムを取得する
+		/// @remark 未登録の文字列はどのノードにも設定されていないため、検索時は登録を行わずにこちらを使用します
+		/// @return 空文字列の場合は`Atom::None`、未登録の場合は`Atom::Invalid`
+		static Atom Find(StringView str);
+
+		/// @brief アトムに対応する文字列を取得する
+		static const String& ToString(Atom atom);
+
+		/// @brief 登録済みの文字列の数
+		static size_t Size();
+	};
+}
@@ -1,12 +1,17 @@
 ﻿#include "Config.hpp"
 #include <Siv3D/FontAsset.hpp>
 #include <Siv3D/SimpleGUI.hpp>
+#include <Siv3D/ScopeGuard.hpp>
+#include "FontAccess.hpp"
+#include "WorkerPool.hpp"
 
 namespace FlexLayout::Internal
 {
 	namespace detail
 	{
 		static std::unique_ptr<Config> config;
+
+		static std::once_flag configOnceFlag;
 	}
 
 	Config::Config()
@@ -16,11 +21,16 @@ namespace FlexLayout::Internal
 			.font = SimpleGUI::GetFont(),
 			.fontSizePx = 16.0F,
 			.lineHeightMul = 1.2F,
-			.textAlign = TextAlign::Start
+			.textAlign = TextAlign::Start,
+			.whiteSpace = WhiteSpace::Normal,
+			.textOverflow = TextOverflow::Clip,
+			.maxLines = 0
 		}
 	{
 		YGConfigSetUseWebDefaults(m_yogaConfig, true);
 		m_dummyNode = YGNodeNewWithConfig(m_yogaConfig);
+
+		m_defaultTextStyle.updateFontMetrics();
 	}
 
 	YGNodeRef Config::createNode() const
@@ -40,25 +50,113 @@ namespace FlexLayout::Internal
 
 	void Config::setUseWebDefaults(bool value)
 	{
+		// ダミーノードを作り直すため、レイアウト計算と並行できない
+		assert(not isParallelLayoutInProgress());
+
 		YGConfigSetUseWebDefaults(m_yogaConfig, value);
 
 		YGNodeFree(m_dummyNode);
 		m_dummyNode = YGNodeNewWithConfig(m_yogaConfig);
 	}
 
+	std::function<Font(StringView)> Config::fontLoader() const
+	{
+		std::shared_lock lock{ m_mutex };
+		return m_fontLoader;
+	}
+
 	void Config::setFontLoader(std::function<Font(StringView)> loader)
 	{
 		assert(loader);
+		std::unique_lock lock{ m_mutex };
 		m_fontLoader = std::move(loader);
 	}
 
 	Font Config::loadFont(StringView id) const
 	{
+		std::shared_lock lock{ m_mutex };
+		const auto fontLock = LockFontAccess();
 		return m_fontLoader(id);
 	}
 
+	Optional<Font> Config::tryLoadFont(StringView id) const
+	{
+		// 読み込みを待つとフレームが止まるため、完了するまではnoneを返す
+		if (asyncFontLoading() && usesDefaultFontLoader())
+		{
+			const auto fontLock = LockFontAccess();
+			if (FontAsset::IsRegistered(id) && not FontAsset::IsReady(id))
+			{
+				FontAsset::LoadAsync(id);
+				return none;
+			}
+		}
+
+		return loadFont(id);
+	}
+
+	void Config::setParallelExecutor(ParallelExecutor executor)
+	{
+		std::unique_lock lock{ m_mutex };
+		m_parallelExecutor = std::move(executor);
+	}
+
+	void Config::parallelFor(size_t count, const std::function<void(size_t)>& job) const
+	{
+		// ワーカースレッドから同じワーカーを待つとデッドロックするため、入れ子の並列化は行わない
+		if (isParallelLayoutInProgress())
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				job(i);
+			}
+			return;
+		}
+
+		ParallelExecutor executor;
+		WorkerPool* workerPool = nullptr;
+		{
+			std::unique_lock lock{ m_mutex };
+			if (m_parallelExecutor)
+			{
+				executor = m_parallelExecutor;
+			}
+			else
+			{
+				if (not m_workerPool)
+				{
+					const size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2U);
+					m_workerPool = std::make_unique<WorkerPool>(hardwareThreads - 1);
+				}
+				workerPool = m_workerPool.get();
+			}
+		}
+
+		m_parallelLayoutCount.fetch_add(1, std::memory_order_acq_rel);
+		const ScopeGuard guard{ [this] { m_parallelLayoutCount.fetch_sub(1, std::memory_order_acq_rel); } };
+
+		if (executor)
+		{
+			executor(count, job);
+		}
+		else
+		{
+			workerPool->parallelFor(count, job);
+		}
+	}
+
+	bool Config::usesDefaultFontLoader() const
+	{
+		// 独自のローダーが設定されている場合は常に同期的に読み込む
+		std::shared_lock lock{ m_mutex };
+		const auto loader = m_fontLoader.target<Font(*)(StringView)>();
+		return loader && *loader == &DefaultFontLoader;
+	}
+
 	Config::~Config()
 	{
+		m_workerPool.reset();
+
 		YGNodeFree(m_dummyNode);
 		m_dummyNode = nullptr;
 
@@ -74,11 +172,8 @@ namespace FlexLayout::Internal
 
 	Config& GetConfig()
 	{
-		// 遅延読み込み
-		if (!detail::config)
-		{
-			detail::config = std::make_unique<Config>();
-		}
+		// 遅延読み込み (複数のスレッドから同時に呼び出されても1度だけ生成する)
+		std::call_once(detail::configOnceFlag, [] { detail::config = std::make_unique<Config>(); });
 		return *detail::config;
 	}
 }
@@ -1,15 +1,26 @@
 ﻿#pragma once
 #include <yoga/Yoga.h>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <shared_mutex>
 #include "Style/ComputedTextStyle.hpp"
 
 namespace FlexLayout::Internal
 {
+	class WorkerPool;
+
 	/// @brief アプリケーション共通の設定
+	/// @remark 取得系の関数は複数のスレッドから同時に呼び出せます。
+	/// Yogaの設定を変更する関数 (`setUseWebDefaults`) は、並列のレイアウト計算中に呼び出してはいけません
 	class Config
 	{
 	public:
 
+		/// @brief 並列処理を実行する関数
+		/// @remark `job(0)`から`job(count - 1)`までを実行し、すべて完了するまで待つ必要があります
+		using ParallelExecutor = std::function<void(size_t count, const std::function<void(size_t)>& job)>;
+
 		Config();
 
 	public:
@@ -18,7 +29,7 @@ namespace FlexLayout::Internal
 
 		void setUseWebDefaults(bool value);
 
-		auto fontLoader() const { return m_fontLoader; }
+		std::function<Font(StringView)> fontLoader() const;
 
 		void setFontLoader(std::function<Font(StringView)> loader);
 
@@ -34,8 +45,32 @@ namespace FlexLayout::Internal
 
 		Font loadFont(StringView id) const;
 
+		/// @brief `siv3d-font`で指定したフォントアセットを非同期で読み込むか
+		bool asyncFontLoading() const { return m_asyncFontLoading.load(std::memory_order_relaxed); }
+
+		void setAsyncFontLoading(bool value) { m_asyncFontLoading = value; }
+
+		/// @brief フォントを取得する
+		/// @remark 非同期読み込みが有効な場合、読み込みが完了していないフォントアセットは読み込みを開始してnoneを返します
+		Optional<Font> tryLoadFont(StringView id) const;
+
+		/// @brief 独立したレイアウトの並列計算に使用する関数を設定する
+		/// @param executor nullptrの場合はライブラリのワーカースレッドを使用します
+		void setParallelExecutor(ParallelExecutor executor);
+
+		/// @brief `job(0)`から`job(count - 1)`までを並列に実行し、すべて完了するまで待つ
+		/// @remark 実行中は`isParallelLayoutInProgress()`がtrueを返します。
+		/// 実行中に呼び出された場合 (並列計算中のレイアウトの部分木の並列計算など) は、呼び出し元のスレッドで順番に実行します
+		void parallelFor(size_t count, const std::function<void(size_t)>& job) const;
+
+		/// @brief 並列のレイアウト計算を実行中か
+		bool isParallelLayoutInProgress() const { return m_parallelLayoutCount.load(std::memory_order_acquire) != 0; }
+
 	private:
 
+		/// @brief m_fontLoader, m_parallelExecutor, m_workerPoolを保護する
+		mutable std::shared_mutex m_mutex;
+
 		YGConfigRef m_yogaConfig;
 
 		/// @brief スタイルの初期値を取得するためのダミーノード
@@ -45,6 +80,17 @@ namespace FlexLayout::Internal
 
 		std::function<Font(StringView)> m_fontLoader = DefaultFontLoader;
 
+		std::atomic<bool> m_asyncFontLoading{ false };
+
+		ParallelExecutor m_parallelExecutor;
+
+		/// @brief 既定のワーカースレッド (初回の並列計算時に生成)
+		mutable std::unique_ptr<WorkerPool> m_workerPool;
+
+		mutable std::atomic<uint32> m_parallelLayoutCount{ 0 };
+
+		bool usesDefaultFontLoader() const;
+
 		static Font DefaultFontLoader(StringView id);
 
 	public:
@@ -1,5 +1,8 @@
 ﻿#include "FlexBoxNode.hpp"
+#include <Siv3D/HashSet.hpp>
 #include "TreeContext.hpp"
+#include "TreeTraversal.hpp"
+#include "NodeGraveyard.hpp"
 #include "Config.hpp"
 #include "../Error.hpp"
 
@@ -27,16 +30,14 @@ namespace FlexLayout::Internal
 
 		static bool LookupNodeFromChildren(const FlexBoxNode* node, const FlexBoxNode* target)
 		{
-			for (const auto& child : node->children())
-			{
-				if (child.get() == target ||
-					LookupNodeFromChildren(child.get(), target))
+			const bool completed = TraversePreOrder(*node, [&](const FlexBoxNode& item)
 				{
-					return true;
-				}
-			}
+					return &item != node && &item == target
+						? TraversalAction::Stop
+						: TraversalAction::Continue;
+				});
 
-			return false;
+			return not completed;
 		}
 
 		static void ValidateSetChildrenOperation(const FlexBoxNode* parent, const Array<std::shared_ptr<FlexBoxNode>>& children)
@@ -71,6 +72,84 @@ namespace FlexLayout::Internal
 		}
 	}
 
+	namespace detail
+	{
+		static void ValidateReconcileChildrenOperation(const FlexBoxNode* parent, const Array<std::shared_ptr<FlexBoxNode>>& children)
+		{
+			HashSet<const FlexBoxNode*> nodes(children.size());
+			for (const auto& child : children)
+			{
+				if (not nodes.emplace(child.get()).second)
+				{
+					throw InvalidTreeOperationError(U"Cannot add the same node multiple times\n同じノードを複数回追加することはできません");
+				}
+			}
+
+			for (const auto& child : children)
+			{
+				// 既存の子要素は検証済み
+				if (child->parent() == parent)
+				{
+					continue;
+				}
+
+				ValidateCircularReference(parent, child.get());
+
+				// 別の子要素のサブツリー内に存在しないか検証
+				for (auto node = child->parent(); node; node = node->parent())
+				{
+					if (nodes.contains(node))
+					{
+						throw InvalidTreeOperationError(U"Duplicated node found in the subtree\nサブツリー内に重複するノードが見つかりました");
+					}
+				}
+			}
+		}
+
+		/// @brief 最長増加部分列を求める
+		/// @return 部分列を構成する要素の位置
+		static Array<size_t> LongestIncreasingSubsequence(const Array<size_t>& sequence)
+		{
+			// tails[k]: 長さk+1の部分列の末尾になりうる最小の要素の位置
+			Array<size_t> tails;
+			Array<size_t> previous(sequence.size(), std::numeric_limits<size_t>::max());
+
+			for (size_t i = 0; i < sequence.size(); i++)
+			{
+				auto itr = std::lower_bound(
+					tails.begin(),
+					tails.end(),
+					sequence[i],
+					[&](size_t pos, size_t value) { return sequence[pos] < value; }
+				);
+
+				if (itr != tails.begin())
+				{
+					previous[i] = *(itr - 1);
+				}
+
+				if (itr == tails.end())
+				{
+					tails.push_back(i);
+				}
+				else
+				{
+					*itr = i;
+				}
+			}
+
+			Array<size_t> result(tails.size());
+			size_t pos = tails.empty() ? 0 : tails.back();
+			for (size_t i = tails.size(); i > 0; i--)
+			{
+				result[i - 1] = pos;
+				pos = previous[pos];
+			}
+
+			return result;
+		}
+	}
+
 	FlexBoxNode::FlexBoxNode(FlexBoxNodeOptions options)
 		: m_yogaNode{ GetConfig().createNode() }
 		, m_components{
@@ -90,16 +169,104 @@ namespace FlexLayout::Internal
 
 	FlexBoxNode::~FlexBoxNode()
 	{
-		// 先に子要素のデストラクタを呼び出させる
-		removeChildren();
+		// 子孫のデストラクタが再帰的に呼び出されないよう、
+		// 解放されるノードの子要素を引き取りながら順に解放する
+		Array<std::shared_ptr<FlexBoxNode>> pending;
+		releaseChildren(pending);
+
+		while (not pending.empty())
+		{
+			DisposeOne(pending);
+		}
 
 		// YGNodeを解放
 		YGNodeFree(m_yogaNode);
 		m_yogaNode = nullptr;
 	}
 
+	void FlexBoxNode::DisposeOne(Array<std::shared_ptr<FlexBoxNode>>& pending)
+	{
+		auto node = std::move(pending.back());
+		pending.pop_back();
+
+		if (node.use_count() == 1)
+		{
+			node->releaseChildren(pending);
+		}
+		else
+		{
+			// 他から参照されている場合は参照を手放すのみ (ツリーから切り離されたままであれば、子孫も切り離す)
+			node->finishDetach();
+		}
+	}
+
+	void FlexBoxNode::releaseChildren(Array<std::shared_ptr<FlexBoxNode>>& output)
+	{
+		YGNodeRemoveAllChildren(m_yogaNode);
+
+		for (auto& child : m_children)
+		{
+			// 子孫はそれぞれの処理時に切り離される
+			child->m_parent = nullptr;
+			child->m_context.reset();
+			output.push_back(std::move(child));
+		}
+
+		m_children.clear();
+	}
+
+	void FlexBoxNode::detachChild(const std::shared_ptr<FlexBoxNode>& child)
+	{
+		child->m_parent = nullptr;
+
+		NodeGraveyard* graveyard = m_context ? m_context->graveyard() : nullptr;
+		if (not graveyard)
+		{
+			child->setContext(nullptr);
+			child->getComponent<Component::LayoutComponent>()
+				.clearLayoutOffsetRecursive();
+			return;
+		}
+
+		// 大きなサブツリーでも1フレームの処理時間が増えないよう、子孫の切り離しは解放待ちリストで行う
+		// ただし、解放待ちの子孫への変更が元のツリーに登録されないよう、コンテキストはここで子孫まで外す
+		TraversePreOrder(*child, [](FlexBoxNode& node) { node.m_context.reset(); });
+		child->getComponent<Component::LayoutComponent>().clearLayoutOffset();
+		graveyard->bury(child);
+	}
+
+	void FlexBoxNode::finishDetach()
+	{
+		// ツリーに戻された場合は何もしない
+		if (m_parent || m_context)
+		{
+			return;
+		}
+
+		setContextImpl(nullptr);
+		getComponent<Component::LayoutComponent>().clearLayoutOffsetRecursive();
+	}
+
+	void FlexBoxNode::updateChildIndices(size_t first)
+	{
+		for (size_t i = first; i < m_children.size(); i++)
+		{
+			m_children[i]->m_indexInParent = i;
+		}
+	}
+
+	void FlexBoxNode::waitForLayoutTask()
+	{
+		if (m_context)
+		{
+			m_context->waitForLayoutTask();
+		}
+	}
+
 	void FlexBoxNode::setChildren(const Array<std::shared_ptr<FlexBoxNode>>& children)
 	{
+		waitForLayoutTask();
+
 		assert(not isTextNode());
 		assert(children.all([](const auto& child) { return !!child; }));
 		detail::ValidateSetChildrenOperation(this, children);
@@ -135,25 +302,22 @@ namespace FlexLayout::Internal
 		// 取り残されたノードの切り離し
 		for (const auto& child : m_children)
 		{
-			child->m_parent = nullptr;
-			child->setContext(nullptr);
-			child->getComponent<Component::LayoutComponent>()
-				.clearLayoutOffsetRecursive();
+			detachChild(child);
 		}
 
 		// m_childrenの更新
 		m_children = children;
+		updateChildIndices();
 	}
 
 	void FlexBoxNode::removeChildren()
 	{
+		waitForLayoutTask();
+
 		// 子要素の更新
 		for (auto& child : m_children)
 		{
-			child->m_parent = nullptr;
-			child->setContext(nullptr);
-			child->getComponent<Component::LayoutComponent>()
-				.clearLayoutOffsetRecursive();
+			detachChild(child);
 		}
 
 		// YGNodeの更新
@@ -163,8 +327,87 @@ namespace FlexLayout::Internal
 		m_children.clear();
 	}
 
+	void FlexBoxNode::reconcileChildren(const Array<std::shared_ptr<FlexBoxNode>>& children)
+	{
+		waitForLayoutTask();
+
+		assert(not isTextNode());
+		assert(children.all([](const auto& child) { return !!child; }));
+
+		if (children == m_children)
+		{
+			return;
+		}
+
+		detail::ValidateReconcileChildrenOperation(this, children);
+
+		HashTable<const FlexBoxNode*, size_t> newIndices(children.size());
+		for (auto [idx, child] : Indexed(children))
+		{
+			newIndices.emplace(child.get(), idx);
+		}
+
+		// 残らない子要素を切り離し、残る子要素の新しい位置を旧順序で列挙
+		Array<size_t> keptIndices(Arg::reserve = m_children.size());
+		for (const auto& child : m_children)
+		{
+			if (auto itr = newIndices.find(child.get()); itr != newIndices.end())
+			{
+				keptIndices.push_back(itr->second);
+				continue;
+			}
+
+			detachChild(child);
+
+			YGNodeRemoveChild(m_yogaNode, child->yogaNode());
+		}
+
+		// 相対順序が保たれる子要素はYogaのツリー上で動かさない
+		Array<bool> isStable(children.size(), false);
+		for (auto pos : detail::LongestIncreasingSubsequence(keptIndices))
+		{
+			isStable[keptIndices[pos]] = true;
+		}
+
+		for (auto newIndex : keptIndices)
+		{
+			if (not isStable[newIndex])
+			{
+				YGNodeRemoveChild(m_yogaNode, children[newIndex]->yogaNode());
+			}
+		}
+
+		// 新しい順序で挿入
+		for (auto [idx, child] : Indexed(children))
+		{
+			if (isStable[idx])
+			{
+				continue;
+			}
+
+			if (child->m_parent != this)
+			{
+				if (child->m_parent)
+				{
+					child->m_parent->removeChild(child);
+				}
+
+				child->setContext(m_context);
+				child->m_parent = this;
+			}
+
+			YGNodeInsertChild(m_yogaNode, child->yogaNode(), idx);
+		}
+
+		// m_childrenの更新
+		m_children = children;
+		updateChildIndices();
+	}
+
 	void FlexBoxNode::insertChild(const std::shared_ptr<FlexBoxNode>& child, size_t index)
 	{
+		waitForLayoutTask();
+
 		assert(not isTextNode());
 		assert(child);
 		detail::ValidateCircularReference(this, child.get());
@@ -185,6 +428,7 @@ namespace FlexLayout::Internal
 
 		// m_childrenの更新
 		m_children.insert(m_children.begin() + index, child);
+		updateChildIndices(index);
 	}
 
 	void FlexBoxNode::appendChild(const std::shared_ptr<FlexBoxNode>& child)
@@ -194,6 +438,8 @@ namespace FlexLayout::Internal
 
 	void FlexBoxNode::removeChild(const std::shared_ptr<FlexBoxNode>& child)
 	{
+		waitForLayoutTask();
+
 		assert(child);
 
 		auto itr = std::find(m_children.begin(), m_children.end(), child);
@@ -203,16 +449,15 @@ namespace FlexLayout::Internal
 		}
 
 		// 子要素の更新
-		child->m_parent = nullptr;
-		child->setContext(nullptr);
-		child->getComponent<Component::LayoutComponent>()
-			.clearLayoutOffsetRecursive();
+		detachChild(child);
 
 		// YGNodeの更新
 		YGNodeRemoveChild(m_yogaNode, child->yogaNode());
 
 		// m_childrenの更新
+		const size_t index = std::distance(m_children.begin(), itr);
 		m_children.erase(itr);
+		updateChildIndices(index);
 	}
 
 	TreeContext& FlexBoxNode::context()
@@ -235,17 +480,45 @@ namespace FlexLayout::Internal
 
 	void FlexBoxNode::setContextImpl(const std::shared_ptr<TreeContext>& context)
 	{
-		m_context = context;
+		TraversePreOrder(*this, [&](FlexBoxNode& node)
+			{
+				node.m_context = context;
 
-		if (m_context)
+				if (context)
+				{
+					context->onNewNodeJoin(node.shared_from_this());
+				}
+			});
+	}
+
+	FlexBoxNode* FlexBoxNode::nextSibling() const
+	{
+		if (not m_parent)
 		{
-			context->onNewNodeJoin(shared_from_this());
+			return nullptr;
 		}
 
-		for (auto& child : m_children)
+		const auto& siblings = m_parent->m_children;
+		assert(siblings[m_indexInParent].get() == this);
+
+		return m_indexInParent + 1 < siblings.size()
+			? siblings[m_indexInParent + 1].get()
+			: nullptr;
+	}
+
+	FlexBoxNode* FlexBoxNode::previousSibling() const
+	{
+		if (not m_parent)
 		{
-			child->setContextImpl(context);
+			return nullptr;
 		}
+
+		const auto& siblings = m_parent->m_children;
+		assert(siblings[m_indexInParent].get() == this);
+
+		return m_indexInParent > 0
+			? siblings[m_indexInParent - 1].get()
+			: nullptr;
 	}
 
 	size_t FlexBoxNode::getDepth() const
@@ -285,6 +558,9 @@ namespace FlexLayout::Internal
 			.uiNode   = isUINode()
 		});
 
+		// Yogaのスタイルはまとめて複製する (スタイルの再適用時は値が変わらないため再計算されない)
+		YGNodeCopyStyle(instance->m_yogaNode, m_yogaNode);
+
 		instance->getComponent<Component::LayoutComponent>()
 			.copy(getComponent<Component::LayoutComponent>());
 		instance->getComponent<Component::StyleComponent>()
@@ -309,19 +585,54 @@ namespace FlexLayout::Internal
 
 	std::shared_ptr<FlexBoxNode> FlexBoxNode::deepClone() const
 	{
-		auto newInstance = clone();
-
-		if (m_children)
+		// 複製中のノードと、その子要素として複製済みのノード
+		struct _Frame
 		{
-			Array<std::shared_ptr<FlexBoxNode>> children(Arg::reserve = m_children.size());
-			for (const auto& child : m_children)
+			std::shared_ptr<FlexBoxNode> instance;
+
+			Array<std::shared_ptr<FlexBoxNode>> children;
+		};
+
+		Array<_Frame> stack;
+		std::shared_ptr<FlexBoxNode> result;
+
+		TraverseDepthFirst(
+			*this,
+			[&](const FlexBoxNode& source)
 			{
-				children.push_back(child->deepClone());
+				stack.push_back({ source.clone(), Array<std::shared_ptr<FlexBoxNode>>(Arg::reserve = source.m_children.size()) });
+			},
+			[&](const FlexBoxNode&)
+			{
+				auto [instance, children] = std::move(stack.back());
+				stack.pop_back();
+
+				// 新しく作成したノードのみのため、setChildren()の検証やコンテキストの更新は不要
+				if (children)
+				{
+					Array<YGNodeRef> ygnodes(Arg::reserve = children.size());
+					for (auto [idx, child] : Indexed(children))
+					{
+						child->m_parent = instance.get();
+						child->m_indexInParent = idx;
+						ygnodes.push_back(child->m_yogaNode);
+					}
+					YGNodeSetChildren(instance->m_yogaNode, ygnodes.data(), ygnodes.size());
+					instance->m_children = std::move(children);
+				}
+
+				if (stack.empty())
+				{
+					result = std::move(instance);
+				}
+				else
+				{
+					stack.back().children.push_back(std::move(instance));
+				}
 			}
-			newInstance->setChildren(children);
-		}
+		);
 
-		return newInstance;
+		return result;
 	}
 
 	bool FlexBoxNode::isTextNode() const
@@ -368,10 +679,9 @@ namespace FlexLayout::Internal
 		{
 			return getComponent<Component::StyleComponent>().fontId();
 		}
-		else if (const auto it = m_additonalProperties.find(key);
-			it != m_additonalProperties.end())
+		else if (const auto value = m_additonalProperties.find(AtomTable::Find(key)))
 		{
-			return it->second;
+			return *value;
 		}
 
 		return none;
@@ -379,6 +689,8 @@ namespace FlexLayout::Internal
 
 	void FlexBoxNode::setProperty(const StringView key, const StringView value)
 	{
+		waitForLayoutTask();
+
 		if (key == U"id")
 		{
 			getComponent<Component::XmlAttributeComponent>().setId(MakeOptional<String>(value));
@@ -397,7 +709,7 @@ namespace FlexLayout::Internal
 		}
 		else
 		{
-			m_additonalProperties[key] = value;
+			m_additonalProperties.set(AtomTable::Intern(key), value);
 			if (isUINode())
 			{
 				getComponent<Component::UIComponent>()
@@ -408,6 +720,8 @@ namespace FlexLayout::Internal
 
 	bool FlexBoxNode::removeProperty(const StringView key)
 	{
+		waitForLayoutTask();
+
 		if (key == U"id")
 		{
 			getComponent<Component::XmlAttributeComponent>().setId(none);
@@ -425,7 +739,7 @@ namespace FlexLayout::Internal
 			getComponent<Component::StyleComponent>().setFont({ }, U"");
 		}
 
-		bool success = m_additonalProperties.erase(key);
+		bool success = m_additonalProperties.erase(AtomTable::Find(key));
 		if (isUINode())
 		{
 			getComponent<Component::UIComponent>()
@@ -437,6 +751,8 @@ namespace FlexLayout::Internal
 
 	void FlexBoxNode::clearProperties()
 	{
+		waitForLayoutTask();
+
 		auto& xmlAttr = getComponent<Component::XmlAttributeComponent>();
 		auto& style = getComponent<Component::StyleComponent>();
 
@@ -456,4 +772,117 @@ namespace FlexLayout::Internal
 			height.value_or(YGUndefined),
 			YGDirectionLTR);
 	}
+
+	namespace detail
+	{
+		/// @brief 並列に計算する部分木の最小のノード数 (小さな部分木はスレッドの切り替えの方が高くつく)
+		static constexpr size_t MinParallelSubtreeSize = 32;
+
+		static bool HasAtLeastNodes(const FlexBoxNode& root, size_t count)
+		{
+			size_t visited = 0;
+			return not TraversePreOrder(root, [&](const FlexBoxNode&)
+				{
+					return ++visited >= count ? TraversalAction::Stop : TraversalAction::Continue;
+				});
+		}
+
+		/// @brief 部分木の計算時に親要素から継承する方向 (親要素の解決済みのdirection)
+		/// @remark 全体の計算時と異なる方向を与えると、Yogaのキャッシュが使用されずに再計算される
+		static YGDirection ResolveOwnerDirection(const FlexBoxNode& node, const FlexBoxNode& root)
+		{
+			// 最も近い祖先のdirectionの指定を使用する (ルート要素の外側はLTR)
+			for (const FlexBoxNode* ancestor = node.parent(); ancestor; ancestor = ancestor->parent())
+			{
+				const YGDirection direction = YGNodeStyleGetDirection(ancestor->yogaNode());
+				if (direction != YGDirectionInherit)
+				{
+					return direction;
+				}
+
+				if (ancestor == &root)
+				{
+					break;
+				}
+			}
+
+			return YGDirectionLTR;
+		}
+	}
+
+	void CalculateLayoutParallel(FlexBoxNode& node, Optional<float> width, Optional<float> height)
+	{
+		// 変更のある最も外側のレイアウト境界を集める (変更のない部分木はYogaのキャッシュが使用される)
+		Array<FlexBoxNode*> boundaries;
+		TraversePreOrder(node, [&](FlexBoxNode& current)
+			{
+				const YGNodeConstRef yogaNode = current.yogaNode();
+				if (not YGNodeIsDirty(yogaNode) || YGNodeStyleGetDisplay(yogaNode) == YGDisplayNone)
+				{
+					return TraversalAction::SkipChildren;
+				}
+
+				if (&current != &node && IsLayoutBoundary(current) && detail::HasAtLeastNodes(current, detail::MinParallelSubtreeSize))
+				{
+					boundaries.push_back(&current);
+					return TraversalAction::SkipChildren;
+				}
+
+				return TraversalAction::Continue;
+			});
+
+		if (boundaries.size() >= 2)
+		{
+			// 大きさが固定されているため、親要素の大きさを与えずに計算できる
+			GetConfig().parallelFor(boundaries.size(), [&](size_t i)
+				{
+					YGNodeCalculateLayout(boundaries[i]->yogaNode(), YGUndefined, YGUndefined, detail::ResolveOwnerDirection(*boundaries[i], node));
+				});
+		}
+
+		// 計算済みの境界は再計算されず、位置のみが決定される
+		CalculateLayout(node, width, height);
+	}
+
+	bool IsLayoutBoundary(const FlexBoxNode& node)
+	{
+		const YGNodeConstRef yogaNode = node.yogaNode();
+
+		const auto isPoint = [](YGValue value) { return value.unit == YGUnitPoint; };
+		const auto isPercent = [](YGValue value) { return value.unit == YGUnitPercent; };
+		const auto isAuto = [](YGValue value) { return value.unit == YGUnitAuto || value.unit == YGUnitUndefined; };
+
+		if (not isPoint(YGNodeStyleGetWidth(yogaNode)) || not isPoint(YGNodeStyleGetHeight(yogaNode)))
+		{
+			return false;
+		}
+
+		// 絶対配置の要素はflexの影響を受けない
+		if (YGNodeStyleGetPositionType(yogaNode) != YGPositionTypeAbsolute)
+		{
+			if (YGNodeStyleGetFlexGrow(yogaNode) != 0.0f
+				|| YGNodeStyleGetFlexShrink(yogaNode) != 0.0f
+				|| not isAuto(YGNodeStyleGetFlexBasis(yogaNode)))
+			{
+				return false;
+			}
+		}
+
+		if (isPercent(YGNodeStyleGetMinWidth(yogaNode)) || isPercent(YGNodeStyleGetMaxWidth(yogaNode))
+			|| isPercent(YGNodeStyleGetMinHeight(yogaNode)) || isPercent(YGNodeStyleGetMaxHeight(yogaNode)))
+		{
+			return false;
+		}
+
+		// paddingの割合指定は親要素の幅から計算される
+		for (const auto edge : { YGEdgeLeft, YGEdgeTop, YGEdgeRight, YGEdgeBottom, YGEdgeStart, YGEdgeEnd, YGEdgeHorizontal, YGEdgeVertical, YGEdgeAll })
+		{
+			if (isPercent(YGNodeStyleGetPadding(yogaNode, edge)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
 }
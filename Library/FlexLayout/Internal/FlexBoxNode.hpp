@@ -3,6 +3,7 @@
 #include <Siv3D/Array.hpp>
 #include <Siv3D/Optional.hpp>
 #include <Siv3D/HashTable.hpp>
+#include "PropertyMap.hpp"
 
 using namespace s3d;
 
@@ -64,10 +65,27 @@ namespace FlexLayout::Internal
 
 		const Array<std::shared_ptr<FlexBoxNode>>& children() const { return m_children; }
 
+		/// @brief 親要素の子要素の中での位置を取得する
+		/// @remark 親要素が存在しない場合の値は不定です
+		size_t indexInParent() const { return m_indexInParent; }
+
+		/// @brief 次の兄弟要素を取得する
+		/// @return 存在しない場合はnullptr
+		FlexBoxNode* nextSibling() const;
+
+		/// @brief 前の兄弟要素を取得する
+		/// @return 存在しない場合はnullptr
+		FlexBoxNode* previousSibling() const;
+
 		void setChildren(const Array<std::shared_ptr<FlexBoxNode>>& children);
 
 		void removeChildren();
 
+		/// @brief 子要素を与えられた順序に並べ替える
+		/// @remark 既存の子要素は切り離さずに移動するため、スタイルの再適用やレイアウト結果の破棄が発生しません。
+		/// Yogaのツリーには、順序が保たれない子要素の削除と挿入のみを行います
+		void reconcileChildren(const Array<std::shared_ptr<FlexBoxNode>>& children);
+
 		void insertChild(const std::shared_ptr<FlexBoxNode>& child, size_t index);
 
 		void appendChild(const std::shared_ptr<FlexBoxNode>& child);
@@ -78,6 +96,9 @@ namespace FlexLayout::Internal
 
 		const TreeContext* context() const { return m_context.get(); }
 
+		/// @brief ツリーを変更する前に、ワーカースレッドで実行中のレイアウト計算の完了を待つ
+		void waitForLayoutTask();
+
 		/// @brief ルート要素からの深さを取得する
 		/// @return ルート要素の場合は0、それ以外は1以上
 		size_t getDepth() const;
@@ -104,6 +125,11 @@ namespace FlexLayout::Internal
 
 		static bool BelongsToSameTree(const FlexBoxNode& a, const FlexBoxNode& b);
 
+		/// @brief 解放待ちのノードを1つ取り出して処理する
+		/// @remark 他から参照されていないノードは、子要素を`pending`へ移してから解放します。
+		/// 子孫のデストラクタが再帰的に呼び出されないため、サブツリーを少しずつ解放できます
+		static void DisposeOne(Array<std::shared_ptr<FlexBoxNode>>& pending);
+
 		// --- プロパティ関連 ---
 
 		Optional<String> getProperty(const StringView key) const;
@@ -114,12 +140,15 @@ namespace FlexLayout::Internal
 
 		void clearProperties();
 
-		const HashTable<String, String>& getAdditionalProperties() const { return m_additonalProperties; }
+		const PropertyMap& getAdditionalProperties() const { return m_additonalProperties; }
 
 	private:
 
 		FlexBoxNode* m_parent = nullptr;
 
+		/// @brief 親要素のm_childrenにおける位置
+		size_t m_indexInParent = 0;
+
 		Array<std::shared_ptr<FlexBoxNode>> m_children;
 
 		YGNodeRef m_yogaNode;
@@ -134,16 +163,40 @@ namespace FlexLayout::Internal
 
 		std::shared_ptr<TreeContext> m_context;
 
-		HashTable<String, String> m_additonalProperties;
+		PropertyMap m_additonalProperties;
 
 		void setContext(const std::shared_ptr<TreeContext>& context);
 
 		void setContextImpl(const std::shared_ptr<TreeContext>& context);
 
+		/// @brief すべての子要素を切り離してoutputへ移動する
+		/// @remark 子要素の子孫のコンテキストとオフセットは、`DisposeOne()`で処理する際に解除されます
+		void releaseChildren(Array<std::shared_ptr<FlexBoxNode>>& output);
+
+		/// @brief 子要素をツリーから切り離す (m_childrenとYogaのツリーは変更しない)
+		/// @remark 解放待ちリストが設定されている場合、子孫のコンテキストとオフセットの解除は解放待ちリストで少しずつ行います
+		void detachChild(const std::shared_ptr<FlexBoxNode>& child);
+
+		/// @brief 切り離されたままのノードの、子孫のコンテキストとオフセットを解除する
+		void finishDetach();
+
+		/// @brief first番目以降の子要素の位置を更新する
+		void updateChildIndices(size_t first = 0);
+
 	public:
 
 		~FlexBoxNode();
 	};
 
 	void CalculateLayout(FlexBoxNode& node, Optional<float> width, Optional<float> height);
+
+	/// @brief レイアウト境界の部分木を並列に計算してから、ツリー全体のレイアウトを計算する
+	/// @remark レイアウト境界は、大きさが固定されていて親要素との間で大きさが影響し合わないノードです。
+	/// 境界の部分木は別のYogaのルートとして先に計算され、ツリー全体の計算ではYogaのキャッシュが使用されます
+	void CalculateLayoutParallel(FlexBoxNode& node, Optional<float> width, Optional<float> height);
+
+	/// @brief ノードがレイアウト境界か
+	/// @remark width, heightがpx指定で、flex-grow, flex-shrinkによって大きさが変化せず (または絶対配置)、
+	/// 親要素の大きさに依存するpaddingやmin/max-*の指定がないノードが該当します
+	bool IsLayoutBoundary(const FlexBoxNode& node);
 }
@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <mutex>
+
+namespace FlexLayout::Internal
+{
+	/// @brief フォントのグリフ情報・メトリクスへのアクセスを排他制御する
+	/// @remark Siv3Dのフォントはスレッドセーフではないため、レイアウト計算中 (スタイル適用・テキストの計測) のアクセスはこのロックを取得して行います。
+	/// パイプライン化したレイアウトでは描画とレイアウト計算が並行するため、テキストやUIの描画もこのロックを取得します
+	[[nodiscard]]
+	inline std::unique_lock<std::recursive_mutex> LockFontAccess()
+	{
+		static std::recursive_mutex mutex;
+		return std::unique_lock{ mutex };
+	}
+}
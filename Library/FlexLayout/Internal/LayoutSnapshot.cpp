@@ -0,0 +1,112 @@
+﻿#include <cassert>
+#include <utility>
+#include "LayoutSnapshot.hpp"
+#include "FlexBoxNode.hpp"
+#include "TreeTraversal.hpp"
+#include "NodeComponent/LayoutComponent.hpp"
+#include "NodeComponent/TextComponent.hpp"
+
+namespace FlexLayout::Internal
+{
+	namespace detail
+	{
+		static thread_local bool inLayoutPass = false;
+	}
+
+	void LayoutSnapshotBuffer::clear()
+	{
+		boxes.clear();
+		parentIndices.clear();
+		offsets.clear();
+		borderRects.clear();
+		localBorderRects.clear();
+		margins.clear();
+		borders.clear();
+		paddings.clear();
+		flags.clear();
+	}
+
+	void LayoutSnapshotBuffer::capture(FlexBoxNode& root, Optional<size_t> slot)
+	{
+		assert(IsInLayoutPass());
+
+		clear();
+
+		// 走査中の祖先の番号
+		Array<uint32> ancestors;
+
+		TraverseDepthFirst(root,
+			[&](FlexBoxNode& node)
+			{
+				const uint32 index = static_cast<uint32>(boxes.size());
+
+				auto& layout = node.getComponent<Component::LayoutComponent>();
+				if (slot)
+				{
+					layout.setSnapshotIndex(*slot, index);
+				}
+
+				const Optional<Vec2> offset = layout.layoutOffset();
+				const RectF localBorderRect = layout.localBorderAreaRect();
+
+				uint8 nodeFlags = 0;
+				if (offset)
+				{
+					nodeFlags |= Flags::HasLayout;
+				}
+				if (layout.clipsContents())
+				{
+					nodeFlags |= Flags::ClipsContents;
+				}
+				if (layout.isScrollContainer())
+				{
+					nodeFlags |= Flags::ScrollContainer;
+				}
+
+				boxes.push_back(BoxRef{ node });
+				parentIndices.push_back(ancestors.empty() ? NoParent : ancestors.back());
+				offsets.push_back(offset.value_or(Vec2::Zero()));
+				borderRects.push_back(offset ? localBorderRect.movedBy(*offset) : RectF{ 0, 0, 0, 0 });
+				localBorderRects.push_back(localBorderRect);
+				margins.push_back(layout.margin());
+				borders.push_back(layout.border());
+				paddings.push_back(layout.padding());
+				flags.push_back(nodeFlags);
+
+				// 描画スレッドはテキストの計算中の状態を参照できないため、描画に必要な状態を確定させる
+				if (slot && node.isTextNode())
+				{
+					node.getComponent<Component::TextComponent>().commitDrawState(*slot);
+				}
+
+				ancestors.push_back(index);
+			},
+			[&](FlexBoxNode&)
+			{
+				ancestors.pop_back();
+			});
+	}
+
+	size_t LayoutSnapshotBuffer::allocatedBytes() const
+	{
+		return boxes.capacity() * sizeof(BoxRef)
+			+ parentIndices.capacity() * sizeof(uint32)
+			+ offsets.capacity() * sizeof(Vec2)
+			+ (borderRects.capacity() + localBorderRects.capacity()) * sizeof(RectF)
+			+ (margins.capacity() + borders.capacity() + paddings.capacity()) * sizeof(Thickness)
+			+ flags.capacity() * sizeof(uint8);
+	}
+
+	bool IsInLayoutPass()
+	{
+		return detail::inLayoutPass;
+	}
+
+	ScopedLayoutPass::ScopedLayoutPass()
+		: m_previous{ std::exchange(detail::inLayoutPass, true) } { }
+
+	ScopedLayoutPass::~ScopedLayoutPass()
+	{
+		detail::inLayoutPass = m_previous;
+	}
+}
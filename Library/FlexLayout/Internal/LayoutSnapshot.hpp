@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <Siv3D/Optional.hpp>
+#include "../LayoutSnapshot.hpp"
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	class FlexBoxNode;
+
+	/// @brief レイアウト結果を書き込むスナップショットのバッファ
+	/// @remark パイプライン化したレイアウトでは、計算スレッドが書き込んだバッファを確定後に描画や矩形の取得で参照します
+	struct LayoutSnapshotBuffer : LayoutSnapshot
+	{
+		/// @brief ローカル座標のボーダー領域
+		/// @remark グローバル座標から逆算すると誤差が生じるため、別に保持します
+		Array<RectF> localBorderRects;
+
+		/// @brief 確保したメモリを残したまま空にする
+		void clear();
+
+		/// @brief ツリーのレイアウト結果を1回の走査で書き込む
+		/// @remark レイアウト計算の直後に、計算したスレッドで呼び出します
+		/// @param slot ノードに番号を記録するダブルバッファの番号 (0または1)、noneの場合は記録しません
+		void capture(FlexBoxNode& root, Optional<size_t> slot);
+
+		/// @brief 確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const;
+	};
+
+	/// @brief このスレッドでレイアウトを計算中か
+	/// @remark 計算中は確定済みのスナップショットではなく、計算中の値を参照します
+	bool IsInLayoutPass();
+
+	/// @brief スコープの間、このスレッドをレイアウトの計算中とする
+	class ScopedLayoutPass
+	{
+	public:
+
+		ScopedLayoutPass();
+
+		~ScopedLayoutPass();
+
+		ScopedLayoutPass(const ScopedLayoutPass&) = delete;
+
+		ScopedLayoutPass& operator =(const ScopedLayoutPass&) = delete;
+
+	private:
+
+		bool m_previous;
+	};
+}
@@ -1,6 +1,11 @@
 ﻿#include "LayoutComponent.hpp"
 #include <yoga/Yoga.h>
+#include <Siv3D/Utility.hpp>
 #include "../FlexBoxNode.hpp"
+#include "../TreeTraversal.hpp"
+#include "../TreeContext.hpp"
+#include "../LayoutSnapshot.hpp"
+#include "../Accessor.hpp"
 
 namespace FlexLayout::Internal::Component
 {
@@ -12,49 +17,231 @@ namespace FlexLayout::Internal::Component
 		m_propergateOffsetToChildren = source.m_propergateOffsetToChildren;
 	}
 
+	Optional<Vec2> LayoutComponent::layoutOffset() const
+	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index && (snapshot->flags[*index] & LayoutSnapshot::Flags::HasLayout)
+				? MakeOptional(snapshot->offsets[*index])
+				: none;
+		}
+		return m_layoutOffset;
+	}
+
+	Optional<size_t> LayoutComponent::committedSnapshotSlot() const
+	{
+		if (IsInLayoutPass())
+		{
+			return none;
+		}
+
+		const TreeContext* context = std::as_const(m_node).context();
+		if (not context || not context->isLayoutPipelined())
+		{
+			return none;
+		}
+
+		return context->committedSnapshotSlot();
+	}
+
+	std::pair<const LayoutSnapshotBuffer*, Optional<size_t>> LayoutComponent::committedSnapshotEntry() const
+	{
+		// 計算中のスレッドは計算中の値を参照する (描画スレッドは計算中の値を参照しない)
+		const auto slot = committedSnapshotSlot();
+		if (not slot)
+		{
+			return { nullptr, none };
+		}
+
+		static const LayoutSnapshotBuffer EmptySnapshot{ };
+		const LayoutSnapshotBuffer* snapshot = std::as_const(m_node).context()->committedSnapshot();
+		if (not snapshot)
+		{
+			// 最初の計算結果が確定するまでは、すべての要素をレイアウト前として扱う
+			return { &EmptySnapshot, none };
+		}
+
+		const uint32 index = m_snapshotIndices[*slot];
+		if (index >= snapshot->size() || &Accessor::GetNode(snapshot->boxes[index]) != &m_node)
+		{
+			return { snapshot, none };
+		}
+		return { snapshot, index };
+	}
+
+	void LayoutComponent::setPropergateOffset(bool propergate)
+	{
+		m_node.waitForLayoutTask();
+
+		m_propergateOffsetToChildren = propergate;
+	}
+
 	void LayoutComponent::setLayoutOffsetRecursive(Optional<Vec2> offset, bool force)
 	{
+		TraversePreOrder(m_node, [&](FlexBoxNode& node)
+			{
+				auto& component = node.getComponent<LayoutComponent>();
+
+				if (&node == &m_node)
+				{
+					return component.updateLayoutOffset(offset, force)
+						? TraversalAction::Continue
+						: TraversalAction::SkipChildren;
+				}
+
+				// 親要素は処理済みのため、親要素のオフセットから計算する
+				const auto& parent = node.parent()->getComponent<LayoutComponent>();
+				const Optional<Vec2> childOffset = parent.m_layoutOffset
+					? MakeOptional(parent.childLayoutOffset())
+					: none;
+
+				return component.updateLayoutOffset(childOffset, false)
+					? TraversalAction::Continue
+					: TraversalAction::SkipChildren;
+			});
+	}
+
+	bool LayoutComponent::updateLayoutOffset(Optional<Vec2> offset, bool force)
+	{
+		const bool hasNewLayout = YGNodeGetHasNewLayout(m_node.yogaNode());
+
 		// 更新部分だけ処理する
 		// https://www.yogalayout.dev/docs/advanced/incremental-layout
-		if (not force && offset == m_layoutOffset)
+		if (not force && offset == m_layoutOffset && not hasNewLayout)
 		{
-			if (not YGNodeGetHasNewLayout(m_node.yogaNode()))
-			{
-				return;
-			}
+			return false;
 		}
 		YGNodeSetHasNewLayout(m_node.yogaNode(), false);
 
-		Optional<Vec2> childOffset;
+		if ((force || hasNewLayout) && clipsContents())
+		{
+			updateScrollContentSize();
+		}
+
 		if (offset && YGNodeStyleGetDisplay(m_node.yogaNode()) != YGDisplayNone)
 		{
 			m_layoutOffset = *offset;
-			childOffset = m_propergateOffsetToChildren
-				? *offset + Vec2{ YGNodeLayoutGetLeft(m_node.yogaNode()), YGNodeLayoutGetTop(m_node.yogaNode()) }
-			: Vec2::Zero();
 		}
 		else
 		{
 			m_layoutOffset.reset();
 		}
 
-		for (const auto& child : m_node.children())
+		return true;
+	}
+
+	void LayoutComponent::clearLayoutOffsetRecursive()
+	{
+		TraversePreOrder(m_node, [](FlexBoxNode& node)
+			{
+				node.getComponent<LayoutComponent>().m_layoutOffset.reset();
+			});
+	}
+
+	bool LayoutComponent::clipsContents() const
+	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
 		{
-			child->getComponent<LayoutComponent>().setLayoutOffsetRecursive(childOffset);
+			return index && (snapshot->flags[*index] & LayoutSnapshot::Flags::ClipsContents);
 		}
+		return YGNodeStyleGetOverflow(m_node.yogaNode()) != YGOverflowVisible;
 	}
 
-	void LayoutComponent::clearLayoutOffsetRecursive()
+	bool LayoutComponent::isScrollContainer() const
+	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index && (snapshot->flags[*index] & LayoutSnapshot::Flags::ScrollContainer);
+		}
+		return YGNodeStyleGetOverflow(m_node.yogaNode()) == YGOverflowScroll;
+	}
+
+	void LayoutComponent::setScrollOffset(Vec2 scrollOffset)
+	{
+		m_node.waitForLayoutTask();
+
+		// レイアウト計算前はスクロール範囲が不明なため、制限は次回のオフセット計算時に行う
+		if (m_layoutOffset)
+		{
+			const Vec2 maxOffset = maxScrollOffset();
+			scrollOffset.x = Clamp(scrollOffset.x, 0.0, maxOffset.x);
+			scrollOffset.y = Clamp(scrollOffset.y, 0.0, maxOffset.y);
+		}
+
+		if (scrollOffset == m_scrollOffset)
+		{
+			return;
+		}
+
+		m_scrollOffset = scrollOffset;
+
+		// 子要素のオフセットのみ更新する
+		if (m_layoutOffset)
+		{
+			const Vec2 childOffset = childLayoutOffset();
+			for (const auto& child : m_node.children())
+			{
+				child->getComponent<LayoutComponent>().setLayoutOffsetRecursive(childOffset);
+			}
+		}
+	}
+
+	Vec2 LayoutComponent::maxScrollOffset() const
+	{
+		const SizeF viewportSize = localPaddingAreaRect().size;
+		return {
+			Max(m_scrollContentSize.x - viewportSize.x, 0.0),
+			Max(m_scrollContentSize.y - viewportSize.y, 0.0)
+		};
+	}
+
+	Vec2 LayoutComponent::childLayoutOffset() const
 	{
-		m_layoutOffset.reset();
+		assert(m_layoutOffset);
+
+		const Vec2 base = m_propergateOffsetToChildren
+			? *m_layoutOffset + Vec2{ YGNodeLayoutGetLeft(m_node.yogaNode()), YGNodeLayoutGetTop(m_node.yogaNode()) }
+			: Vec2::Zero();
+
+		return base - m_scrollOffset;
+	}
+
+	void LayoutComponent::updateScrollContentSize()
+	{
+		// 子要素のマージン領域の右下端とパディングの和をスクロール範囲とする
+		const Thickness borderWidth = border();
+		const Thickness paddingWidth = padding();
+
+		Vec2 bottomRight = Vec2::Zero();
 		for (const auto& child : m_node.children())
 		{
-			child->getComponent<LayoutComponent>().clearLayoutOffsetRecursive();
+			if (YGNodeStyleGetDisplay(child->yogaNode()) == YGDisplayNone)
+			{
+				continue;
+			}
+
+			const RectF childRect = child->getComponent<LayoutComponent>().localMarginAreaRect();
+			bottomRight.x = Max(bottomRight.x, childRect.rightX());
+			bottomRight.y = Max(bottomRight.y, childRect.bottomY());
 		}
+
+		m_scrollContentSize = SizeF{
+			bottomRight.x - borderWidth.left + paddingWidth.right,
+			bottomRight.y - borderWidth.top + paddingWidth.bottom
+		};
+
+		const Vec2 maxOffset = maxScrollOffset();
+		m_scrollOffset.x = Clamp(m_scrollOffset.x, 0.0, maxOffset.x);
+		m_scrollOffset.y = Clamp(m_scrollOffset.y, 0.0, maxOffset.y);
 	}
 
 	Thickness LayoutComponent::margin() const
 	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index ? snapshot->margins[*index] : Thickness{ };
+		}
+
 		return Thickness{
 			YGNodeLayoutGetMargin(m_node.yogaNode(), YGEdgeTop),
 			YGNodeLayoutGetMargin(m_node.yogaNode(), YGEdgeRight),
@@ -65,6 +252,11 @@ namespace FlexLayout::Internal::Component
 
 	Thickness LayoutComponent::border() const
 	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index ? snapshot->borders[*index] : Thickness{ };
+		}
+
 		return Thickness{
 			YGNodeLayoutGetBorder(m_node.yogaNode(), YGEdgeTop),
 			YGNodeLayoutGetBorder(m_node.yogaNode(), YGEdgeRight),
@@ -75,6 +267,11 @@ namespace FlexLayout::Internal::Component
 
 	Thickness LayoutComponent::padding() const
 	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index ? snapshot->paddings[*index] : Thickness{ };
+		}
+
 		return Thickness{
 			YGNodeLayoutGetPadding(m_node.yogaNode(), YGEdgeTop),
 			YGNodeLayoutGetPadding(m_node.yogaNode(), YGEdgeRight),
@@ -85,6 +282,11 @@ namespace FlexLayout::Internal::Component
 
 	RectF LayoutComponent::localBorderAreaRect() const
 	{
+		if (const auto [snapshot, index] = committedSnapshotEntry(); snapshot)
+		{
+			return index ? snapshot->localBorderRects[*index] : RectF{ 0, 0, 0, 0 };
+		}
+
 		return RectF{
 			YGNodeLayoutGetLeft(m_node.yogaNode()),
 			YGNodeLayoutGetTop(m_node.yogaNode()),
@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <array>
+#include <limits>
 #include <Siv3D/Vector2D.hpp>
 #include "../../Thickness.hpp"
 #include <Siv3D/RectF.hpp>
@@ -8,10 +10,12 @@ using namespace s3d;
 namespace FlexLayout::Internal
 {
 	class FlexBoxNode;
+	struct LayoutSnapshotBuffer;
 }
 
 namespace FlexLayout::Internal::Component
 {
+	/// @remark パイプライン化したレイアウトでは、レイアウト計算中のスレッド以外からの矩形・余白の取得は確定済みのスナップショットを参照します
 	class LayoutComponent
 	{
 	public:
@@ -22,15 +26,33 @@ namespace FlexLayout::Internal::Component
 
 		void copy(const LayoutComponent& source);
 
-		Optional<Vec2> layoutOffset() const { return m_layoutOffset; }
+		Optional<Vec2> layoutOffset() const;
 
 		void setLayoutOffsetRecursive(Optional<Vec2> offset, bool force = false);
 
 		void clearLayoutOffsetRecursive();
 
+		/// @brief このノードのみオフセットを解除する
+		void clearLayoutOffset() { m_layoutOffset.reset(); }
+
 		bool propergateOffset() const { return m_propergateOffsetToChildren; }
 
-		inline void setPropergateOffset(bool propergate) { m_propergateOffsetToChildren = propergate; }
+		void setPropergateOffset(bool propergate);
+
+		/// @brief overflowがvisible以外に設定されているか
+		bool clipsContents() const;
+
+		/// @brief overflowがscrollに設定されているか
+		bool isScrollContainer() const;
+
+		Vec2 scrollOffset() const { return m_scrollOffset; }
+
+		/// @brief スクロール量を設定し、子要素のオフセットを更新する
+		/// @remark Yogaのレイアウト再計算は行いません
+		void setScrollOffset(Vec2 scrollOffset);
+
+		/// @brief スクロール可能な最大量を取得する
+		Vec2 maxScrollOffset() const;
 
 		Thickness margin() const;
 
@@ -57,32 +79,43 @@ namespace FlexLayout::Internal::Component
 
 		inline Optional<RectF> marginAreaRect() const
 		{
-			return m_layoutOffset
-				? localMarginAreaRect().movedBy(*m_layoutOffset)
+			const auto offset = layoutOffset();
+			return offset
+				? localMarginAreaRect().movedBy(*offset)
 				: Optional<RectF>{};
 		}
 
 		inline Optional<RectF> borderAreaRect() const
 		{
-			return m_layoutOffset
-				? localBorderAreaRect().movedBy(*m_layoutOffset)
+			const auto offset = layoutOffset();
+			return offset
+				? localBorderAreaRect().movedBy(*offset)
 				: Optional<RectF>{};
 		}
 
 		inline Optional<RectF> paddingAreaRect() const
 		{
-			return m_layoutOffset
-				? localPaddingAreaRect().movedBy(*m_layoutOffset)
+			const auto offset = layoutOffset();
+			return offset
+				? localPaddingAreaRect().movedBy(*offset)
 				: Optional<RectF>{};
 		}
 
 		inline Optional<RectF> contentAreaRect() const
 		{
-			return m_layoutOffset
-				? localContentAreaRect().movedBy(*m_layoutOffset)
+			const auto offset = layoutOffset();
+			return offset
+				? localContentAreaRect().movedBy(*offset)
 				: Optional<RectF>{};
 		}
 
+		/// @brief スナップショット内のこのノードの番号を記録する
+		void setSnapshotIndex(size_t slot, uint32 index) { m_snapshotIndices[slot] = index; }
+
+		/// @brief 確定済みのスナップショットを参照する場合、そのダブルバッファの番号
+		/// @remark パイプライン化していない場合や、レイアウト計算中のスレッドではnone
+		Optional<size_t> committedSnapshotSlot() const;
+
 	private:
 
 		FlexBoxNode& m_node;
@@ -92,5 +125,28 @@ namespace FlexLayout::Internal::Component
 
 		/// @brief `setLayoutOffsetRecursive`呼び出し時に、子要素にオフセットを伝播させる
 		bool m_propergateOffsetToChildren = true;
+
+		/// @brief パディング領域の左上を基準としたスクロール量
+		Vec2 m_scrollOffset = Vec2::Zero();
+
+		/// @brief パディング領域の左上を基準とした子要素の範囲 (レイアウト更新時に計算)
+		SizeF m_scrollContentSize = SizeF::Zero();
+
+		static constexpr uint32 InvalidSnapshotIndex = std::numeric_limits<uint32>::max();
+
+		/// @brief ダブルバッファのスナップショットそれぞれでのこのノードの番号
+		std::array<uint32, 2> m_snapshotIndices{ InvalidSnapshotIndex, InvalidSnapshotIndex };
+
+		/// @brief 確定済みのスナップショットと、その中のこのノードの番号
+		/// @return 参照しない場合はnullptr、スナップショットにこのノードが含まれない場合 (確定後に追加された要素) は番号がnone
+		std::pair<const LayoutSnapshotBuffer*, Optional<size_t>> committedSnapshotEntry() const;
+
+		Vec2 childLayoutOffset() const;
+
+		/// @brief このノードのみオフセットを更新する
+		/// @return 子要素の更新が必要な場合はtrue
+		bool updateLayoutOffset(Optional<Vec2> offset, bool force);
+
+		void updateScrollContentSize();
 	};
 }
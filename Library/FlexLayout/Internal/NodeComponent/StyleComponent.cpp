@@ -1,10 +1,14 @@
 ﻿#include "StyleComponent.hpp"
+#include <array>
+#include <algorithm>
 #include "../FlexBoxNode.hpp"
 #include <Siv3D/Indexed.hpp>
 #include <ThirdParty/parallel_hashmap/btree.h>
 #include "../Config.hpp"
 #include "../Style/StyleValueParser.hpp"
 #include "../TreeContext.hpp"
+#include "../TreeTraversal.hpp"
+#include "TextComponent.hpp"
 
 namespace FlexLayout::Internal::Component
 {
@@ -14,12 +18,26 @@ namespace FlexLayout::Internal::Component
 
 	void StyleComponent::copy(const StyleComponent& source)
 	{
-		copyStyles(source);
+		if (m_styles.empty())
+		{
+			// 解析済みのテーブルを共有し、変更時に複製する
+			m_styles = source.m_styles;
+			if (not m_styles.empty())
+			{
+				scheduleStyleApplication();
+			}
+		}
+		else
+		{
+			copyStyles(source);
+		}
 		copyFont(source);
 	}
 
 	void StyleComponent::setInlineCssText(const StringView cssText)
 	{
+		m_node.waitForLayoutTask();
+
 		clearStyles(StylePropertyGroup::Inline);
 
 		size_t beginIdx = 0;
@@ -84,12 +102,17 @@ namespace FlexLayout::Internal::Component
 
 	bool StyleComponent::setStyle(StylePropertyGroup group, const StringView styleName, const std::span<const Style::StyleValue> values)
 	{
+		m_node.waitForLayoutTask();
+
 		if (values.empty() ||
 			std::all_of(values.begin(), values.end(), [](auto& v) { return v.type() == Style::StyleValue::Type::Unspecified; }))
 		{
 			return removeStyle(group, styleName);
 		}
 
+		// 値と適用順がどちらも変わらない場合は再適用しない
+		const bool wasLatest = m_styles.isLatest(group, styleName);
+
 		auto entry = m_styles.get(group, styleName, true);
 		if (not entry)
 		{
@@ -132,19 +155,26 @@ namespace FlexLayout::Internal::Component
 		}
 
 		// スタイルを更新
-		entry->setValue({ values.begin(), values.end() });
-		scheduleStyleApplication();
+		if (entry->setValue({ values.begin(), values.end() }) || not wasLatest)
+		{
+			scheduleStyleApplication();
+		}
 
 		return true;
 	}
 
 	bool StyleComponent::setStyle(StylePropertyGroup group, const StringView styleName, std::span<const Style::ValueInputVariant> inputs)
 	{
+		m_node.waitForLayoutTask();
+
 		if (inputs.empty())
 		{
 			return removeStyle(group, styleName);
 		}
 
+		// 値と適用順がどちらも変わらない場合は再適用しない
+		const bool wasLatest = m_styles.isLatest(group, styleName);
+
 		auto entry = m_styles.get(group, styleName, true);
 		if (not entry)
 		{
@@ -221,22 +251,26 @@ namespace FlexLayout::Internal::Component
 		}
 
 		// スタイルを作成 or 更新
-		entry->setValue(std::move(parsedValues));
-		scheduleStyleApplication();
+		if (entry->setValue(std::move(parsedValues)) || not wasLatest)
+		{
+			scheduleStyleApplication();
+		}
 
 		return true;
 	}
 
 	bool StyleComponent::removeStyle(StylePropertyGroup group, const StringView styleName)
 	{
-		auto entry = m_styles.find(group, styleName);
+		m_node.waitForLayoutTask();
 
-		if (not entry || entry->removed())
+		// 削除済みの場合はテーブルの共有を解除しない
+		if (auto entry = std::as_const(m_styles).find(group, styleName);
+			not entry || entry->removed())
 		{
 			return false;
 		}
 
-		entry->unsetValue();
+		m_styles.find(group, styleName)->unsetValue();
 
 		scheduleStyleApplication();
 
@@ -245,6 +279,22 @@ namespace FlexLayout::Internal::Component
 
 	void StyleComponent::clearStyles(Optional<StylePropertyGroup> group)
 	{
+		m_node.waitForLayoutTask();
+
+		const auto hasValue = [](const StylePropertyTable::group_container_type& g)
+			{
+				return g.any([](const StyleProperty& entry) { return not entry.removed(); });
+			};
+
+		// 削除する値がない場合はテーブルの共有を解除しない
+		const auto& styles = std::as_const(m_styles);
+		if (group
+			? not hasValue(styles.group(*group))
+			: std::none_of(styles.begin(), styles.end(), hasValue))
+		{
+			return;
+		}
+
 		bool modified = false;
 
 		const auto removeAll = [&](StylePropertyTable::group_span_type g)
@@ -309,13 +359,21 @@ namespace FlexLayout::Internal::Component
 		}
 
 		// 待機リストに追加
-		m_node.context().getContext<Context::StyleContext>()
-			.queueStyleApplication(m_node.shared_from_this());
+		// (ツリーに所属していない場合、コンテキストの設定時に追加されるため作成しない)
+		if (std::as_const(m_node).context())
+		{
+			m_node.context().getContext<Context::StyleContext>()
+				.queueStyleApplication(m_node.shared_from_this());
+		}
 		m_isStyleApplicationScheduled = true;
 	}
 
 	void StyleComponent::setFont(const Font& font, const StringView fontId)
 	{
+		m_node.waitForLayoutTask();
+
+		m_pendingFontId.clear();
+
 		if (font == m_font.font)
 		{
 			return;
@@ -331,41 +389,96 @@ namespace FlexLayout::Internal::Component
 
 	void StyleComponent::setFont(const StringView fontId)
 	{
+		m_node.waitForLayoutTask();
+
 		if (fontId.empty())
 		{
 			setFont({ }, U"");
+			return;
 		}
-		else
+
+		if (const auto font = GetConfig().tryLoadFont(fontId))
 		{
-			setFont(GetConfig().loadFont(fontId), fontId);
+			setFont(*font, fontId);
+			return;
+		}
+
+		// 読み込みが完了するまでは親要素またはデフォルトのフォントを使用する
+		setFont({ }, U"");
+		m_pendingFontId = fontId;
+
+		// ツリーに所属していない場合、コンテキストの設定時に追加される
+		if (std::as_const(m_node).context())
+		{
+			m_node.context().getContext<Context::StyleContext>()
+				.queuePendingFont(m_node.shared_from_this());
 		}
 	}
 
 	void StyleComponent::copyFont(const StyleComponent& source)
 	{
+		if (not source.m_pendingFontId.isEmpty())
+		{
+			setFont(source.m_pendingFontId);
+			return;
+		}
+
 		setFont(source.m_font.font, source.m_font.id);
 	}
 
+	bool StyleComponent::resolvePendingFont()
+	{
+		if (m_pendingFontId.isEmpty())
+		{
+			return true;
+		}
+
+		const auto font = GetConfig().tryLoadFont(m_pendingFontId);
+		if (not font)
+		{
+			return false;
+		}
+
+		// フォントが変化したノード以下にのみスタイルを再適用する (em,chなどの再計算とラベルの再計測)
+		const String fontId = std::exchange(m_pendingFontId, String{});
+		setFont(*font, fontId);
+		return true;
+	}
+
 	void StyleComponent::applyStylesImpl()
+	{
+		// テキストスタイルが変化したノードの子要素にのみ伝播させる
+		TraversePreOrder(m_node, [](FlexBoxNode& node)
+			{
+				return node.getComponent<StyleComponent>().applyOwnStyles()
+					? TraversalAction::Continue
+					: TraversalAction::SkipChildren;
+			});
+	}
+
+	bool StyleComponent::applyOwnStyles()
 	{
 		m_isStyleApplicationScheduled = false;
 
-		// font,font-size,line-height,text-alignを事前に計算
+		// font,font-size,line-height,text-alignなどのテキスト設定を事前に計算
 		// (emなど、フォントに関連するサイズ計算に必要)
 
-		const static size_t lineHeightHash = StyleProperty::Hash(U"line-height");
-		const static size_t fontSizeHash = StyleProperty::Hash(U"font-size");
-		const static size_t textAlignHash = StyleProperty::Hash(U"text-align");
+		const static std::array<size_t, 6> textPropertyHashes{
+			StyleProperty::Hash(U"line-height"),
+			StyleProperty::Hash(U"font-size"),
+			StyleProperty::Hash(U"text-align"),
+			StyleProperty::Hash(U"white-space"),
+			StyleProperty::Hash(U"text-overflow"),
+			StyleProperty::Hash(U"max-lines"),
+		};
 
-		constexpr static auto installTextProperty = [](FlexBoxNode& node, StyleProperty* prop) -> void
+		constexpr static auto installTextProperty = [](FlexBoxNode& node, const StyleProperty* prop) -> void
 			{
 				if (not prop)
 				{
 					return;
 				}
 
-				prop->clearEvent();
-
 				if (not prop->removed())
 				{
 					prop->execInstall(node);
@@ -380,37 +493,46 @@ namespace FlexLayout::Internal::Component
 
 		if (m_font.font)
 		{
-			m_computedTextStyle.font = m_font.font;
+			// 親要素と同じフォントの場合はメトリクスを取得し直さない
+			m_computedTextStyle.setFont(m_font.font);
 		}
 
-		auto lineHeightProp = m_styles.find(lineHeightHash);
-		installTextProperty(m_node, lineHeightProp);
+		// 継承されないプロパティは初期値に戻す
+		m_computedTextStyle.textOverflow = GetConfig().defaultTextStyle().textOverflow;
+		m_computedTextStyle.maxLines = GetConfig().defaultTextStyle().maxLines;
 
-		auto fontSizeProp = m_styles.find(fontSizeHash);
-		installTextProperty(m_node, fontSizeProp);
+		// テーブルは他のノードと共有されている場合があるため、読み取りのみで適用する
+		const auto& styles = std::as_const(m_styles);
 
-		auto textAlignProp = m_styles.find(textAlignHash);
-		installTextProperty(m_node, textAlignProp);
+		for (const size_t hash : textPropertyHashes)
+		{
+			installTextProperty(m_node, styles.find(hash));
+		}
 
 		const bool isTextStyleChanged = prevStyle != m_computedTextStyle;
 
+		if (isTextStyleChanged && m_node.isTextNode())
+		{
+			m_node.getComponent<TextComponent>().onTextStyleChanged();
+		}
+
 		// その他のスタイル
 
 		struct _PropertyState
 		{
 			StylePropertyDefinitionRef definition;
 
-			StyleProperty* installedProperty = nullptr;
+			const StyleProperty* installedProperty = nullptr;
 			size_t installationPriority;
 		};
 
 		phmap::btree_map<size_t, _PropertyState> propertyStates;
 		size_t priority = 0;
-		for (auto& group : m_styles)
+		for (const auto& group : styles)
 		{
-			for (auto& prop : group)
+			for (const auto& prop : group)
 			{
-				if (&prop == lineHeightProp || &prop == fontSizeProp || &prop == textAlignProp)
+				if (std::ranges::find(textPropertyHashes, prop.keyHash()) != textPropertyHashes.end())
 				{
 					continue;
 				}
@@ -435,7 +557,7 @@ namespace FlexLayout::Internal::Component
 					auto& affectedKeys = state.definition.maybeAffectTo();
 					if (not affectedKeys.empty())
 					{
-						std::vector<std::pair<size_t, StyleProperty*>> affectedProperties;
+						std::vector<std::pair<size_t, const StyleProperty*>> affectedProperties;
 
 						// 大体2~4個程度なので計算コストは無視できる
 						for (const auto& key : affectedKeys)
@@ -466,18 +588,11 @@ namespace FlexLayout::Internal::Component
 						}
 					}
 				}
-
-				prop.clearEvent();
 			}
 		}
 
-		if (isTextStyleChanged)
-		{
-			// 子要素にも再帰
-			for (const auto& child : m_node.children())
-			{
-				child->getComponent<StyleComponent>().applyStylesImpl();
-			}
-		}
+		m_styles.clearEvents();
+
+		return isTextStyleChanged;
 	}
 }
@@ -37,6 +37,12 @@ namespace FlexLayout::Internal::Component
 
 		Array<Style::StyleValue> getStyle(StylePropertyGroup group, const StringView styleName) const;
 
+		/// @brief グループ内のスタイルを設定順に取得する
+		/// @remark 削除済みのプロパティも含まれます
+		const StylePropertyTable::group_container_type& styles(StylePropertyGroup group) const { return m_styles.group(group); }
+
+		const StylePropertyTable& styleTable() const { return m_styles; }
+
 		bool setStyle(StylePropertyGroup group, const StringView styleName, std::span<const Style::StyleValue> values);
 
 		bool setStyle(StylePropertyGroup group, const StringView styleName, std::span<const Style::ValueInputVariant> values);
@@ -65,6 +71,17 @@ namespace FlexLayout::Internal::Component
 
 		void copyFont(const StyleComponent& source);
 
+		/// @brief 読み込みの完了を待っているフォントアセットの名前
+		/// @remark 読み込みが完了するまでは親要素またはデフォルトのフォントを使用します
+		const String& pendingFontId() const { return m_pendingFontId; }
+
+		/// @brief 読み込みの完了を待っているフォントが利用可能であれば設定する
+		/// @return 待機中のフォントがなくなった場合はtrue
+		bool resolvePendingFont();
+
+		/// @brief スタイルのテーブルを除き、動的に確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const { return (m_font.id.capacity() + m_pendingFontId.capacity()) * sizeof(String::value_type); }
+
 	private:
 
 		friend class Context::StyleContext;
@@ -82,10 +99,17 @@ namespace FlexLayout::Internal::Component
 
 		_FontProperty m_font;
 
+		String m_pendingFontId;
+
 		ComputedTextStyle m_computedTextStyle;
 
 		bool m_isStyleApplicationScheduled = false;
 
+		/// @brief スタイルを適用し、テキストスタイルが変化した場合は子要素にも適用する
 		void applyStylesImpl();
+
+		/// @brief このノードのみスタイルを適用する
+		/// @return テキストスタイルが変化した場合はtrue
+		bool applyOwnStyles();
 	};
 }
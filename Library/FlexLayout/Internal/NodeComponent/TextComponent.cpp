@@ -1,8 +1,10 @@
 ﻿#include "TextComponent.hpp"
+#include <algorithm>
+#include <span>
 #include <yoga/Yoga.h>
 #include "../FlexBoxNode.hpp"
+#include "../FontAccess.hpp"
 #include <Siv3D/Indexed.hpp>
-#include <Siv3D/Char.hpp>
 #include <Siv3D/Step.hpp>
 #include <Siv3D/ScopedCustomShader2D.hpp>
 #include <Siv3D/Graphics2D.hpp>
@@ -69,6 +71,105 @@ namespace FlexLayout::Internal::Component
 			return static_cast<float>(component.computeBaseline());
 		}
 
+		/// @brief 行を描画するための参照
+		struct LinesView
+		{
+			const ShapedText& shaped;
+
+			const ShapedText* ellipsis;
+
+			std::span<const TextLine> lines;
+
+			const Font& font;
+
+			float scale;
+
+			float lineHeight;
+
+			double baseline;
+
+			double xAlign;
+		};
+
+		static void DrawCommittedLines(const DrawState& state, const RectF& rect, const TextStyle& textStyle, const ColorF& color)
+		{
+			DrawLines(
+				{
+					.shaped = *state.shaped,
+					.ellipsis = state.ellipsis.get(),
+					.lines = state.lines,
+					.font = state.font,
+					.scale = state.scale,
+					.lineHeight = state.lineHeight,
+					.baseline = state.baseline,
+					.xAlign = state.xAlign
+				},
+				rect, textStyle, color);
+		}
+
+		static void DrawLines(const LinesView& view, const RectF& rect, const TextStyle& textStyle, const ColorF& color)
+		{
+			const Font& font = view.font;
+			const float scale = view.scale;
+
+			// 描画中も別のスレッドでレイアウトを計算している場合があるため、フォントへのアクセスをロックする
+			// グリフごとにロックしないよう、ラベル1つの描画につき1度だけロックする
+			const auto fontLock = LockFontAccess();
+
+			HasColor fontHasColor{ font.hasColor() };
+			ColorF renderColor = fontHasColor ? Linear::Palette::White : color;
+
+			// シェーダー関連
+			if (textStyle.type != TextStyle::Type::Default && (not fontHasColor))
+			{
+				if (font.method() == FontMethod::SDF)
+				{
+					Graphics2D::SetSDFParameters(textStyle);
+				}
+				else
+				{
+					Graphics2D::SetMSDFParameters(textStyle);
+				}
+			}
+			Optional<ScopedCustomShader2D> shader = textStyle.type != TextStyle::Type::CustomShader
+				? MakeOptional<ScopedCustomShader2D>(Font::GetPixelShader(font.method(), textStyle.type, fontHasColor))
+				: none;
+
+			// 描画ロジック
+			const auto drawGlyph = [&](const ShapedGlyph& shaped, const Vec2& penPos)
+				{
+					if (not shaped.isControl)
+					{
+						// テクスチャはフォントのグリフキャッシュから取得する
+						const Glyph glyph = font.getGlyphByGlyphIndex(shaped.glyphIndex, shaped.fontIndex);
+						glyph.texture.scaled(scale, scale).draw(penPos + glyph.getBase(scale), renderColor);
+					}
+				};
+
+			const auto& glyphs = view.shaped.glyphs;
+			const auto& offsets = view.shaped.glyphOffsets;
+			for (auto [lineIdx, line] : Indexed(view.lines))
+			{
+				Vec2 lineOrigin = rect.pos;
+				lineOrigin.x += (rect.w - line.width) * view.xAlign - offsets[line.begin];
+				lineOrigin.y += view.baseline + view.lineHeight * lineIdx;
+
+				for (size_t glyphIdx : Iota(line.begin, line.end))
+				{
+					drawGlyph(glyphs[glyphIdx], { lineOrigin.x + offsets[glyphIdx], lineOrigin.y });
+				}
+
+				if (line.ellipsis && view.ellipsis)
+				{
+					const double ellipsisX = lineOrigin.x + offsets[line.end];
+					for (auto [i, shaped] : Indexed(view.ellipsis->glyphs))
+					{
+						drawGlyph(shaped, { ellipsisX + view.ellipsis->glyphOffsets[i], lineOrigin.y });
+					}
+				}
+			}
+		}
+
 		static void SetupYGNode(YGNodeRef node)
 		{
 			YGNodeSetMeasureFunc(node, Impl::MeasureLabelCallback);
@@ -95,9 +196,12 @@ namespace FlexLayout::Internal::Component
 
 	void TextComponent::setText(const StringView text)
 	{
+		m_node.waitForLayoutTask();
+
 		if (m_text != text)
 		{
 			m_text = text;
+			m_shapingIsValid = false;
 			m_layoutIsValid = false;
 			YGNodeMarkDirty(m_node.yogaNode());
 		}
@@ -112,8 +216,19 @@ namespace FlexLayout::Internal::Component
 			return;
 		}
 
-		auto& style = styleComponent().computedTextStyle();
-		auto scale = style.fontRenderingScale();
+		// パイプライン化したレイアウトでは、確定済みの状態のみを参照する
+		if (const auto slot = layoutComponent().committedSnapshotSlot())
+		{
+			if (m_drawStates)
+			{
+				const auto& state = (*m_drawStates)[*slot];
+				if (state.shaped)
+				{
+					Impl::DrawCommittedLines(state, *rect, textStyle, color);
+				}
+			}
+			return;
+		}
 
 		// MeasureFuncを呼び出す必要がない場合(width: 100%など)、updateConstraintsが呼び出されないためここで計算
 		// https://github.com/facebook/yoga/issues/959
@@ -122,65 +237,66 @@ namespace FlexLayout::Internal::Component
 			updateConstraints(rect->w);
 		}
 
-		// 描画位置を計算
-		bool ltr = YGNodeLayoutGetDirection(m_node.yogaNode()) != YGDirectionRTL;
-		double xAlign = 0.0;
-		switch (style.textAlign)
+		if (not m_shaped)
 		{
-		case TextAlign::Start: xAlign = ltr ? 0.0 : 1.0; break;
-		case TextAlign::End: xAlign = ltr ? 1.0 : 0.0; break;
-		case TextAlign::Left: xAlign = 0.0; break;
-		case TextAlign::Right: xAlign = 1.0; break;
-		case TextAlign::Center: xAlign = 0.5; break;
+			return;
 		}
 
-		// テキストを描画
-		{
-			HasColor fontHasColor{ style.font.hasColor() };
-			ColorF renderColor = fontHasColor ? Linear::Palette::White : color;
-
-			// シェーダー関連
-			if (textStyle.type != TextStyle::Type::Default && (not fontHasColor))
-			{
-				if (style.font.method() == FontMethod::SDF)
-				{
-					Graphics2D::SetSDFParameters(textStyle);
-				}
-				else
-				{
-					Graphics2D::SetMSDFParameters(textStyle);
-				}
-			}
-			Optional<ScopedCustomShader2D> shader = textStyle.type != TextStyle::Type::CustomShader
-				? MakeOptional<ScopedCustomShader2D>(Font::GetPixelShader(style.font.method(), textStyle.type, fontHasColor))
-				: none;
+		auto& style = styleComponent().computedTextStyle();
 
-			// 描画ロジック
-			size_t beginIdx = 0;
-			auto nextLineBreakItr = m_lineBreaks.cbegin();
-			for (auto [lineIdx, lineWidth] : Indexed(m_lineWidths))
+		// 行の配列は複製せずに参照する
+		Impl::DrawLines(
 			{
-				const size_t endIdx = nextLineBreakItr != m_lineBreaks.cend() ? *nextLineBreakItr++ : m_glyphs.size();
+				.shaped = *m_shaped,
+				.ellipsis = m_ellipsis.get(),
+				.lines = m_lines,
+				.font = style.font,
+				.scale = style.fontRenderingScale(),
+				.lineHeight = style.lineHeightPx(),
+				.baseline = computeBaseline(0),
+				.xAlign = computeXAlign()
+			},
+			*rect, textStyle, color);
+	}
 
-				Vec2 penPos = rect->pos;
-				penPos.x += (rect->w - lineWidth) * xAlign;
-				penPos.y += computeBaseline(lineIdx);
+	void TextComponent::commitDrawState(size_t slot)
+	{
+		const auto rect = layoutComponent().contentAreaRect();
+		if (rect && not m_layoutIsValid)
+		{
+			updateConstraints(rect->w);
+		}
 
-				for (size_t glyphIdx : Iota(beginIdx, endIdx))
-				{
-					const auto& glyph = m_glyphs[glyphIdx];
+		if (not m_drawStates)
+		{
+			m_drawStates = std::make_unique<std::array<DrawState, 2>>();
+		}
 
-					if (not IsControl(glyph.codePoint))
-					{
-						const Vec2 glyphPos = penPos + glyph.getBase(scale);
-						glyph.texture.scaled(scale, scale).draw(glyphPos, renderColor);
-						penPos.x += glyph.xAdvance * scale;
-					}
-				}
+		auto& style = styleComponent().computedTextStyle();
+		auto& state = (*m_drawStates)[slot];
+
+		// 代入により行の配列の確保済みのメモリを再利用する
+		state.shaped = m_shaped;
+		state.ellipsis = m_ellipsis;
+		state.lines = m_lines;
+		state.font = style.font;
+		state.scale = style.fontRenderingScale();
+		state.lineHeight = style.lineHeightPx();
+		state.baseline = computeBaseline(0);
+		state.xAlign = computeXAlign();
+	}
 
-				beginIdx = endIdx;
+	size_t TextComponent::lineCacheBytes() const
+	{
+		size_t bytes = m_lines.capacity() * sizeof(TextLine);
+		if (m_drawStates)
+		{
+			for (const auto& state : *m_drawStates)
+			{
+				bytes += state.lines.capacity() * sizeof(TextLine);
 			}
 		}
+		return bytes;
 	}
 
 	void TextComponent::updateConstraints(double width)
@@ -188,60 +304,228 @@ namespace FlexLayout::Internal::Component
 		m_layoutIsValid = true;
 
 		auto& style = styleComponent().computedTextStyle();
-		auto scale = style.fontRenderingScale();
 
-		m_glyphs.clear();
-		m_lineBreaks.clear();
-		m_lineWidths.clear();
-		if (m_text.isEmpty())
+		const size_t length = visibleTextLength(style);
+		if (not m_shapingIsValid
+			|| m_shapedFont != style.font
+			|| m_shapedScale != style.fontRenderingScale()
+			|| m_shapedLength != length)
+		{
+			shape(style, length);
+		}
+
+		// 同じ幅で繰り返し計測される場合は折り返し結果を再利用する
+		if (width == m_wrappedWidth)
+		{
+			return;
+		}
+
+		wrap(width);
+	}
+
+	size_t TextComponent::visibleTextLength(const ComputedTextStyle& style) const
+	{
+		if (style.whiteSpace != WhiteSpace::Nowrap || style.maxLines == 0)
+		{
+			return m_text.size();
+		}
+
+		// max-lines番目の改行文字まで (改行文字を含めることで、打ち切った行があることを折り返しで判定できる)
+		size_t newlines = 0;
+		for (size_t i = 0; i < m_text.size(); i++)
+		{
+			if (m_text[i] == U'\n' && ++newlines == style.maxLines)
+			{
+				return i + 1;
+			}
+		}
+
+		return m_text.size();
+	}
+
+	void TextComponent::shape(const ComputedTextStyle& style, size_t length)
+	{
+		m_shapingIsValid = true;
+		m_shapedFont = style.font;
+		m_shapedScale = style.fontRenderingScale();
+		m_shapedLength = length;
+		m_wrappedWidth = Math::NaN;
+
+		if (length < m_text.size())
+		{
+			// 表示される範囲のみをシェーピングする (文字列の一部のためキャッシュには登録しない)
+			m_shaped = std::make_shared<const ShapedText>(ShapedText::Shape(m_shapedFont, m_shapedScale, StringView{ m_text }.substr(0, length)));
+			return;
+		}
+
+		// 同じ文字列のテキストノードとシェーピング結果を共有する
+		m_shaped = ShapingCache::Get(m_shapedFont, m_shapedScale, m_text);
+	}
+
+	void TextComponent::wrap(double width)
+	{
+		m_wrappedWidth = width;
+		m_truncated = false;
+
+		m_lines.clear();
+		if (not m_shaped || m_shaped->glyphs.isEmpty())
 		{
+			m_ellipsis.reset();
 			return;
 		}
 
-		m_glyphs = style.font.getGlyphs(m_text, Ligature::Yes);
-		m_lineWidths.push_back(0.0);
+		const auto& style = styleComponent().computedTextStyle();
 
-		for (auto [i, glyph] : Indexed(m_glyphs))
+		width = Max(width, 0.0);
+
+		// nowrapの場合は改行文字の位置でのみ改行する
+		const double wrapWidth = style.whiteSpace == WhiteSpace::Nowrap ? Math::Inf : width;
+		const size_t maxLines = style.maxLines ? style.maxLines : Largest<size_t>;
+
+		const auto& offsets = m_shaped->glyphOffsets;
+		const auto breaksEnd = m_shaped->breakOpportunities.cend();
+
+		uint32 lineStart = 0;
+		auto candidate = m_shaped->breakOpportunities.cbegin();
+		auto paragraphEnd = candidate;
+
+		while (true)
 		{
-			auto& lineWidth = m_lineWidths.back();
+			// 表示されない行は計算しない
+			if (m_lines.size() >= maxLines)
+			{
+				m_truncated = true;
+				break;
+			}
+
+			// 次の強制改行までを探索範囲とする
+			if (paragraphEnd <= candidate)
+			{
+				paragraphEnd = std::find_if(candidate, breaksEnd, [](const BreakOpportunity& b) { return b.mandatory; });
+				assert(paragraphEnd != breaksEnd);
+				++paragraphEnd;
+			}
+
+			// 行末の位置は候補の順に単調増加するため、二分探索で収まる最後の候補を求める
+			const double limit = offsets[lineStart] + wrapWidth;
+			const auto fit = std::upper_bound(candidate, paragraphEnd, limit,
+				[&](double l, const BreakOpportunity& b) { return l < offsets[Max(b.contentEnd, lineStart)]; });
 
-			if (glyph.codePoint == U'\n')
+			if (fit == candidate)
 			{
-				m_lineBreaks.push_back(i + 1);
-				m_lineWidths.push_back(0.0);
+				// 1単語が幅を超える場合はグリフ単位で改行する (少なくとも1グリフは配置する)
+				const auto glyphFit = std::upper_bound(
+					offsets.begin() + lineStart + 1,
+					offsets.begin() + candidate->contentEnd,
+					limit);
+				const uint32 lineEnd = Max(static_cast<uint32>(glyphFit - offsets.begin()) - 1, lineStart + 1);
+
+				m_lines.push_back({ lineStart, lineEnd, offsets[lineEnd] - offsets[lineStart], false });
+				lineStart = lineEnd;
+
+				// 候補の行末まで配置した場合は、その候補で改行したものとする (同じ位置で空の行を追加しない)
+				while (candidate != breaksEnd && candidate->contentEnd <= lineStart)
+				{
+					lineStart = Max(lineStart, candidate->index);
+					if ((candidate++)->mandatory)
+					{
+						break;
+					}
+				}
+
+				if (candidate == breaksEnd)
+				{
+					break;
+				}
 				continue;
 			}
 
-			double xadvance = IsControl(glyph.codePoint) ? 0.0 : glyph.xAdvance * scale;
+			const auto chosen = std::prev(fit);
+			const uint32 lineEnd = Max(chosen->contentEnd, lineStart);
+			m_lines.push_back({ lineStart, lineEnd, offsets[lineEnd] - offsets[lineStart], false });
 
-			if (lineWidth > 0.0 && lineWidth + xadvance > width)
+			lineStart = chosen->index;
+			candidate = std::next(chosen);
+			if (candidate == breaksEnd)
+			{
+				break;
+			}
+		}
+
+		if (style.textOverflow == TextOverflow::Ellipsis)
+		{
+			m_ellipsis = ShapingCache::Get(style.font, style.fontRenderingScale(), U"…");
+			applyEllipsis(width);
+		}
+		else
+		{
+			m_ellipsis.reset();
+		}
+	}
+
+	void TextComponent::applyEllipsis(double width)
+	{
+		const auto& offsets = m_shaped->glyphOffsets;
+		const float ellipsisWidth = m_ellipsis ? m_ellipsis->glyphOffsets.back() : 0.0f;
+
+		for (auto& line : m_lines)
+		{
+			const bool isClampedLine = m_truncated && &line == &m_lines.back();
+			if (line.width <= width && not isClampedLine)
 			{
-				m_lineBreaks.push_back(i);
-				m_lineWidths.push_back(xadvance);
 				continue;
 			}
 
-			lineWidth += xadvance;
+			// 省略記号が収まるまで末尾のグリフを削る
+			const double limit = offsets[line.begin] + width - ellipsisWidth;
+			const auto first = offsets.begin() + line.begin;
+			const auto fit = std::upper_bound(first, offsets.begin() + line.end + 1, limit);
+
+			line.end = fit == first ? line.begin : static_cast<uint32>(fit - offsets.begin()) - 1;
+			line.width = offsets[line.end] - offsets[line.begin] + ellipsisWidth;
+			line.ellipsis = true;
 		}
 	}
 
+	void TextComponent::onTextStyleChanged()
+	{
+		m_layoutIsValid = false;
+		m_wrappedWidth = Math::NaN;
+		YGNodeMarkDirty(m_node.yogaNode());
+	}
+
 	double TextComponent::computeBaseline(size_t lineIdx) const
 	{
 		auto& style = styleComponent().computedTextStyle();
 
 		lineIdx = std::min(lineIdx, lineCount() - 1);
 
+		// フォントのメトリクスはフォントの設定時に取得済みのため、ロックは不要
 		auto lineHeight = style.lineHeightPx();
 		return lineHeight * lineIdx
-			+ style.font.ascender() * style.fontRenderingScale()
-			+ (lineHeight - style.font.height() * style.fontRenderingScale()) * 0.5;
+			+ style.ascenderPx()
+			+ (lineHeight - style.fontHeightPx()) * 0.5;
+	}
+
+	double TextComponent::computeXAlign() const
+	{
+		const bool ltr = YGNodeLayoutGetDirection(m_node.yogaNode()) != YGDirectionRTL;
+		switch (styleComponent().computedTextStyle().textAlign)
+		{
+		case TextAlign::Start: return ltr ? 0.0 : 1.0;
+		case TextAlign::End: return ltr ? 1.0 : 0.0;
+		case TextAlign::Left: return 0.0;
+		case TextAlign::Right: return 1.0;
+		case TextAlign::Center: return 0.5;
+		}
+		return 0.0;
 	}
 
 	SizeF TextComponent::computeBoundingBox() const
 	{
 		auto& style = styleComponent().computedTextStyle();
 		return {
-			m_lineWidths.empty() ? 0.0 : *std::max_element(m_lineWidths.begin(), m_lineWidths.end()),
+			m_lines.empty() ? 0.0 : std::ranges::max(m_lines, {}, &TextLine::width).width,
 			style.lineHeightPx() * lineCount()
 		};
 	}
@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <array>
+#include <memory>
 #include <Siv3D/String.hpp>
 #include <Siv3D/Array.hpp>
 #include <Siv3D/HashTable.hpp>
@@ -6,9 +8,11 @@
 #include <Siv3D/Vector2D.hpp>
 #include <Siv3D/Glyph.hpp>
 #include <Siv3D/TextStyle.hpp>
+#include <Siv3D/MathConstants.hpp>
 
 #include "StyleComponent.hpp"
 #include "LayoutComponent.hpp"
+#include "../ShapingCache.hpp"
 
 using namespace s3d;
 
@@ -35,22 +39,114 @@ namespace FlexLayout::Internal::Component
 
 		void draw(const TextStyle& textStyle, const ColorF& color);
 
+		/// @brief 文字列が確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const { return m_text.capacity() * sizeof(String::value_type); }
+
+		/// @brief 折り返し後の行が確保しているメモリの量 (バイト)
+		/// @remark 共有されているシェーピング結果は含みません
+		size_t lineCacheBytes() const;
+
+		/// @brief シェーピング結果 (テキストが空の場合やレイアウト前はnullptr)
+		/// @remark 同じフォント・描画スケール・文字列のテキストノードで共有されます。
+		/// `white-space: nowrap`と`max-lines`で表示される範囲が決まる場合は、その範囲のみをシェーピングし共有しません
+		const std::shared_ptr<const ShapedText>& shapedText() const { return m_shaped; }
+
+		/// @brief 保持しているグリフの数
+		size_t glyphCount() const { return m_shaped ? m_shaped->glyphs.size() : 0; }
+
+		/// @brief 改行位置の候補の数 (テキストの末尾を含む)
+		size_t breakOpportunityCount() const { return m_shaped ? m_shaped->breakOpportunities.size() : 0; }
+
+		/// @brief 折り返し後の行の数
+		size_t lineCount() const { return m_lines.size(); }
+
+		/// @brief `max-lines`により表示されない行がある場合はtrue
+		bool isTruncated() const { return m_truncated; }
+
+		/// @brief 継承したテキストの設定が変化したときに呼び出す
+		void onTextStyleChanged();
+
+		/// @brief 描画に必要な状態を確定させる
+		/// @remark パイプライン化したレイアウトで、レイアウト計算の直後に計算したスレッドから呼び出します。
+		/// 描画スレッドは確定済みの状態のみを参照します
+		/// @param slot ダブルバッファの番号 (0または1)
+		void commitDrawState(size_t slot);
+
 	private:
 
 		struct Impl;
 
+		/// @brief 折り返し後の行
+		struct TextLine
+		{
+			/// @brief 行の先頭のグリフの番号
+			uint32 begin;
+
+			/// @brief 描画する最後のグリフの次の番号 (末尾の空白と省略したグリフを除く)
+			uint32 end;
+
+			/// @brief 行幅 (省略記号を含む)
+			float width;
+
+			/// @brief 末尾に省略記号を描画する場合はtrue
+			bool ellipsis;
+		};
+
+		/// @brief 描画に必要な状態の複製
+		struct DrawState
+		{
+			std::shared_ptr<const ShapedText> shaped;
+
+			std::shared_ptr<const ShapedText> ellipsis;
+
+			Array<TextLine> lines;
+
+			Font font;
+
+			float scale = 1.0f;
+
+			float lineHeight = 0.0f;
+
+			/// @brief 先頭行のベースライン
+			double baseline = 0.0;
+
+			/// @brief 行の水平方向の位置 (0.0で左揃え、1.0で右揃え)
+			double xAlign = 0.0;
+		};
+
 		FlexBoxNode& m_node;
 
 		String m_text;
 
-		Array<Glyph> m_glyphs;
+		/// @brief シェーピング結果 (`ShapingCache`から取得)
+		std::shared_ptr<const ShapedText> m_shaped;
+
+		Array<TextLine> m_lines;
+
+		/// @brief 省略記号のシェーピング結果 (`text-overflow: ellipsis`の場合のみ)
+		std::shared_ptr<const ShapedText> m_ellipsis;
+
+		/// @brief シェーピングに使用したフォント
+		Font m_shapedFont;
+
+		/// @brief シェーピングに使用した描画スケール
+		float m_shapedScale = 0.0f;
+
+		/// @brief シェーピングした文字列の長さ (表示されない部分を除く)
+		size_t m_shapedLength = 0;
 
-		Array<size_t> m_lineBreaks;
+		/// @brief 折り返しに使用した幅
+		double m_wrappedWidth = Math::NaN;
 
-		Array<double> m_lineWidths;
+		bool m_shapingIsValid = false;
+
+		bool m_truncated = false;
 
 		bool m_layoutIsValid = false;
 
+		/// @brief パイプライン化したレイアウトで確定させた描画状態 (最初の確定時に生成)
+		std::unique_ptr<std::array<DrawState, 2>> m_drawStates;
+
 		StyleComponent& styleComponent();
 
 		const StyleComponent& styleComponent() const;
@@ -59,12 +155,27 @@ namespace FlexLayout::Internal::Component
 
 		const LayoutComponent& layoutComponent() const;
 
-		size_t lineCount() const { return m_lineWidths.size(); }
-
 		void updateConstraints(double width);
 
+		/// @brief シェーピングが必要な文字列の長さ
+		/// @remark nowrapの場合は改行文字の位置でのみ改行するため、`max-lines`番目の改行文字より後は表示されません
+		size_t visibleTextLength(const ComputedTextStyle& style) const;
+
+		/// @brief シェーピング結果をキャッシュから取得する
+		/// @param length シェーピングする先頭からの長さ (文字列の一部の場合はキャッシュを使用しません)
+		void shape(const ComputedTextStyle& style, size_t length);
+
+		/// @brief 改行位置の候補から、指定した幅に収まるように行を分割する
+		/// @remark `max-lines`に達した時点で分割を終了します
+		void wrap(double width);
+
+		/// @brief 幅を超える行と、`max-lines`で打ち切った最後の行の末尾を省略記号に置き換える
+		void applyEllipsis(double width);
+
 		double computeBaseline(size_t lineIdx = Largest<size_t>) const;
 
+		double computeXAlign() const;
+
 		SizeF computeBoundingBox() const;
 	};
 }
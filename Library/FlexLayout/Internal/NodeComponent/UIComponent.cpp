@@ -1,7 +1,7 @@
 ﻿#include "UIComponent.hpp"
 #include "../../UIState.hpp"
 #include "../FlexBoxNode.hpp"
-#include "../../Box.hpp"
+#include "../../BoxRef.hpp"
 
 namespace FlexLayout::Internal::Component
 {
@@ -22,7 +22,8 @@ namespace FlexLayout::Internal::Component
 	{
 		if (m_state)
 		{
-			m_state->draw(UIStateQuery{ m_node }, Box{ m_node.shared_from_this() });
+			// フォントへのアクセスのロックは各UIStateが必要な範囲で取得する (UIStateQuery::LockFontAccess)
+			m_state->draw(UIStateQuery{ m_node }, BoxRef{ m_node });
 		}
 	}
 
@@ -30,7 +31,7 @@ namespace FlexLayout::Internal::Component
 	{
 		if (m_state)
 		{
-			m_state->update(UIStateQuery{ m_node }, Box{ m_node.shared_from_this() });
+			m_state->update(UIStateQuery{ m_node }, BoxRef{ m_node });
 		}
 	}
 
@@ -49,7 +50,7 @@ namespace FlexLayout::Internal::Component
 		// setState前に追加した設定を追って適用
 		for (const auto& [key, value] : m_node.getAdditionalProperties())
 		{
-			m_state->setProperty(UIStateQuery{ m_node }, key, value);
+			m_state->setProperty(UIStateQuery{ m_node }, AtomTable::ToString(key), value);
 		}
 		if (m_text)
 		{
@@ -75,6 +76,13 @@ namespace FlexLayout::Internal::Component
 
 	void UIComponent::setTextContent(const StringView text)
 	{
+		m_node.waitForLayoutTask();
+
+		if (m_text == text)
+		{
+			return;
+		}
+
 		m_text = text;
 		if (m_state)
 		{
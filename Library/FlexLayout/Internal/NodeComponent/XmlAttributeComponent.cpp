@@ -1,6 +1,6 @@
 ﻿#include "XmlAttributeComponent.hpp"
-#include <Siv3D/HeterogeneousLookupHelper.hpp>
 #include "../FlexBoxNode.hpp"
+#include "../TreeTraversal.hpp"
 
 namespace FlexLayout::Internal::Component
 {
@@ -12,43 +12,72 @@ namespace FlexLayout::Internal::Component
 		m_tagName = source.m_tagName;
 		m_id = source.m_id;
 		m_classes = source.m_classes;
+		m_sourceAttributes = source.m_sourceAttributes;
+	}
+
+	Optional<String> XmlAttributeComponent::id() const
+	{
+		if (m_id == Atom::None)
+		{
+			return none;
+		}
+		return AtomTable::ToString(m_id);
 	}
 
 	void XmlAttributeComponent::setId(const Optional<String>& id)
 	{
 		assert(not id || not id->isEmpty());
 
-		m_id = id;
+		m_id = id ? AtomTable::Intern(*id) : Atom::None;
+	}
+
+	Array<String> XmlAttributeComponent::classes() const
+	{
+		return m_classes.map([](Atom className) { return AtomTable::ToString(className); });
 	}
 
 	void XmlAttributeComponent::setClasses(const Array<String>& classes)
 	{
+		m_classes.clear();
 		for (const auto& className : classes)
 		{
 			assert(not className.isEmpty());
-		}
 
-		m_classes = classes;
+			const auto atom = AtomTable::Intern(className);
+			if (not m_classes.contains(atom))
+			{
+				m_classes.push_back(atom);
+			}
+		}
 	}
 
 	String XmlAttributeComponent::getClassText() const
 	{
-		return m_classes.join(U" ", U"", U"");
+		String result;
+		for (auto className : m_classes)
+		{
+			if (result)
+			{
+				result += U' ';
+			}
+			result += AtomTable::ToString(className);
+		}
+		return result;
 	}
 
 	void XmlAttributeComponent::setClassText(const StringView classText)
 	{
 		m_classes.clear();
-		for (auto& className : String{ classText }.split(U' '))
+		for (const auto& className : String{ classText }.split(U' '))
 		{
-			className = className.trimmed();
-			if (className.isEmpty())
+			const auto atom = AtomTable::Intern(className.trimmed());
+			if (atom == Atom::None)
 			{
 				continue;
 			}
-			if (not m_classes.contains(className))
+			if (not m_classes.contains(atom))
 			{
-				m_classes.emplace_back(std::move(className));
+				m_classes.push_back(atom);
 			}
 		}
 	}
@@ -67,13 +96,14 @@ namespace FlexLayout::Internal::Component
 			throw Error{ U"FlexBox: Class name should not contain space" };
 		}
 
-		if (m_classes.contains(str))
+		const auto atom = AtomTable::Intern(str);
+		if (m_classes.contains(atom))
 		{
 			return false;
 		}
 		else
 		{
-			m_classes.emplace_back(std::move(str));
+			m_classes.push_back(atom);
 			return true;
 		}
 	}
@@ -92,63 +122,88 @@ namespace FlexLayout::Internal::Component
 			throw Error{ U"FlexBox: Class name should not contain space" };
 		}
 
+		// 未登録のクラス名はどのノードにも設定されていない
+		const auto atom = AtomTable::Find(str);
+		if (atom == Atom::Invalid)
+		{
+			return false;
+		}
+
 		auto prevSize = m_classes.size();
-		m_classes.remove(str);
+		m_classes.remove(atom);
 		return m_classes.size() != prevSize;
 	}
 
 	bool XmlAttributeComponent::lookupNodeByInstance(const std::shared_ptr<FlexBoxNode>& node)
 	{
-		if (m_node.shared_from_this() == node)
-		{
-			return true;
-		}
-
-		for (const auto& child : m_node.children())
-		{
-			if (child->getComponent<XmlAttributeComponent>().lookupNodeByInstance(node))
+		const bool completed = TraversePreOrder(m_node, [&](const FlexBoxNode& item)
 			{
-				return true;
-			}
-		}
+				return &item == node.get()
+					? TraversalAction::Stop
+					: TraversalAction::Continue;
+			});
 
-		return false;
+		return not completed;
 	}
 
 	void XmlAttributeComponent::lookupNodesByClassName(Array<std::shared_ptr<FlexBoxNode>>& list, const String& className, size_t limit)
 	{
-		if (list.size() >= limit)
+		const auto atom = AtomTable::Find(className);
+		if (atom == Atom::None || atom == Atom::Invalid)
 		{
 			return;
 		}
 
-		if (m_classes.contains(className))
-		{
-			list.push_back(m_node.shared_from_this());
-		}
-
-		for (const auto& child : m_node.children())
-		{
-			child->getComponent<XmlAttributeComponent>()
-				.lookupNodesByClassName(list, className, limit);
-		}
+		TraversePreOrder(m_node, [&](FlexBoxNode& item)
+			{
+				if (list.size() >= limit)
+				{
+					return TraversalAction::Stop;
+				}
+
+				if (item.getComponent<XmlAttributeComponent>().hasClass(atom))
+				{
+					list.push_back(item.shared_from_this());
+				}
+
+				return TraversalAction::Continue;
+			});
 	}
 
 	std::shared_ptr<FlexBoxNode> XmlAttributeComponent::lookupNodeById(const StringView id)
 	{
-		if (m_id == id)
+		const auto atom = AtomTable::Find(id);
+		if (atom == Atom::None || atom == Atom::Invalid)
 		{
-			return m_node.shared_from_this();
+			return nullptr;
 		}
 
-		for (const auto& child : m_node.children())
-		{
-			if (auto node = child->getComponent<XmlAttributeComponent>().lookupNodeById(id))
+		std::shared_ptr<FlexBoxNode> result;
+
+		TraversePreOrder(m_node, [&](FlexBoxNode& item)
 			{
-				return node;
-			}
+				if (item.getComponent<XmlAttributeComponent>().m_id == atom)
+				{
+					result = item.shared_from_this();
+					return TraversalAction::Stop;
+				}
+
+				return TraversalAction::Continue;
+			});
+
+		return result;
+	}
+
+	size_t XmlAttributeComponent::allocatedBytes() const
+	{
+		size_t bytes = m_classes.capacity() * sizeof(Atom)
+			+ m_sourceAttributes.capacity() * sizeof(decltype(m_sourceAttributes)::value_type);
+
+		for (const auto& [key, value] : m_sourceAttributes)
+		{
+			bytes += key.capacity() + value.capacity();
 		}
 
-		return { };
+		return bytes;
 	}
 }
@@ -3,6 +3,7 @@
 #include <Siv3D/Array.hpp>
 #include <Siv3D/HashTable.hpp>
 #include <Siv3D/Optional.hpp>
+#include "../Atom.hpp"
 
 using namespace s3d;
 
@@ -23,15 +24,25 @@ namespace FlexLayout::Internal::Component
 
 		void copy(const XmlAttributeComponent& source);
 
-		const String& tagName() const { return m_tagName; }
+		const String& tagName() const { return AtomTable::ToString(m_tagName); }
 
-		void setTagName(const StringView tagName) { m_tagName = tagName; }
+		Atom tagAtom() const { return m_tagName; }
 
-		Optional<String> id() const { return m_id; }
+		void setTagName(const StringView tagName) { m_tagName = AtomTable::Intern(tagName); }
+
+		Optional<String> id() const;
+
+		/// @brief IDのアトム、IDが設定されていない場合は`Atom::None`
+		Atom idAtom() const { return m_id; }
 
 		void setId(const Optional<String>& id);
 
-		const Array<String>& classes() const { return m_classes; }
+		Array<String> classes() const;
+
+		/// @brief クラス名のアトム (記述順)
+		const Array<Atom>& classAtoms() const { return m_classes; }
+
+		bool hasClass(Atom className) const { return m_classes.contains(className); }
 
 		void setClasses(const Array<String>& classes);
 
@@ -51,14 +62,27 @@ namespace FlexLayout::Internal::Component
 
 		std::shared_ptr<FlexBoxNode> lookupNodeById(const StringView id);
 
+		/// @brief 前回XMLから読み込んだ属性の一覧 (UTF-8)
+		/// @remark ホットリロード時に差分を取るために使用します
+		const Array<std::pair<std::string, std::string>>& sourceAttributes() const { return m_sourceAttributes; }
+
+		void setSourceAttributes(Array<std::pair<std::string, std::string>>&& attributes) { m_sourceAttributes = std::move(attributes); }
+
+		/// @brief 動的に確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const;
+
 	private:
 
 		FlexBoxNode& m_node;
 
-		String m_tagName;
+		Atom m_tagName = Atom::None;
+
+		Atom m_id = Atom::None;
 
-		Optional<String> m_id;
+		/// @brief クラス名 (記述順、重複なし)
+		/// @remark 1つのノードが持つクラスは少数のため、整数の線形探索で判定します
+		Array<Atom> m_classes;
 
-		Array<String> m_classes;
+		Array<std::pair<std::string, std::string>> m_sourceAttributes;
 	};
 }
@@ -0,0 +1,48 @@
+﻿#include "NodeGraveyard.hpp"
+#include <Siv3D/Stopwatch.hpp>
+#include "FlexBoxNode.hpp"
+
+namespace FlexLayout::Internal
+{
+	namespace detail
+	{
+		/// @brief 経過時間を確認する間隔 (ノード数)
+		constexpr size_t GraveyardTimeCheckInterval = 16;
+	}
+
+	void NodeGraveyard::bury(std::shared_ptr<FlexBoxNode> node)
+	{
+		if (node)
+		{
+			m_pending.push_back(std::move(node));
+		}
+	}
+
+	bool NodeGraveyard::drain(Duration budget)
+	{
+		const Stopwatch stopwatch{ StartImmediately::Yes };
+
+		while (not m_pending.empty())
+		{
+			for (size_t i = 0; i < detail::GraveyardTimeCheckInterval && not m_pending.empty(); i++)
+			{
+				FlexBoxNode::DisposeOne(m_pending);
+			}
+
+			if (stopwatch.elapsed() >= budget)
+			{
+				break;
+			}
+		}
+
+		return not m_pending.empty();
+	}
+
+	void NodeGraveyard::clear()
+	{
+		while (not m_pending.empty())
+		{
+			FlexBoxNode::DisposeOne(m_pending);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <Siv3D/Array.hpp>
+#include <Siv3D/Duration.hpp>
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	class FlexBoxNode;
+
+	/// @brief 切り離されたノードを預かり、少しずつ解放する
+	/// @remark 大きなサブツリーの解放によって1フレームの処理時間が増大するのを防ぎます
+	class NodeGraveyard
+	{
+	public:
+
+		/// @brief ノードを解放待ちにする
+		/// @remark 他から参照されているノードは解放されず、子孫のコンテキストとオフセットを解除して参照が手放されるだけです
+		void bury(std::shared_ptr<FlexBoxNode> node);
+
+		/// @brief 時間の範囲内でノードを解放する
+		/// @param budget 解放処理に使用する時間
+		/// @return 解放待ちのノードが残っている場合はtrue
+		bool drain(Duration budget);
+
+		/// @brief すべてのノードを解放する
+		void clear();
+
+		/// @brief 解放待ちのノード (子孫のうち未処理のものを含む) の数
+		size_t size() const { return m_pending.size(); }
+
+	private:
+
+		Array<std::shared_ptr<FlexBoxNode>> m_pending;
+	};
+}
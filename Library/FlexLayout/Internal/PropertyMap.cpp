@@ -0,0 +1,112 @@
+﻿#include <algorithm>
+#include "PropertyMap.hpp"
+
+namespace FlexLayout::Internal
+{
+	const String* PropertyMap::find(Atom key) const
+	{
+		for (const auto& [itemKey, value] : *this)
+		{
+			if (itemKey == key)
+			{
+				return &value;
+			}
+		}
+		return nullptr;
+	}
+
+	bool PropertyMap::set(Atom key, StringView value)
+	{
+		assert(key != Atom::None && key != Atom::Invalid);
+
+		auto items = data();
+		for (size_t i = 0; i < size(); i++)
+		{
+			if (items[i].first == key)
+			{
+				if (items[i].second == value)
+				{
+					return false;
+				}
+				items[i].second = value;
+				return true;
+			}
+		}
+
+		if (m_overflow.isEmpty() && m_inlineSize < InlineCapacity)
+		{
+			m_inline[m_inlineSize++] = { key, String{ value } };
+			return true;
+		}
+
+		if (m_overflow.isEmpty())
+		{
+			// インライン領域の要素を移して以降は動的確保した領域のみを使用する
+			m_overflow.reserve(InlineCapacity * 2);
+			for (size_t i = 0; i < m_inlineSize; i++)
+			{
+				m_overflow.push_back(std::move(m_inline[i]));
+				m_inline[i] = {};
+			}
+			m_inlineSize = 0;
+		}
+
+		m_overflow.emplace_back(key, String{ value });
+		return true;
+	}
+
+	bool PropertyMap::erase(Atom key)
+	{
+		if (not m_overflow.isEmpty())
+		{
+			auto itr = std::find_if(m_overflow.begin(), m_overflow.end(), [&](const auto& item) { return item.first == key; });
+			if (itr == m_overflow.end())
+			{
+				return false;
+			}
+			m_overflow.erase(itr);
+			return true;
+		}
+
+		for (size_t i = 0; i < m_inlineSize; i++)
+		{
+			if (m_inline[i].first == key)
+			{
+				// 順序を保って詰める
+				for (size_t k = i + 1; k < m_inlineSize; k++)
+				{
+					m_inline[k - 1] = std::move(m_inline[k]);
+				}
+				m_inline[--m_inlineSize] = {};
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void PropertyMap::clear()
+	{
+		for (size_t i = 0; i < m_inlineSize; i++)
+		{
+			m_inline[i] = {};
+		}
+		m_inlineSize = 0;
+
+		// ホットリロードで再び設定されることが多いため、確保した領域は保持する
+		m_overflow.clear();
+	}
+
+	size_t PropertyMap::allocatedBytes() const
+	{
+		size_t bytes = m_overflow.capacity() * sizeof(value_type);
+
+		for (const auto& [key, value] : *this)
+		{
+			// SSOに収まる短い文字列も容量として計上する (上限の見積もり)
+			bytes += value.capacity() * sizeof(String::value_type);
+		}
+
+		return bytes;
+	}
+}
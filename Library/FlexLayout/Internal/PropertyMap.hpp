@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <array>
+#include <Siv3D/Array.hpp>
+#include "Atom.hpp"
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	/// @brief ノードの追加属性を保持する小さな連想配列
+	/// @details ほとんどのノードは追加属性を持たないか1つだけのため、`InlineCapacity`件までは動的確保を行わずに保持します。
+	/// キーはインターン化した属性名で、検索は整数の線形探索です
+	/// @remark 要素は常に連続した領域に格納され、挿入順に列挙されます
+	class PropertyMap
+	{
+	public:
+
+		using value_type = std::pair<Atom, String>;
+
+		static constexpr size_t InlineCapacity = 1;
+
+		const value_type* begin() const { return data(); }
+
+		const value_type* end() const { return data() + size(); }
+
+		size_t size() const { return m_overflow.isEmpty() ? m_inlineSize : m_overflow.size(); }
+
+		bool isEmpty() const { return size() == 0; }
+
+		/// @brief 値を検索する
+		/// @return 見つからない場合はnullptr
+		const String* find(Atom key) const;
+
+		/// @brief 値を設定する
+		/// @return 値が変化した場合はtrue
+		bool set(Atom key, StringView value);
+
+		/// @brief 値を削除する
+		/// @return 削除した場合はtrue
+		bool erase(Atom key);
+
+		void clear();
+
+		/// @brief 動的に確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const;
+
+	private:
+
+		std::array<value_type, InlineCapacity> m_inline{};
+
+		size_t m_inlineSize = 0;
+
+		/// @brief InlineCapacityを超えた場合の格納先 (使用中はすべての要素をこちらに格納)
+		Array<value_type> m_overflow;
+
+		const value_type* data() const { return m_overflow.isEmpty() ? m_inline.data() : m_overflow.data(); }
+
+		value_type* data() { return m_overflow.isEmpty() ? m_inline.data() : m_overflow.data(); }
+	};
+}
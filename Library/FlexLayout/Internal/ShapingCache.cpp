@@ -0,0 +1,330 @@
+﻿#include <list>
+#include <mutex>
+#include <Siv3D/HashTable.hpp>
+#include <Siv3D/Char.hpp>
+#include "ShapingCache.hpp"
+#include "FontAccess.hpp"
+
+namespace FlexLayout::Internal
+{
+	namespace detail
+	{
+		/// @brief 改行位置の判定に使用する文字の分類 (UAX #14を簡略化したもの)
+		enum class BreakClass : uint8
+		{
+			/// @brief 空白 (直後で改行可能)
+			Space,
+
+			/// @brief 改行文字
+			Newline,
+
+			/// @brief 漢字・かななど、前後で改行可能な文字
+			Ideographic,
+
+			/// @brief 開き括弧 (直後で改行しない)
+			OpenPunctuation,
+
+			/// @brief 閉じ括弧・句読点・小書きの仮名など (直前で改行しない)
+			ClosePunctuation,
+
+			/// @brief ハイフン (直後で改行可能)
+			Hyphen,
+
+			/// @brief その他 (単語の一部)
+			Alphabetic,
+		};
+
+		static BreakClass GetBreakClass(char32 ch)
+		{
+			constexpr StringView openPunctuations = U"([{（［｛「『【〔〈《〘〖“‘";
+			constexpr StringView closePunctuations = U")]}.,:;!?%）］｝」』】〕〉》〙〗”’、。，．：；！？・ーゝゞヽヾ々ぁぃぅぇぉっゃゅょゎゕゖァィゥェォッャュョヮヵヶ";
+
+			if (ch == U'\n')
+			{
+				return BreakClass::Newline;
+			}
+
+			if (ch == U' ' || ch == U'\t' || ch == U'\u3000')
+			{
+				return BreakClass::Space;
+			}
+
+			if (ch == U'-' || ch == U'\u2010' || ch == U'\u2013')
+			{
+				return BreakClass::Hyphen;
+			}
+
+			if (openPunctuations.includes(ch))
+			{
+				return BreakClass::OpenPunctuation;
+			}
+
+			if (closePunctuations.includes(ch))
+			{
+				return BreakClass::ClosePunctuation;
+			}
+
+			const bool isIdeographic =
+				(U'\u2E80' <= ch && ch <= U'\u9FFF') // CJK部首・かな・CJK統合漢字など
+				|| (U'\uAC00' <= ch && ch <= U'\uD7AF') // ハングル
+				|| (U'\uF900' <= ch && ch <= U'\uFAFF') // CJK互換漢字
+				|| (U'\uFF01' <= ch && ch <= U'\uFF60') // 全角英数・記号
+				|| (U'\U00020000' <= ch && ch <= U'\U0003FFFF'); // CJK統合漢字拡張
+
+			return isIdeographic ? BreakClass::Ideographic : BreakClass::Alphabetic;
+		}
+
+		/// @brief 2つの文字の間で改行できるか
+		static bool IsBreakAllowed(BreakClass before, BreakClass after)
+		{
+			// 改行文字は強制改行として別に扱う
+			if (before == BreakClass::Newline || after == BreakClass::Newline)
+			{
+				return false;
+			}
+
+			// 空白は前の行の末尾に残す
+			if (after == BreakClass::Space)
+			{
+				return false;
+			}
+
+			if (after == BreakClass::ClosePunctuation || before == BreakClass::OpenPunctuation)
+			{
+				return false;
+			}
+
+			return before == BreakClass::Space
+				|| before == BreakClass::Hyphen
+				|| before == BreakClass::Ideographic
+				|| after == BreakClass::Ideographic
+				|| (before == BreakClass::ClosePunctuation && after == BreakClass::OpenPunctuation);
+		}
+	
+		struct ShapingCacheKey
+		{
+			uint64 fontID;
+
+			float scale;
+
+			/// @brief エントリの文字列を参照する
+			StringView text;
+
+			bool operator==(const ShapingCacheKey&) const = default;
+		};
+
+		struct ShapingCacheKeyHash
+		{
+			size_t operator()(const ShapingCacheKey& key) const noexcept
+			{
+				size_t hash = std::hash<StringView>{}(key.text);
+				hash ^= std::hash<uint64>{}(key.fontID) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+				hash ^= std::hash<float>{}(key.scale) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		};
+
+		struct ShapingCacheEntry
+		{
+			uint64 fontID;
+
+			float scale;
+
+			String text;
+
+			std::shared_ptr<const ShapedText> shaped;
+		};
+
+		struct ShapingCacheStorage
+		{
+			std::mutex mutex;
+
+			/// @brief 最近使用した順 (先頭が最新)
+			/// @remark 要素の参照が無効にならないようにlistを使用します
+			std::list<ShapingCacheEntry> entries;
+
+			/// @brief entriesの要素を参照するキー
+			HashTable<ShapingCacheKey, std::list<ShapingCacheEntry>::iterator, ShapingCacheKeyHash> index;
+
+			size_t capacity = ShapingCache::DefaultCapacity;
+
+			ShapingCache::Stats stats;
+
+			void evict()
+			{
+				while (entries.size() > capacity)
+				{
+					const auto& last = entries.back();
+					index.erase(ShapingCacheKey{ last.fontID, last.scale, last.text });
+					entries.pop_back();
+					stats.evictions++;
+				}
+			}
+		};
+
+		static ShapingCacheStorage& GetShapingCacheStorage()
+		{
+			static ShapingCacheStorage storage;
+			return storage;
+		}
+	}
+
+	ShapedText ShapedText::Shape(const Font& font, float scale, StringView text)
+	{
+		ShapedText result;
+		if (text.isEmpty())
+		{
+			return result;
+		}
+
+		// 並列のレイアウト計算中はフォントへのアクセスを直列化する (キャッシュのロックとは独立)
+		// ロックはフォントから送り幅を取得する間のみ保持し、改行位置の解析はロックの外で行う
+		Array<GlyphCluster> clusters;
+		Array<float> xadvances;
+		{
+			const auto fontLock = LockFontAccess();
+
+			// テクスチャを含むGlyphは保持せず、グリフ番号と送り幅のみを保持する
+			clusters = font.getGlyphClusters(text, true, Ligature::Yes);
+			xadvances.reserve(clusters.size());
+			for (const auto& cluster : clusters)
+			{
+				xadvances.push_back(IsControl(text[cluster.pos])
+					? 0.0f
+					: static_cast<float>(font.getGlyphInfoByGlyphIndex(cluster.glyphIndex, cluster.fontIndex).xAdvance * scale));
+			}
+		}
+
+		result.glyphs.reserve(clusters.size());
+		result.glyphOffsets.reserve(clusters.size() + 1);
+		result.glyphOffsets.push_back(0.0f);
+
+		// 改行位置の候補は前後の文字の種類から決定する
+		detail::BreakClass prevClass = detail::BreakClass::Newline;
+
+		// 末尾の空白を除いた行末
+		uint32 contentEnd = 0;
+
+		for (const auto& cluster : clusters)
+		{
+			const char32 codePoint = text[cluster.pos];
+
+			const uint32 i = static_cast<uint32>(result.glyphs.size());
+			result.glyphs.push_back({
+				.glyphIndex = cluster.glyphIndex,
+				.fontIndex = static_cast<int16>(cluster.fontIndex),
+				.isControl = IsControl(codePoint),
+			});
+			result.glyphOffsets.push_back(result.glyphOffsets.back() + xadvances[i]);
+
+			const auto breakClass = detail::GetBreakClass(codePoint);
+
+			if (i > 0 && detail::IsBreakAllowed(prevClass, breakClass))
+			{
+				result.breakOpportunities.push_back({ .index = i, .contentEnd = contentEnd, .mandatory = false });
+			}
+
+			if (breakClass == detail::BreakClass::Newline)
+			{
+				result.breakOpportunities.push_back({ .index = i + 1, .contentEnd = contentEnd, .mandatory = true });
+				contentEnd = i + 1;
+			}
+			else if (breakClass != detail::BreakClass::Space)
+			{
+				contentEnd = i + 1;
+			}
+
+			prevClass = breakClass;
+		}
+
+		result.breakOpportunities.push_back({ .index = static_cast<uint32>(result.glyphs.size()), .contentEnd = contentEnd, .mandatory = true });
+
+		result.glyphs.shrink_to_fit();
+		result.breakOpportunities.shrink_to_fit();
+		return result;
+	}
+
+	std::shared_ptr<const ShapedText> ShapingCache::Get(const Font& font, float scale, StringView text)
+	{
+		if (text.isEmpty())
+		{
+			return nullptr;
+		}
+
+		auto& storage = detail::GetShapingCacheStorage();
+		const uint64 fontID = font.id().value();
+
+		{
+			std::lock_guard lock{ storage.mutex };
+
+			if (auto itr = storage.index.find(detail::ShapingCacheKey{ fontID, scale, text }); itr != storage.index.end())
+			{
+				storage.entries.splice(storage.entries.begin(), storage.entries, itr->second);
+				storage.stats.hits++;
+				return itr->second->shaped;
+			}
+
+			storage.stats.misses++;
+		}
+
+		// シェーピングはロックの外で行う
+		auto shaped = std::make_shared<const ShapedText>(ShapedText::Shape(font, scale, text));
+
+		std::lock_guard lock{ storage.mutex };
+
+		// 他のスレッドが先に登録した場合はそちらを共有する
+		if (auto itr = storage.index.find(detail::ShapingCacheKey{ fontID, scale, text }); itr != storage.index.end())
+		{
+			return itr->second->shaped;
+		}
+
+		if (storage.capacity == 0)
+		{
+			return shaped;
+		}
+
+		storage.entries.push_front({ fontID, scale, String{ text }, shaped });
+		const auto& entry = storage.entries.front();
+		storage.index.emplace(detail::ShapingCacheKey{ entry.fontID, entry.scale, entry.text }, storage.entries.begin());
+		storage.evict();
+
+		return shaped;
+	}
+
+	void ShapingCache::SetCapacity(size_t capacity)
+	{
+		auto& storage = detail::GetShapingCacheStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		storage.capacity = capacity;
+		storage.evict();
+	}
+
+	void ShapingCache::Clear()
+	{
+		auto& storage = detail::GetShapingCacheStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		storage.index.clear();
+		storage.entries.clear();
+	}
+
+	ShapingCache::Stats ShapingCache::GetStats()
+	{
+		auto& storage = detail::GetShapingCacheStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		auto stats = storage.stats;
+		stats.entries = storage.entries.size();
+		stats.capacity = storage.capacity;
+		return stats;
+	}
+
+	void ShapingCache::ResetStats()
+	{
+		auto& storage = detail::GetShapingCacheStorage();
+		std::lock_guard lock{ storage.mutex };
+
+		storage.stats = {};
+	}
+}
@@ -0,0 +1,97 @@
+﻿#pragma once
+#include <memory>
+#include <Siv3D/Array.hpp>
+#include <Siv3D/Font.hpp>
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	/// @brief シェーピング後のグリフの情報
+	/// @remark テクスチャは保持せず、描画時にフォントのキャッシュから取得します
+	struct ShapedGlyph
+	{
+		GlyphIndex glyphIndex;
+
+		/// @brief フォールバックフォントの番号 (0は主フォント)
+		int16 fontIndex;
+
+		/// @brief 制御文字の場合はtrue (描画しない)
+		bool isControl;
+	};
+
+	/// @brief 改行可能な位置
+	struct BreakOpportunity
+	{
+		/// @brief 改行した場合に次の行の先頭となるグリフの番号
+		uint32 index;
+
+		/// @brief 改行した場合の行末 (末尾の空白を除く) のグリフの番号
+		uint32 contentEnd;
+
+		/// @brief 改行文字またはテキストの末尾の場合はtrue
+		bool mandatory;
+	};
+
+	/// @brief テキストのシェーピング結果
+	/// @remark 幅に依存しないため、同じフォント・描画スケール・文字列のテキストノードで共有されます
+	struct ShapedText
+	{
+		Array<ShapedGlyph> glyphs;
+
+		/// @brief 先頭からi番目のグリフまでの送り幅の合計 (要素数はグリフ数+1)
+		Array<float> glyphOffsets;
+
+		/// @brief 改行可能な位置 (末尾は常にテキストの末尾)
+		Array<BreakOpportunity> breakOpportunities;
+
+		/// @brief テキストをシェーピングする
+		static ShapedText Shape(const Font& font, float scale, StringView text);
+
+		/// @brief 確保しているメモリの量 (バイト)
+		size_t allocatedBytes() const
+		{
+			return glyphs.capacity() * sizeof(ShapedGlyph)
+				+ glyphOffsets.capacity() * sizeof(float)
+				+ breakOpportunities.capacity() * sizeof(BreakOpportunity);
+		}
+	};
+
+	/// @brief プロセス全体で共有するシェーピング結果のLRUキャッシュ
+	/// @remark スレッドセーフです。キャッシュから追い出された結果も、参照しているテキストノードがある間は解放されません
+	struct ShapingCache
+	{
+		struct Stats
+		{
+			size_t hits = 0;
+
+			size_t misses = 0;
+
+			/// @brief 容量を超えたため追い出した数
+			size_t evictions = 0;
+
+			/// @brief 保持している結果の数
+			size_t entries = 0;
+
+			size_t capacity = 0;
+		};
+
+		static constexpr size_t DefaultCapacity = 4096;
+
+		/// @brief シェーピング結果を取得する
+		/// @remark キャッシュにない場合はシェーピングして登録します
+		/// @return 空文字列の場合はnullptr
+		static std::shared_ptr<const ShapedText> Get(const Font& font, float scale, StringView text);
+
+		/// @brief 保持する結果の最大数を設定する
+		static void SetCapacity(size_t capacity);
+
+		/// @brief 保持しているすべての結果を破棄する
+		static void Clear();
+
+		static Stats GetStats();
+
+		/// @brief ヒット数・ミス数・追い出し数を0に戻す
+		static void ResetStats();
+	};
+}
@@ -1,13 +1,37 @@
 ﻿#pragma once
 #include <Siv3D/Font.hpp>
 #include "../../Enum/TextAlign.hpp"
+#include "../../Enum/TextOverflow.hpp"
+#include "../../Enum/WhiteSpace.hpp"
+#include "../FontAccess.hpp"
 
 using namespace s3d;
 
 namespace FlexLayout::Internal
 {
+	/// @brief フォントのメトリクス (フォントの描画スケールを掛ける前の値)
+	/// @remark Siv3Dのフォントへのアクセスにはロックが必要なため、フォントの設定時に一度だけ取得します
+	struct FontMetrics
+	{
+		int32 fontSize = 0;
+
+		double ascender = 0.0;
+
+		double height = 0.0;
+
+		/// @brief '0'の送り幅 (ch単位)
+		double zeroAdvance = 0.0;
+
+		/// @brief 'x'の高さ (ex単位)
+		double xHeight = 0.0;
+
+		/// @brief '水'の送り幅 (ic単位)
+		double cjkWaterAdvance = 0.0;
+	};
+
 	struct ComputedTextStyle
 	{
+		/// @remark 変更する場合は`setFont()`を使用してください
 		Font font;
 
 		float fontSizePx;
@@ -16,24 +40,74 @@ namespace FlexLayout::Internal
 
 		TextAlign textAlign;
 
+		WhiteSpace whiteSpace;
+
+		/// @remark 継承されないプロパティです
+		TextOverflow textOverflow;
+
+		/// @brief 表示する最大の行数 (0は無制限)
+		/// @remark 継承されないプロパティです
+		uint32 maxLines;
+
+		/// @brief `font`のメトリクス
+		FontMetrics fontMetrics{};
+
+		/// @brief フォントを変更し、メトリクスを取得する
+		void setFont(const Font& newFont)
+		{
+			if (font == newFont)
+			{
+				return;
+			}
+
+			font = newFont;
+			updateFontMetrics();
+		}
+
+		/// @brief `font`からメトリクスを取得する
+		void updateFontMetrics()
+		{
+			const auto lock = LockFontAccess();
+			fontMetrics = {
+				.fontSize = font.fontSize(),
+				.ascender = static_cast<double>(font.ascender()),
+				.height = static_cast<double>(font.height()),
+				.zeroAdvance = font.getGlyphInfo(U'0').xAdvance,
+				.xHeight = static_cast<double>(font.getGlyphInfo(U'x').height),
+				.cjkWaterAdvance = font.getGlyphInfo(U'水').xAdvance,
+			};
+		}
+
 		float fontRenderingScale() const
 		{
-			return font ? fontSizePx / font.fontSize() : 1.0F;
+			return font && fontMetrics.fontSize ? fontSizePx / fontMetrics.fontSize : 1.0F;
 		}
 
 		float zeroGlyphAdvancePx() const
 		{
-			return static_cast<float>(font.getGlyphInfo(U'0').xAdvance * fontRenderingScale());
+			return static_cast<float>(fontMetrics.zeroAdvance * fontRenderingScale());
 		}
 
 		float xGlyphHeightPx() const
 		{
-			return font.getGlyphInfo(U'x').height * fontRenderingScale();
+			return static_cast<float>(fontMetrics.xHeight * fontRenderingScale());
 		}
 
 		float cjkWaterGlyphAdvancePx() const
 		{
-			return static_cast<float>(font.getGlyphInfo(U'水').xAdvance * fontRenderingScale());
+			return static_cast<float>(fontMetrics.cjkWaterAdvance * fontRenderingScale());
+		}
+
+		/// @brief 先頭行の上端からベースラインまでの距離
+		double ascenderPx() const
+		{
+			return fontMetrics.ascender * fontRenderingScale();
+		}
+
+		/// @brief フォントの高さ (ピクセル)
+		double fontHeightPx() const
+		{
+			return fontMetrics.height * fontRenderingScale();
 		}
 
 		float lineHeightPx() const
@@ -48,7 +122,10 @@ namespace FlexLayout::Internal
 		return lhs.font == rhs.font &&
 			lhs.fontSizePx == rhs.fontSizePx &&
 			lhs.lineHeightMul == rhs.lineHeightMul &&
-			lhs.textAlign == rhs.textAlign;
+			lhs.textAlign == rhs.textAlign &&
+			lhs.whiteSpace == rhs.whiteSpace &&
+			lhs.textOverflow == rhs.textOverflow &&
+			lhs.maxLines == rhs.maxLines;
 	}
 
 	[[nodiscard]]
@@ -4,7 +4,7 @@ namespace FlexLayout::Internal
 {
 	StylePropertyTable::value_type* StylePropertyTable::get(StylePropertyGroup group, StringView key, size_t hash, bool moveToBack)
 	{
-		auto& container = m_table[static_cast<uint8>(group)];
+		auto& container = mutableTable()[static_cast<uint8>(group)];
 
 		auto itr = std::find_if(
 			container.begin(),
@@ -40,7 +40,7 @@ namespace FlexLayout::Internal
 
 	const StylePropertyTable::value_type* StylePropertyTable::find(StylePropertyGroup group, size_t hash) const
 	{
-		auto& container = m_table[static_cast<uint8>(group)];
+		auto& container = table()[static_cast<uint8>(group)];
 
 		auto itr = std::find_if(
 			container.cbegin(),
@@ -56,12 +56,27 @@ namespace FlexLayout::Internal
 	StylePropertyTable::value_type* StylePropertyTable::find(StylePropertyGroup group, size_t hash)
 	{
 		const auto& self = *this;
+		if (not self.find(group, hash))
+		{
+			// 見つからない場合は共有を解除しない
+			return nullptr;
+		}
+
+		mutableTable();
 		return const_cast<value_type*>(self.find(group, hash));
 	}
 
 	StylePropertyTable::value_type* StylePropertyTable::find(size_t hash)
 	{
-		for (auto containerItr = m_table.rbegin(); containerItr != m_table.rend(); containerItr++)
+		const auto& self = *this;
+		if (not self.find(hash))
+		{
+			// 見つからない場合は共有を解除しない
+			return nullptr;
+		}
+
+		auto& table = mutableTable();
+		for (auto containerItr = table.rbegin(); containerItr != table.rend(); containerItr++)
 		{
 			auto itr = std::find_if(
 				containerItr->begin(),
@@ -80,7 +95,8 @@ namespace FlexLayout::Internal
 
 	const StylePropertyTable::value_type* StylePropertyTable::find(size_t hash) const
 	{
-		for (auto containerItr = m_table.rbegin(); containerItr != m_table.rend(); containerItr++)
+		const auto& table = this->table();
+		for (auto containerItr = table.rbegin(); containerItr != table.rend(); containerItr++)
 		{
 			auto itr = std::find_if(
 				containerItr->cbegin(),
@@ -96,4 +112,70 @@ namespace FlexLayout::Internal
 
 		return nullptr;
 	}
+
+	bool StylePropertyTable::empty() const
+	{
+		return std::all_of(
+			cbegin(),
+			cend(),
+			[](const group_container_type& container) { return container.empty(); }
+		);
+	}
+
+	void StylePropertyTable::clearEvents()
+	{
+		const auto hasEvent = std::any_of(
+			cbegin(),
+			cend(),
+			[](const group_container_type& container)
+			{
+				return container.any([](const StyleProperty& prop) { return prop.event() != StyleProperty::Event::None; });
+			}
+		);
+
+		if (not hasEvent)
+		{
+			return;
+		}
+
+		for (auto& container : mutableTable())
+		{
+			for (auto& prop : container)
+			{
+				prop.clearEvent();
+			}
+		}
+	}
+
+	const StylePropertyTable::container_type& StylePropertyTable::table() const noexcept
+	{
+		static const container_type emptyTable{ };
+		return m_table ? *m_table : emptyTable;
+	}
+
+	StylePropertyTable::container_type& StylePropertyTable::mutableTable()
+	{
+		if (not m_table)
+		{
+			m_table = std::make_shared<container_type>();
+		}
+		else if (m_table.use_count() > 1)
+		{
+			auto table = std::make_shared<container_type>();
+			for (size_t groupId = 0; groupId < m_table->size(); groupId++)
+			{
+				const auto& source = (*m_table)[groupId];
+				auto& destination = (*table)[groupId];
+
+				destination.reserve(source.size());
+				for (const auto& prop : source)
+				{
+					destination.push_back(prop.clone());
+				}
+			}
+			m_table = std::move(table);
+		}
+
+		return *m_table;
+	}
 }
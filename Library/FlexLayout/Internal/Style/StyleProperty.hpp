@@ -21,8 +21,6 @@ namespace FlexLayout::Internal
 
 		StyleProperty& operator =(StyleProperty&&) = default;
 
-		StyleProperty(const StyleProperty&) = delete;
-
 		StyleProperty& operator =(const StyleProperty&) = delete;
 
 		inline size_t keyHash() const { return m_keyHash; }
@@ -37,13 +35,14 @@ namespace FlexLayout::Internal
 
 		inline const Array<Style::StyleValue>& value() const { return m_value; }
 
-		inline void setValue(Array<Style::StyleValue>&& newValue)
+		/// @return 値が変更された場合はtrue
+		inline bool setValue(Array<Style::StyleValue>&& newValue)
 		{
 			assert(newValue);
 
 			if (m_value == newValue)
 			{
-				return;
+				return false;
 			}
 
 			switch (m_event)
@@ -55,6 +54,8 @@ namespace FlexLayout::Internal
 			}
 
 			m_value = std::move(newValue);
+
+			return true;
 		}
 
 		inline void unsetValue()
@@ -92,6 +93,11 @@ namespace FlexLayout::Internal
 
 	private:
 
+		StyleProperty(const StyleProperty&) = default;
+
+		/// @brief 複製を作成する (StylePropertyTableのコピーオンライト用)
+		StyleProperty clone() const { return StyleProperty{ *this }; }
+
 		size_t m_keyHash;
 
 		StylePropertyDefinitionRef m_definition;
@@ -110,6 +116,9 @@ namespace FlexLayout::Internal
 		Inline
 	};
 
+	/// @brief スタイルのテーブル
+	/// @remark コピーはテーブルを共有し、いずれかのコピーで変更が行われる直前に複製されます (コピーオンライト)。
+	/// 非constのメンバ関数は共有を解除するため、読み取りのみの場合はconstの関数を使用してください
 	class StylePropertyTable
 	{
 	public:
@@ -128,13 +137,13 @@ namespace FlexLayout::Internal
 		{
 			// 配列の内容の編集は許可するが、配列そのものの操作は許可したくない
 
-			auto& ary = m_table[static_cast<uint8>(group)];
+			auto& ary = mutableTable()[static_cast<uint8>(group)];
 			return std::span{ ary.begin(), ary.end() };
 		}
 
 		inline const group_container_type& group(StylePropertyGroup group) const
 		{
-			return m_table[static_cast<uint8>(group)];
+			return table()[static_cast<uint8>(group)];
 		}
 
 		value_type* get(StylePropertyGroup group, StringView key, size_t hash, bool moveToBack = false);
@@ -145,6 +154,28 @@ namespace FlexLayout::Internal
 			return get(group, key, StyleProperty::Hash(key), moveToBack);
 		}
 
+		/// @brief グループ内で最後に設定されたプロパティかを判定する
+		template<class Key>
+		inline bool isLatest(StylePropertyGroup group, const Key& key) const
+		{
+			const auto& container = table()[static_cast<uint8>(group)];
+			return not container.empty() && container.back().keyHash() == StyleProperty::Hash(key);
+		}
+
+		/// @brief プロパティが1つも登録されていないか (削除済みのプロパティも含む)
+		bool empty() const;
+
+		/// @brief 他のテーブルと内容を共有しているか
+		bool isShared() const { return m_table.use_count() > 1; }
+
+		/// @brief 共有しているテーブルを識別する値
+		/// @return 空のテーブルの場合はnullptr
+		const void* identity() const noexcept { return m_table.get(); }
+
+		/// @brief すべてのプロパティのイベントをクリアする
+		/// @remark イベントが発生していない場合は共有を解除しません
+		void clearEvents();
+
 		const value_type* find(StylePropertyGroup group, size_t hash) const;
 
 		template<class Key>
@@ -177,34 +208,40 @@ namespace FlexLayout::Internal
 			return find(StyleProperty::Hash(key));
 		}
 
-		constexpr size_t size() const noexcept { return m_table.size(); }
+		constexpr size_t size() const noexcept { return std::tuple_size_v<container_type>; }
 
-		constexpr container_type::iterator begin() noexcept { return m_table.begin(); }
+		container_type::iterator begin() { return mutableTable().begin(); }
 
-		constexpr container_type::const_iterator begin() const noexcept { return m_table.cbegin(); }
+		container_type::const_iterator begin() const noexcept { return table().cbegin(); }
 		
-		constexpr container_type::iterator end() noexcept { return m_table.end(); }
+		container_type::iterator end() { return mutableTable().end(); }
 
-		constexpr container_type::const_iterator end() const noexcept { return m_table.cend(); }
+		container_type::const_iterator end() const noexcept { return table().cend(); }
 
-		constexpr container_type::reverse_iterator rbegin() noexcept { return m_table.rbegin(); }
+		container_type::reverse_iterator rbegin() { return mutableTable().rbegin(); }
 
-		constexpr container_type::const_reverse_iterator rbegin() const noexcept { return m_table.crbegin(); }
+		container_type::const_reverse_iterator rbegin() const noexcept { return table().crbegin(); }
 
-		constexpr container_type::reverse_iterator rend() noexcept { return m_table.rend(); }
+		container_type::reverse_iterator rend() { return mutableTable().rend(); }
 
-		constexpr container_type::const_reverse_iterator rend() const noexcept { return m_table.crend(); }
+		container_type::const_reverse_iterator rend() const noexcept { return table().crend(); }
 
-		constexpr container_type::const_iterator cbegin() const noexcept { return m_table.cbegin(); }
+		container_type::const_iterator cbegin() const noexcept { return table().cbegin(); }
 
-		constexpr container_type::const_iterator cend() const noexcept { return m_table.cend(); }
+		container_type::const_iterator cend() const noexcept { return table().cend(); }
 
-		constexpr container_type::const_reverse_iterator crbegin() const noexcept { return m_table.crbegin(); }
+		container_type::const_reverse_iterator crbegin() const noexcept { return table().crbegin(); }
 
-		constexpr container_type::const_reverse_iterator crend() const noexcept { return m_table.crend(); }
+		container_type::const_reverse_iterator crend() const noexcept { return table().crend(); }
 
 	private:
 
-		container_type m_table;
+		/// @brief nullptrの場合は空のテーブルとして扱う
+		std::shared_ptr<container_type> m_table;
+
+		const container_type& table() const noexcept;
+
+		/// @brief 共有を解除して編集可能なテーブルを取得する
+		container_type& mutableTable();
 	};
 }
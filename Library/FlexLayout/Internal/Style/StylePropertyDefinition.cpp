@@ -692,6 +692,14 @@ namespace FlexLayout::Internal
 				.resetCallback = ResetCallback_YogaDefaultValue(YGNodeStyleGetJustifyContent, YGNodeStyleSetJustifyContent)
 			}
 		},
+		{
+			U"overflow",
+			StylePropertyDefinitionDetails{
+				.patterns = PatternSingle({ PatternEnum<Overflow>() }),
+				.installCallback = InstallCallback_YogaEnum<Overflow>(YGNodeStyleSetOverflow),
+				.resetCallback = ResetCallback_YogaDefaultValue(YGNodeStyleGetOverflow, YGNodeStyleSetOverflow)
+			}
+		},
 		{
 			U"direction",
 			StylePropertyDefinitionDetails{
@@ -934,6 +942,58 @@ namespace FlexLayout::Internal
 				.resetCallback = [](FlexBoxNode&) -> void { }
 			}
 		},
+		{
+			U"white-space",
+			StylePropertyDefinitionDetails{
+				.patterns = PatternSingle({ PatternEnum<WhiteSpace>() }),
+				.installCallback = [](FlexBoxNode& impl, std::span<const Style::StyleValue> input) -> bool
+				{
+					impl.getComponent<Component::StyleComponent>().computedTextStyle().whiteSpace = input[0].getEnumValueUnchecked<WhiteSpace>();
+
+					return true;
+				},
+				.resetCallback = [](FlexBoxNode&) -> void { }
+			}
+		},
+		{
+			U"text-overflow",
+			StylePropertyDefinitionDetails{
+				.patterns = PatternSingle({ PatternEnum<TextOverflow>() }),
+				.installCallback = [](FlexBoxNode& impl, std::span<const Style::StyleValue> input) -> bool
+				{
+					impl.getComponent<Component::StyleComponent>().computedTextStyle().textOverflow = input[0].getEnumValueUnchecked<TextOverflow>();
+
+					return true;
+				},
+				.resetCallback = [](FlexBoxNode&) -> void { }
+			}
+		},
+		{
+			U"max-lines",
+			StylePropertyDefinitionDetails{
+				.patterns = PatternSingle({ ValueType::Integer, ValueType::None }),
+				.installCallback = [](FlexBoxNode& impl, std::span<const Style::StyleValue> input) -> bool
+				{
+					auto& textStyle = impl.getComponent<Component::StyleComponent>().computedTextStyle();
+
+					if (input[0].type() == ValueType::None)
+					{
+						textStyle.maxLines = 0;
+						return true;
+					}
+
+					const auto value = input[0].getIntValueUnchecked();
+					if (value <= 0)
+					{
+						return false;
+					}
+
+					textStyle.maxLines = static_cast<uint32>(value);
+					return true;
+				},
+				.resetCallback = [](FlexBoxNode&) -> void { }
+			}
+		},
 		{
 			U"place-content",
 			StylePropertyDefinitionDetails{
@@ -1,11 +1,49 @@
 ﻿#include "TreeContext.hpp"
+#include <utility>
 #include "FlexBoxNode.hpp"
+#include "LayoutSnapshot.hpp"
+#include "NodeComponent/StyleComponent.hpp"
 
 namespace FlexLayout::Internal
 {
 	void TreeContext::onNewNodeJoin(const std::shared_ptr<FlexBoxNode>& node)
 	{
-		getContext<Context::StyleContext>()
-			.queueStyleApplication(node);
+		auto& styleContext = getContext<Context::StyleContext>();
+		styleContext.queueStyleApplication(node);
+
+		if (not node->getComponent<Component::StyleComponent>().pendingFontId().isEmpty())
+		{
+			styleContext.queuePendingFont(node);
+		}
+	}
+
+	void TreeContext::setLayoutPipelined(bool pipelined)
+	{
+		m_layoutPipelined = pipelined;
+
+		if (not pipelined)
+		{
+			m_committedSnapshot = nullptr;
+			m_committedSnapshotSlot = 0;
+		}
+	}
+
+	void TreeContext::waitForLayoutTask()
+	{
+		// 計算中のスレッドによる変更 (スタイルの適用など) は待たない
+		if (IsInLayoutPass() || not m_layoutTaskWaiter)
+		{
+			return;
+		}
+
+		const auto waiter = std::exchange(m_layoutTaskWaiter, nullptr);
+		waiter();
+	}
+
+	void TreeContext::setCommittedSnapshot(const LayoutSnapshotBuffer* snapshot, size_t slot)
+	{
+		assert(m_layoutPipelined);
+		m_committedSnapshot = snapshot;
+		m_committedSnapshotSlot = slot;
 	}
 }
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <tuple>
+#include <functional>
 #include <memory>
 #include "TreeContext/StyleContext.hpp"
 #include "TreeContext/UIContext.hpp"
@@ -7,6 +8,8 @@
 namespace FlexLayout::Internal
 {
 	class FlexBoxNode;
+	class NodeGraveyard;
+	struct LayoutSnapshotBuffer;
 
 	/// @brief FlexBoxNodeの同一ツリー内で共有されるデータ
 	class TreeContext
@@ -27,8 +30,51 @@ namespace FlexLayout::Internal
 
 		void onNewNodeJoin(const std::shared_ptr<FlexBoxNode>& node);
 
+		/// @brief 切り離されたノードの解放待ちリスト (設定されていない場合はnullptr)
+		NodeGraveyard* graveyard() const { return m_graveyard.get(); }
+
+		/// @brief 切り離されたノードを即座に解放せず、解放待ちリストへ追加するよう設定する
+		void setGraveyard(std::shared_ptr<NodeGraveyard> graveyard) { m_graveyard = std::move(graveyard); }
+
+		/// @brief レイアウトの計算を描画と並行して行うか
+		/// @remark 有効な場合、レイアウト計算中のスレッド以外からは確定済みのスナップショットのみを参照します
+		bool isLayoutPipelined() const { return m_layoutPipelined; }
+
+		/// @brief レイアウトのパイプライン化を設定する
+		/// @remark 無効にすると確定済みのスナップショットも解除されます
+		void setLayoutPipelined(bool pipelined);
+
+		/// @brief 確定済みのスナップショット (最初の計算結果が確定するまではnullptr)
+		const LayoutSnapshotBuffer* committedSnapshot() const { return m_committedSnapshot; }
+
+		/// @brief 確定済みのスナップショットのダブルバッファの番号
+		size_t committedSnapshotSlot() const { return m_committedSnapshotSlot; }
+
+		void setCommittedSnapshot(const LayoutSnapshotBuffer* snapshot, size_t slot);
+
+		/// @brief ワーカースレッドでレイアウトを計算中か
+		bool isLayoutTaskInFlight() const { return static_cast<bool>(m_layoutTaskWaiter); }
+
+		/// @brief ワーカースレッドでの計算の完了を待つ処理を設定する
+		/// @param waiter 計算を開始した場合は完了を待って結果を確定する処理、完了した場合はnullptr
+		void setLayoutTaskWaiter(std::function<void()> waiter) { m_layoutTaskWaiter = std::move(waiter); }
+
+		/// @brief ツリーを変更する前に、ワーカースレッドでの計算の完了を待つ
+		/// @remark 計算中のスレッドから呼び出された場合は何もしません
+		void waitForLayoutTask();
+
 	private:
 
+		std::shared_ptr<NodeGraveyard> m_graveyard;
+
+		bool m_layoutPipelined = false;
+
+		const LayoutSnapshotBuffer* m_committedSnapshot = nullptr;
+
+		size_t m_committedSnapshotSlot = 0;
+
+		std::function<void()> m_layoutTaskWaiter;
+
 		std::tuple<
 			Context::StyleContext,
 			Context::UIContext
@@ -8,6 +8,8 @@ namespace FlexLayout::Internal::Context
 	{
 		auto& context = root.context();
 
+		resolvePendingFonts(root);
+
 		if (m_styleApplicationWaitinglist.empty())
 		{
 			return;
@@ -45,4 +47,26 @@ namespace FlexLayout::Internal::Context
 	{
 		m_styleApplicationWaitinglist.push_back(node);
 	}
+
+	void StyleContext::queuePendingFont(const std::shared_ptr<FlexBoxNode>& node)
+	{
+		m_pendingFontNodes.push_back(node);
+	}
+
+	void StyleContext::resolvePendingFonts(FlexBoxNode& root)
+	{
+		if (m_pendingFontNodes.empty())
+		{
+			return;
+		}
+
+		// 他のツリーへ移動したノードは、移動先のコンテキストに登録されている
+		m_pendingFontNodes.remove_if([&](const std::weak_ptr<FlexBoxNode>& weakptr)
+			{
+				const auto item = weakptr.lock();
+				return not item
+					|| not FlexBoxNode::BelongsToSameTree(root, *item)
+					|| item->getComponent<Component::StyleComponent>().resolvePendingFont();
+			});
+	}
 }
@@ -23,8 +23,20 @@ namespace FlexLayout::Internal::Context
 
 		void queueStyleApplication(const std::shared_ptr<FlexBoxNode>& node);
 
+		/// @brief フォントアセットの読み込みを待つノードを登録する
+		/// @remark 読み込みが完了したフォントは`applyStyles()`の呼び出し時に設定されます
+		void queuePendingFont(const std::shared_ptr<FlexBoxNode>& node);
+
+		size_t pendingFontCount() const { return m_pendingFontNodes.size(); }
+
 	private:
 
 		Array<std::weak_ptr<FlexBoxNode>> m_styleApplicationWaitinglist;
+
+		/// @brief フォントアセットの読み込みを待つノード
+		Array<std::weak_ptr<FlexBoxNode>> m_pendingFontNodes;
+
+		/// @brief 読み込みが完了したフォントを設定し、スタイルの適用を予約する
+		void resolvePendingFonts(FlexBoxNode& root);
 	};
 }
@@ -1,45 +1,193 @@
 ﻿#include "UIContext.hpp"
+#include <Siv3D/Mouse.hpp>
+#include <Siv3D/Graphics2D.hpp>
+#include <Siv3D/Quad.hpp>
+#include <Siv3D/ScopedRenderStates2D.hpp>
 
 #include "../FlexBoxNode.hpp"
+#include "../TreeTraversal.hpp"
 #include "../../Box.hpp"
+#include "../NodeComponent/LayoutComponent.hpp"
+#include "../NodeComponent/StyleComponent.hpp"
 #include "../NodeComponent/UIComponent.hpp"
 #include "../NodeComponent/TextComponent.hpp"
 
 namespace FlexLayout::Internal::Context
 {
-	void UIContext::update(FlexBoxNode& node)
+	namespace detail
 	{
-		for (auto itr = node.children().rbegin();
-			itr != node.children().rend();
-			itr++)
+		static RectF Intersect(const RectF& a, const RectF& b)
 		{
-			update(**itr);
+			const Vec2 tl{ Max(a.x, b.x), Max(a.y, b.y) };
+			const Vec2 br{ Min(a.rightX(), b.rightX()), Min(a.bottomY(), b.bottomY()) };
+			return RectF{ tl, Max(br.x - tl.x, 0.0), Max(br.y - tl.y, 0.0) };
 		}
 
-		if (node.isUINode())
+		/// @brief ローカル座標の矩形から、レンダーターゲットの座標で指定するシザー矩形を計算する
+		/// @param outer 外側のノードで設定済みのシザー矩形
+		static Rect ToScissorRect(const RectF& rect, const Optional<Rect>& outer)
 		{
-			node.getComponent<Component::UIComponent>()
-				.update();
+			// ユーザーのTransformer2Dやカメラによる変換を適用する (回転している場合は外接矩形)
+			const Mat3x2 transform = Graphics2D::GetLocalTransform() * Graphics2D::GetCameraTransform();
+			RectF screenRect = transform.transformRect(rect).boundingRect();
+
+			// 子要素の座標系が異なる場合もあるため、外側のシザー矩形との共通部分はレンダーターゲットの座標で求める
+			if (outer)
+			{
+				screenRect = Intersect(screenRect, RectF{ *outer });
+			}
+
+			const Point tl{ static_cast<int32>(Math::Floor(screenRect.x)), static_cast<int32>(Math::Floor(screenRect.y)) };
+			const Point br{ static_cast<int32>(Math::Ceil(screenRect.rightX())), static_cast<int32>(Math::Ceil(screenRect.bottomY())) };
+			return Rect{ tl, (br - tl) };
 		}
 	}
 
+	void UIContext::update(FlexBoxNode& node)
+	{
+		m_wheelConsumed = false;
+
+		// 子要素を後ろから先に処理するため、内側のスクロールコンテナや手前に描画される要素が優先される
+		TraverseDepthFirst(
+			node,
+			[](FlexBoxNode&) {},
+			[&](FlexBoxNode& item)
+			{
+				if (not m_wheelConsumed)
+				{
+					m_wheelConsumed = handleWheelScroll(item);
+				}
+
+				if (item.isUINode())
+				{
+					item.getComponent<Component::UIComponent>()
+						.update();
+				}
+			},
+			TraversalOrder::Reverse
+		);
+	}
+
 	void UIContext::draw(FlexBoxNode& node)
 	{
-		if (node.isTextNode())
+		// 走査中のノードごとの状態
+		struct _Frame
 		{
-			auto& component = node.getComponent<Component::TextComponent>();
-			component.draw(TextStyle::Default(), Palette::White);
+			/// @brief 子要素に適用するクリップ領域
+			Optional<RectF> childClipRect;
+
+			/// @brief 子要素の描画後に戻すシザー矩形
+			Optional<Rect> prevScissorRect;
+		};
+
+		Array<_Frame> frames;
+
+		// シザー矩形を設定しているノードの数 (描画ステートは最も外側のノードでのみ切り替える)
+		size_t scissorDepth = 0;
+		Optional<ScopedRenderStates2D> renderStates;
+
+		TraverseDepthFirst(
+			node,
+			[&](FlexBoxNode& item)
+			{
+				auto& layout = item.getComponent<Component::LayoutComponent>();
+
+				const Optional<RectF> clipRect = frames.isEmpty()
+					? none
+					: frames.back().childClipRect;
+
+				// クリップ領域と重ならないノードは子要素を含めて描画しない
+				if (clipRect)
+				{
+					const auto rect = layout.borderAreaRect();
+					if (not rect || not rect->intersects(*clipRect))
+					{
+						frames.push_back({});
+						return TraversalAction::SkipChildren;
+					}
+				}
+
+				if (item.isTextNode())
+				{
+					auto& component = item.getComponent<Component::TextComponent>();
+					component.draw(TextStyle::Default(), Palette::White);
+				}
+
+				if (item.isUINode())
+				{
+					item.getComponent<Component::UIComponent>()
+						.draw();
+				}
+
+				// 子要素の座標系がこのノードと異なる場合、クリップ領域による判定は行わない
+				_Frame frame{ .childClipRect = layout.propergateOffset() ? clipRect : none };
+
+				const auto paddingRect = layout.paddingAreaRect();
+				if (item.children() && layout.clipsContents() && paddingRect)
+				{
+					// パディング領域で子要素を切り抜く
+					const RectF newClipRect = clipRect
+						? detail::Intersect(*clipRect, *paddingRect)
+						: *paddingRect;
+
+					frame.prevScissorRect = Graphics2D::GetScissorRect();
+					Graphics2D::SetScissorRect(detail::ToScissorRect(newClipRect, scissorDepth ? frame.prevScissorRect : none));
+					if (scissorDepth++ == 0)
+					{
+						renderStates.emplace(RasterizerState::SolidCullNoneScissor);
+					}
+
+					frame.childClipRect = layout.propergateOffset() ? MakeOptional(newClipRect) : none;
+				}
+
+				frames.push_back(frame);
+				return TraversalAction::Continue;
+			},
+			[&](FlexBoxNode&)
+			{
+				const auto frame = frames.back();
+				frames.pop_back();
+
+				if (frame.prevScissorRect)
+				{
+					if (--scissorDepth == 0)
+					{
+						renderStates.reset();
+					}
+					Graphics2D::SetScissorRect(*frame.prevScissorRect);
+				}
+			}
+		);
+	}
+
+	bool UIContext::handleWheelScroll(FlexBoxNode& node)
+	{
+		auto& layout = node.getComponent<Component::LayoutComponent>();
+
+		if (not layout.isScrollContainer())
+		{
+			return false;
 		}
 
-		if (node.isUINode())
+		const auto rect = layout.paddingAreaRect();
+		if (not rect || not rect->mouseOver())
 		{
-			node.getComponent<Component::UIComponent>()
-				.draw();
+			return false;
 		}
 
-		for (const auto& child : node.children())
+		const Vec2 wheel{ Mouse::WheelH(), Mouse::Wheel() };
+		if (wheel.isZero())
 		{
-			draw(*child);
+			return false;
 		}
+
+		// 1ノッチあたり3行分スクロールする
+		const double step = node.getComponent<Component::StyleComponent>()
+			.computedTextStyle().lineHeightPx() * 3.0;
+
+		const Vec2 prevOffset = layout.scrollOffset();
+		layout.setScrollOffset(prevOffset + wheel * step);
+
+		return layout.scrollOffset() != prevOffset;
 	}
 }
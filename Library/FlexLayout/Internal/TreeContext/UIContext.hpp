@@ -1,4 +1,8 @@
 ﻿#pragma once
+#include <Siv3D/Optional.hpp>
+#include <Siv3D/RectF.hpp>
+
+using namespace s3d;
 
 namespace FlexLayout::Internal
 {
@@ -13,6 +17,15 @@ namespace FlexLayout::Internal::Context
 
 		void update(FlexBoxNode& node);
 
+		/// @brief ツリーを描画する
+		/// @remark overflowがvisible以外のノードはシザー矩形で子要素を切り抜き、クリップ領域外の子要素を描画しません
 		void draw(FlexBoxNode& node);
+
+	private:
+
+		/// @brief 現在の更新処理でマウスホイールの入力が消費されたか
+		bool m_wheelConsumed = false;
+
+		bool handleWheelScroll(FlexBoxNode& node);
 	};
 }
@@ -0,0 +1,162 @@
+﻿#pragma once
+#include <type_traits>
+#include <Siv3D/Array.hpp>
+#include "FlexBoxNode.hpp"
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	/// @brief ツリー走査の継続方法
+	enum class TraversalAction : uint8
+	{
+		/// @brief 子要素の走査を続ける
+		Continue,
+
+		/// @brief このノードの子要素を走査しない
+		SkipChildren,
+
+		/// @brief 走査を終了する
+		Stop
+	};
+
+	/// @brief 子要素を走査する順序
+	enum class TraversalOrder : uint8
+	{
+		Forward,
+		Reverse
+	};
+
+	namespace detail
+	{
+		template <class Visitor, class NodeType>
+		TraversalAction InvokeTraversalVisitor(Visitor& visitor, NodeType& node)
+		{
+			if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, NodeType&>>)
+			{
+				visitor(node);
+				return TraversalAction::Continue;
+			}
+			else
+			{
+				return visitor(node);
+			}
+		}
+	}
+
+	/// @brief サブツリーを行きがけ順に走査する
+	/// @remark 再帰呼び出しを使用しないため、深いツリーでもスタックを消費しません
+	/// @param root 走査を開始するノード (走査対象に含まれます)
+	/// @param visitor `void(NodeType&)`または`TraversalAction(NodeType&)`
+	/// @return `TraversalAction::Stop`で終了した場合はfalse
+	template <class NodeType, class Visitor>
+	bool TraversePreOrder(NodeType& root, Visitor&& visitor, TraversalOrder order = TraversalOrder::Forward)
+	{
+		static_assert(std::is_same_v<std::remove_const_t<NodeType>, FlexBoxNode>);
+
+		Array<NodeType*> stack;
+		stack.push_back(&root);
+
+		while (not stack.empty())
+		{
+			NodeType& node = *stack.back();
+			stack.pop_back();
+
+			switch (detail::InvokeTraversalVisitor(visitor, node))
+			{
+			case TraversalAction::Continue: break;
+			case TraversalAction::SkipChildren: continue;
+			case TraversalAction::Stop: return false;
+			}
+
+			// スタックから取り出す順序が逆になるため、逆順に積む
+			const auto& children = node.children();
+			if (order == TraversalOrder::Forward)
+			{
+				for (auto itr = children.rbegin(); itr != children.rend(); itr++)
+				{
+					stack.push_back(itr->get());
+				}
+			}
+			else
+			{
+				for (const auto& child : children)
+				{
+					stack.push_back(child.get());
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/// @brief サブツリーを深さ優先で走査し、子要素の前後で処理を行う
+	/// @remark 再帰呼び出しを使用しないため、深いツリーでもスタックを消費しません。
+	/// `leave`の呼び出し時点で子要素が変更されていても安全に走査を続けます
+	/// @param enter 子要素より先に呼び出される処理 (`void(NodeType&)`または`TraversalAction(NodeType&)`)
+	/// @param leave 子要素の後に呼び出される処理 (`void(NodeType&)`)、`enter`が`Stop`を返したノードでは呼び出されません
+	/// @return `TraversalAction::Stop`で終了した場合はfalse
+	template <class NodeType, class Enter, class Leave>
+	bool TraverseDepthFirst(NodeType& root, Enter&& enter, Leave&& leave, TraversalOrder order = TraversalOrder::Forward)
+	{
+		static_assert(std::is_same_v<std::remove_const_t<NodeType>, FlexBoxNode>);
+
+		struct Frame
+		{
+			NodeType* node;
+
+			/// @brief 走査済みの子要素の数
+			size_t visited;
+		};
+
+		Array<Frame> stack;
+
+		const auto enterNode = [&](NodeType& node) -> bool
+			{
+				switch (detail::InvokeTraversalVisitor(enter, node))
+				{
+				case TraversalAction::Continue:
+					stack.push_back({ &node, 0 });
+					return true;
+				case TraversalAction::SkipChildren:
+					leave(node);
+					return true;
+				case TraversalAction::Stop:
+				default:
+					return false;
+				}
+			};
+
+		if (not enterNode(root))
+		{
+			return false;
+		}
+
+		while (not stack.empty())
+		{
+			auto& frame = stack.back();
+			const auto& children = frame.node->children();
+
+			if (frame.visited >= children.size())
+			{
+				NodeType& node = *frame.node;
+				stack.pop_back();
+				leave(node);
+				continue;
+			}
+
+			const size_t index = order == TraversalOrder::Forward
+				? frame.visited
+				: children.size() - 1 - frame.visited;
+			frame.visited++;
+
+			// enterNodeでstackが再確保されるため、以降frameは使用しない
+			if (not enterNode(*children[index]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
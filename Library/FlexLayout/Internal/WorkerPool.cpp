@@ -0,0 +1,161 @@
+﻿#include "WorkerPool.hpp"
+#include <utility>
+
+namespace FlexLayout::Internal
+{
+	WorkerPool::WorkerPool(size_t threadCount)
+	{
+		m_threads.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back([this] { workerMain(); });
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard lock{ m_mutex };
+			m_stopping = true;
+		}
+		m_wakeCondition.notify_all();
+
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// 実行中の処理が、この呼び出しの完了を待っている場合がある
+		// (例: CalculateLayoutParallelの処理が、並列計算中のパイプライン化したレイアウトの完了を待つ)
+		// 待つとデッドロックするため、ワーカーが使用中の場合は呼び出し元のスレッドで実行する
+		std::unique_lock dispatchLock{ m_dispatchMutex, std::try_to_lock };
+		if (not dispatchLock.owns_lock())
+		{
+			RunInline(job, count);
+			return;
+		}
+
+		{
+			std::lock_guard lock{ m_mutex };
+			m_job = &job;
+			m_count = count;
+			m_exception = nullptr;
+			m_nextIndex.store(0, std::memory_order_relaxed);
+			m_generation++;
+		}
+		m_wakeCondition.notify_all();
+
+		runJobs(job, count);
+
+		std::exception_ptr exception;
+		{
+			// 遅れて参加したワーカーが古い処理を参照しないよう、全員の離脱を待ってから片付ける
+			std::unique_lock lock{ m_mutex };
+			m_doneCondition.wait(lock, [this] { return m_activeWorkers == 0; });
+			m_job = nullptr;
+			m_count = 0;
+			exception = std::exchange(m_exception, nullptr);
+		}
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void WorkerPool::workerMain()
+	{
+		uint64 seenGeneration = 0;
+
+		while (true)
+		{
+			const std::function<void(size_t)>* job;
+			size_t count;
+			{
+				std::unique_lock lock{ m_mutex };
+				m_wakeCondition.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+
+				if (m_stopping)
+				{
+					return;
+				}
+
+				seenGeneration = m_generation;
+				job = m_job;
+				count = m_count;
+
+				if (not job)
+				{
+					continue;
+				}
+
+				m_activeWorkers++;
+			}
+
+			runJobs(*job, count);
+
+			{
+				std::lock_guard lock{ m_mutex };
+				m_activeWorkers--;
+			}
+			m_doneCondition.notify_all();
+		}
+	}
+
+	void WorkerPool::RunInline(const std::function<void(size_t)>& job, size_t count)
+	{
+		std::exception_ptr exception;
+		for (size_t i = 0; i < count; i++)
+		{
+			try
+			{
+				job(i);
+			}
+			catch (...)
+			{
+				if (not exception)
+				{
+					exception = std::current_exception();
+				}
+			}
+		}
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void WorkerPool::runJobs(const std::function<void(size_t)>& job, size_t count)
+	{
+		while (true)
+		{
+			const size_t index = m_nextIndex.fetch_add(1, std::memory_order_relaxed);
+			if (index >= count)
+			{
+				return;
+			}
+
+			try
+			{
+				job(index);
+			}
+			catch (...)
+			{
+				std::lock_guard lock{ m_mutex };
+				if (not m_exception)
+				{
+					m_exception = std::current_exception();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <Siv3D/Array.hpp>
+
+using namespace s3d;
+
+namespace FlexLayout::Internal
+{
+	/// @brief 独立したレイアウトの計算に使用するワーカースレッド
+	class WorkerPool
+	{
+	public:
+
+		/// @param threadCount 呼び出し元以外に起動するスレッドの数
+		explicit WorkerPool(size_t threadCount);
+
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+
+		WorkerPool& operator =(const WorkerPool&) = delete;
+
+		size_t threadCount() const { return m_threads.size(); }
+
+		/// @brief `job(0)`から`job(count - 1)`までを並列に実行し、すべて完了するまで待つ
+		/// @remark 呼び出し元のスレッドも処理に参加します。
+		/// 他の呼び出しの実行中 (処理の中からの入れ子の呼び出しや、別のスレッドからの同時の呼び出し) は、待たずに呼び出し元のスレッドで順番に実行します。
+		/// 最初に送出された例外は、すべての処理の完了後に呼び出し元で再送出されます
+		void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	private:
+
+		Array<std::thread> m_threads;
+
+		/// @brief ワーカーに処理を割り当てている`parallelFor`の呼び出しが保持する
+		std::mutex m_dispatchMutex;
+
+		std::mutex m_mutex;
+
+		std::condition_variable m_wakeCondition;
+
+		std::condition_variable m_doneCondition;
+
+		/// @brief 実行中の処理 (m_mutexで保護)
+		const std::function<void(size_t)>* m_job = nullptr;
+
+		size_t m_count = 0;
+
+		/// @brief `parallelFor`の呼び出しごとに増加する (m_mutexで保護)
+		uint64 m_generation = 0;
+
+		/// @brief 処理に参加しているワーカーの数 (m_mutexで保護)
+		size_t m_activeWorkers = 0;
+
+		bool m_stopping = false;
+
+		std::exception_ptr m_exception;
+
+		std::atomic<size_t> m_nextIndex{ 0 };
+
+		void workerMain();
+
+		/// @brief 未処理の番号がなくなるまで処理を実行する
+		void runJobs(const std::function<void(size_t)>& job, size_t count);
+
+		/// @brief ワーカーを使用せずに呼び出し元のスレッドで順番に実行する
+		static void RunInline(const std::function<void(size_t)>& job, size_t count);
+	};
+}
@@ -0,0 +1,639 @@
+﻿#include <Siv3D/Unicode.hpp>
+#include "XMLLoader.hpp"
+#include "TreeContext.hpp"
+
+#include "NodeComponent/StyleComponent.hpp"
+#include "NodeComponent/TextComponent.hpp"
+#include "NodeComponent/UIComponent.hpp"
+
+////////////////////////////////////////////////////
+//
+// バイナリ形式のレイアウト (リトルエンディアン)
+//
+// Header    : magic "FLXB", u32 version, u64 schemaHash, u32 stringCount, u32 nodeCount, u32 templateCount
+// Strings   : stringCount x { u32 length, UTF-8 bytes }
+// Nodes     : nodeCount x Node (ルート要素のツリー、行きがけ順)
+// Templates : templateCount x { u32 name, Node... (テンプレートの内容のツリー、行きがけ順) }
+//
+// Node      : u32 tag, u32 text, u32 childCount,
+//             u32 attributeCount, attributeCount x { u32 name, u32 value },
+//             u32 styleCount, styleCount x { u32 property, u32 valueCount, valueCount x StyleValue(8 bytes) }
+//
+// 文字列はすべて文字列テーブルのインデックスで参照します (テキストなしはNoString)
+//
+////////////////////////////////////////////////////
+
+namespace FlexLayout::Internal
+{
+	struct StyleValueSerializer
+	{
+		static constexpr size_t Size = 8;
+
+		static std::array<uint8, Size> Serialize(const Style::StyleValue& value)
+		{
+			std::array<uint8, Size> bytes{ };
+			bytes[0] = static_cast<uint8>(value.m_valueType);
+			bytes[1] = static_cast<uint8>(value.m_enumTypeId);
+			bytes[2] = static_cast<uint8>(value.m_lengthUnit);
+			std::memcpy(&bytes[4], &value.m_intValue, sizeof(int32));
+			return bytes;
+		}
+
+		static Optional<Style::StyleValue> Deserialize(std::span<const uint8> bytes)
+		{
+			using Type = Style::StyleValue::Type;
+
+			assert(bytes.size() == Size);
+
+			Style::StyleValue value;
+			value.m_valueType = static_cast<Type>(bytes[0]);
+			value.m_enumTypeId = static_cast<Style::EnumTypeId>(bytes[1]);
+			value.m_lengthUnit = static_cast<LengthUnit>(bytes[2]);
+			std::memcpy(&value.m_intValue, &bytes[4], sizeof(int32));
+
+			if (value.m_valueType < Type::Unspecified || value.m_valueType > Type::Length)
+			{
+				return none;
+			}
+
+			if (value.m_valueType == Type::Enum)
+			{
+				if (value.m_enumTypeId < 0 ||
+					value.m_enumTypeId >= static_cast<Style::EnumTypeId>(std::variant_size_v<Style::detail::style_enum_variant>) ||
+					value.m_intValue < 0 ||
+					static_cast<size_t>(value.m_intValue) >= Style::detail::GetValueNameList(value.m_enumTypeId).size())
+				{
+					return none;
+				}
+			}
+
+			return value;
+		}
+	};
+
+	namespace detail
+	{
+		constexpr std::array<uint8, 4> CompiledLayoutMagic{ 'F', 'L', 'X', 'B' };
+
+		constexpr uint32 CompiledLayoutVersion = 2;
+
+		constexpr uint32 NoString = std::numeric_limits<uint32>::max();
+
+		/// @brief 列挙型の名前の並びから計算するハッシュ値
+		/// @remark 列挙型の追加・並べ替えでStyleValueの互換性がなくなるため、読み込み時に照合します
+		static uint64 CompiledLayoutSchemaHash()
+		{
+			uint64 hash = 14695981039346656037ULL;
+			const auto feed = [&](const StringView text)
+				{
+					for (const auto ch : text)
+					{
+						hash = (hash ^ ch) * 1099511628211ULL;
+					}
+					hash = (hash ^ 0xFF) * 1099511628211ULL;
+				};
+
+			for (size_t id = 0; id < std::variant_size_v<Style::detail::style_enum_variant>; id++)
+			{
+				for (const auto name : Style::detail::GetValueNameList(static_cast<Style::EnumTypeId>(id)))
+				{
+					feed(name);
+				}
+				feed(U"/");
+			}
+
+			return hash;
+		}
+
+		class CompiledLayoutWriter
+		{
+		public:
+
+			void writeU32(uint32 value)
+			{
+				writeBytes(m_nodes, &value, sizeof(value));
+			}
+
+			void writeString(const std::string_view str)
+			{
+				writeU32(intern(str));
+			}
+
+			void writeStyleValue(const Style::StyleValue& value)
+			{
+				const auto bytes = StyleValueSerializer::Serialize(value);
+				writeBytes(m_nodes, bytes.data(), bytes.size());
+			}
+
+			/// @param nodeCount ルート要素のツリーの要素数
+			/// @param templateCount 書き出したテンプレートの数
+			Array<uint8> finish(uint32 nodeCount, uint32 templateCount) const
+			{
+				Array<uint8> output;
+
+				const uint32 version = CompiledLayoutVersion;
+				const uint64 schemaHash = CompiledLayoutSchemaHash();
+				const uint32 stringCount = static_cast<uint32>(m_strings.size());
+
+				writeBytes(output, CompiledLayoutMagic.data(), CompiledLayoutMagic.size());
+				writeBytes(output, &version, sizeof(version));
+				writeBytes(output, &schemaHash, sizeof(schemaHash));
+				writeBytes(output, &stringCount, sizeof(stringCount));
+				writeBytes(output, &nodeCount, sizeof(nodeCount));
+				writeBytes(output, &templateCount, sizeof(templateCount));
+
+				for (const auto& str : m_strings)
+				{
+					const uint32 length = static_cast<uint32>(str.size());
+					writeBytes(output, &length, sizeof(length));
+					writeBytes(output, str.data(), str.size());
+				}
+
+				output.insert(output.end(), m_nodes.begin(), m_nodes.end());
+
+				return output;
+			}
+
+		private:
+
+			Array<uint8> m_nodes;
+
+			Array<std::string> m_strings;
+
+			HashTable<std::string, uint32> m_stringIndices;
+
+			uint32 intern(const std::string_view str)
+			{
+				const std::string key{ str };
+
+				if (auto itr = m_stringIndices.find(key); itr != m_stringIndices.end())
+				{
+					return itr->second;
+				}
+
+				const auto index = static_cast<uint32>(m_strings.size());
+				m_strings.push_back(key);
+				m_stringIndices.emplace(key, index);
+				return index;
+			}
+
+			static void writeBytes(Array<uint8>& buffer, const void* data, size_t size)
+			{
+				const auto bytes = static_cast<const uint8*>(data);
+				buffer.insert(buffer.end(), bytes, bytes + size);
+			}
+		};
+
+		class CompiledLayoutReader
+		{
+		public:
+
+			explicit CompiledLayoutReader(std::span<const uint8> data)
+				: m_data{ data } { }
+
+			bool readU32(uint32& value)
+			{
+				return readBytes(&value, sizeof(value));
+			}
+
+			bool readU64(uint64& value)
+			{
+				return readBytes(&value, sizeof(value));
+			}
+
+			bool readBytes(void* dest, size_t size)
+			{
+				if (m_data.size() - m_pos < size)
+				{
+					return false;
+				}
+
+				std::memcpy(dest, m_data.data() + m_pos, size);
+				m_pos += size;
+				return true;
+			}
+
+			bool readStringTable(uint32 count)
+			{
+				// 文字列テーブルは読み込み時に一度だけUTF-32へ変換する
+				m_strings.reserve(Min<size_t>(count, remaining() / sizeof(uint32)));
+
+				for (uint32 i = 0; i < count; i++)
+				{
+					uint32 length;
+					if (not readU32(length) || remaining() < length)
+					{
+						return false;
+					}
+
+					const auto begin = reinterpret_cast<const char*>(m_data.data() + m_pos);
+					m_strings.push_back(Unicode::FromUTF8(std::string_view{ begin, length }));
+					m_pos += length;
+				}
+
+				return true;
+			}
+
+			/// @return 文字列、範囲外の場合はnullptr (NoStringの場合はallowNoneがtrueなら空の文字列)
+			const String* readString(bool allowNone = false)
+			{
+				static const String Empty;
+
+				uint32 index;
+				if (not readU32(index))
+				{
+					return nullptr;
+				}
+
+				if (index == NoString)
+				{
+					return allowNone ? &Empty : nullptr;
+				}
+
+				return index < m_strings.size() ? &m_strings[index] : nullptr;
+			}
+
+			Optional<Style::StyleValue> readStyleValue()
+			{
+				if (remaining() < StyleValueSerializer::Size)
+				{
+					return none;
+				}
+
+				auto value = StyleValueSerializer::Deserialize(m_data.subspan(m_pos, StyleValueSerializer::Size));
+				m_pos += StyleValueSerializer::Size;
+				return value;
+			}
+
+			size_t remaining() const { return m_data.size() - m_pos; }
+
+		private:
+
+			std::span<const uint8> m_data;
+
+			size_t m_pos = 0;
+
+			Array<String> m_strings;
+		};
+	}
+
+	Optional<Array<uint8>> XMLLoader::Compile(const tinyxml2::XMLDocument& document)
+	{
+		if (document.Error())
+		{
+			return none;
+		}
+
+		auto rootElement = document.RootElement();
+		if (not rootElement)
+		{
+			return none;
+		}
+
+		String rootName = Unicode::FromUTF8(rootElement->Name());
+		if (rootName.lowercase() != U"layout")
+		{
+			return none;
+		}
+
+		detail::CompiledLayoutWriter writer;
+
+		// インラインCSSの解析に使用する作業用ノード
+		auto scratchNode = std::make_shared<FlexBoxNode>();
+
+		uint32 nodeCount = 0;
+		if (auto childElement = GetRootNodeElement(*rootElement))
+		{
+			nodeCount = CompileNode(writer, *childElement, *scratchNode);
+		}
+
+		// テンプレートはルート要素の後に格納する (名前や内容のないものは読み込み時と同様に無視)
+		uint32 templateCount = 0;
+		for (auto child = rootElement->FirstChildElement(); child; child = child->NextSiblingElement())
+		{
+			if (not IsTemplateElement(*child))
+			{
+				continue;
+			}
+
+			auto name = child->Attribute("name");
+			auto contentElement = child->FirstChildElement();
+			if (not name || not contentElement)
+			{
+				continue;
+			}
+
+			writer.writeString(name);
+			CompileNode(writer, *contentElement, *scratchNode);
+			templateCount++;
+		}
+
+		return writer.finish(nodeCount, templateCount);
+	}
+
+	bool XMLLoader::IsCompiled(std::span<const uint8> data)
+	{
+		return data.size() >= detail::CompiledLayoutMagic.size() &&
+			std::equal(detail::CompiledLayoutMagic.begin(), detail::CompiledLayoutMagic.end(), data.begin());
+	}
+
+	bool XMLLoader::loadCompiled(std::shared_ptr<FlexBoxNode>& rootRef, std::span<const uint8> data)
+	{
+		if (not IsCompiled(data))
+		{
+			return false;
+		}
+
+		detail::CompiledLayoutReader reader{ data.subspan(detail::CompiledLayoutMagic.size()) };
+
+		uint32 version, stringCount, nodeCount, templateCount;
+		uint64 schemaHash;
+		if (not reader.readU32(version) ||
+			version != detail::CompiledLayoutVersion ||
+			not reader.readU64(schemaHash) ||
+			schemaHash != detail::CompiledLayoutSchemaHash() ||
+			not reader.readU32(stringCount) ||
+			not reader.readU32(nodeCount) ||
+			not reader.readU32(templateCount) ||
+			not reader.readStringTable(stringCount))
+		{
+			return false;
+		}
+
+		std::shared_ptr<FlexBoxNode> root;
+		if (nodeCount != 0)
+		{
+			root = loadCompiledTree(reader);
+			if (not root)
+			{
+				return false;
+			}
+		}
+
+		HashTable<String, std::shared_ptr<FlexBoxNode>> templates;
+		for (uint32 i = 0; i < templateCount; i++)
+		{
+			const String* name = reader.readString();
+			if (not name)
+			{
+				return false;
+			}
+
+			auto node = loadCompiledTree(reader);
+			if (not node)
+			{
+				return false;
+			}
+
+			// 複製したノードがYogaのスタイルをそのまま引き継げるよう、事前に適用しておく
+			node->context()
+				.getContext<Context::StyleContext>()
+				.applyStyles(*node);
+
+			templates[*name] = std::move(node);
+		}
+
+		m_templates = std::move(templates);
+		rootRef = std::move(root);
+		return true;
+	}
+
+	uint32 XMLLoader::CompileNode(detail::CompiledLayoutWriter& writer, const tinyxml2::XMLElement& element, FlexBoxNode& scratchNode)
+	{
+		uint32 nodeCount = 0;
+
+		// 深いツリーでもスタックを消費しないよう、再帰呼び出しを使用せずに行きがけ順に書き出す
+		Array<const tinyxml2::XMLElement*> stack;
+		stack.push_back(&element);
+
+		while (not stack.empty())
+		{
+			const auto& current = *stack.back();
+			stack.pop_back();
+
+			const bool isTextNode = CompileNodeRecord(writer, current, scratchNode);
+			nodeCount++;
+			if (isTextNode)
+			{
+				continue;
+			}
+
+			// スタックから取り出す順序が逆になるため、逆順に積む
+			for (auto child = current.LastChildElement(); child; child = child->PreviousSiblingElement())
+			{
+				stack.push_back(child);
+			}
+		}
+
+		return nodeCount;
+	}
+
+	bool XMLLoader::CompileNodeRecord(detail::CompiledLayoutWriter& writer, const tinyxml2::XMLElement& element, FlexBoxNode& scratchNode)
+	{
+		String tagName = Unicode::FromUTF8(element.Name());
+		tagName.lowercase();
+		writer.writeString(tagName.toUTF8());
+
+		if (const auto text = LoadInnerText(element))
+		{
+			writer.writeString(text.toUTF8());
+		}
+		else
+		{
+			writer.writeU32(detail::NoString);
+		}
+
+		// Labelの子要素(<br/>)はテキストとして格納済み
+		const bool isTextNode = (tagName == U"label");
+
+		uint32 childCount = 0;
+		for (auto child = element.FirstChildElement(); child && not isTextNode; child = child->NextSiblingElement())
+		{
+			childCount++;
+		}
+		writer.writeU32(childCount);
+
+		// 属性 (styleはStyleValueとして別に格納)
+		const char* styleText = nullptr;
+		uint32 attributeCount = 0;
+		for (auto attr = element.FirstAttribute(); attr; attr = attr->Next())
+		{
+			if (attr->Name() == std::string_view{ "style" })
+			{
+				styleText = attr->Value();
+			}
+			else
+			{
+				attributeCount++;
+			}
+		}
+
+		writer.writeU32(attributeCount);
+		for (auto attr = element.FirstAttribute(); attr; attr = attr->Next())
+		{
+			if (attr->Name() != std::string_view{ "style" })
+			{
+				writer.writeString(attr->Name());
+				writer.writeString(attr->Value());
+			}
+		}
+
+		// スタイル
+		auto& style = scratchNode.getComponent<Component::StyleComponent>();
+		style.setInlineCssText(styleText ? Unicode::FromUTF8(styleText) : U"");
+
+		const auto& entries = style.styles(StylePropertyGroup::Inline);
+		writer.writeU32(static_cast<uint32>(std::count_if(entries.begin(), entries.end(), [](const auto& entry) { return not entry.removed(); })));
+		for (const auto& entry : entries)
+		{
+			if (entry.removed())
+			{
+				continue;
+			}
+
+			writer.writeString(Unicode::ToUTF8(entry.definition().name()));
+			writer.writeU32(static_cast<uint32>(entry.value().size()));
+			for (const auto& value : entry.value())
+			{
+				writer.writeStyleValue(value);
+			}
+		}
+
+		return isTextNode;
+	}
+
+	std::shared_ptr<FlexBoxNode> XMLLoader::loadCompiledTree(detail::CompiledLayoutReader& reader)
+	{
+		struct Frame
+		{
+			std::shared_ptr<FlexBoxNode> node;
+
+			/// @brief 読み込む子要素の数
+			uint32 childCount;
+
+			Array<std::shared_ptr<FlexBoxNode>> children;
+		};
+
+		// 深いツリーでもスタックを消費しないよう、再帰呼び出しを使用せずに読み込む
+		Array<Frame> stack;
+		std::shared_ptr<FlexBoxNode> root;
+
+		do
+		{
+			uint32 childCount;
+			auto node = loadCompiledNode(reader, childCount);
+			if (not node)
+			{
+				return nullptr;
+			}
+
+			if (childCount != 0)
+			{
+				stack.push_back({ std::move(node), childCount, Array<std::shared_ptr<FlexBoxNode>>(Arg::reserve = Min<size_t>(childCount, reader.remaining())) });
+				continue;
+			}
+
+			// 子要素をすべて読み込んだノードを親要素に追加する
+			while (true)
+			{
+				if (stack.empty())
+				{
+					root = std::move(node);
+					break;
+				}
+
+				auto& parent = stack.back();
+				parent.children.push_back(std::move(node));
+				if (parent.children.size() < parent.childCount)
+				{
+					break;
+				}
+
+				if (not parent.node->isTextNode())
+				{
+					parent.node->reconcileChildren(parent.children);
+				}
+
+				node = std::move(parent.node);
+				stack.pop_back();
+			}
+		} while (not stack.empty());
+
+		return root;
+	}
+
+	std::shared_ptr<FlexBoxNode> XMLLoader::loadCompiledNode(detail::CompiledLayoutReader& reader, uint32& childCount)
+	{
+		const String* tagName = reader.readString();
+		const String* text = reader.readString(true);
+		uint32 attributeCount;
+		if (not tagName ||
+			not text ||
+			not reader.readU32(childCount) ||
+			not reader.readU32(attributeCount))
+		{
+			return nullptr;
+		}
+
+		auto node = createNodeFromTagName(*tagName);
+
+		// 属性
+		for (uint32 i = 0; i < attributeCount; i++)
+		{
+			const String* name = reader.readString();
+			const String* value = reader.readString();
+			if (not name || not value)
+			{
+				return nullptr;
+			}
+
+			node->setProperty(*name, *value);
+		}
+
+		// スタイル (解析済みの値をそのまま設定)
+		uint32 styleCount;
+		if (not reader.readU32(styleCount))
+		{
+			return nullptr;
+		}
+
+		auto& style = node->getComponent<Component::StyleComponent>();
+		Array<Style::StyleValue> values;
+		for (uint32 i = 0; i < styleCount; i++)
+		{
+			const String* propertyName = reader.readString();
+			uint32 valueCount;
+			if (not propertyName || not reader.readU32(valueCount))
+			{
+				return nullptr;
+			}
+
+			values.clear();
+			for (uint32 j = 0; j < valueCount; j++)
+			{
+				auto value = reader.readStyleValue();
+				if (not value)
+				{
+					return nullptr;
+				}
+				values.push_back(*value);
+			}
+
+			style.setStyle(StylePropertyGroup::Inline, *propertyName, std::span<const Style::StyleValue>{ values });
+		}
+
+		// テキスト
+		if (node->isTextNode())
+		{
+			node->getComponent<Component::TextComponent>()
+				.setText(*text);
+		}
+		else if (node->isUINode())
+		{
+			node->getComponent<Component::UIComponent>()
+				.setTextContent(*text);
+		}
+
+		return node;
+	}
+}
@@ -2,6 +2,7 @@
 #include <Siv3D/Char.hpp>
 #include "XMLLoader.hpp"
 #include "TreeContext.hpp"
+#include "TreeTraversal.hpp"
 #include "../Util/StyleValueHelper.hpp"
 
 #include "NodeComponent/XmlAttributeComponent.hpp"
@@ -12,23 +13,24 @@ namespace FlexLayout::Internal
 {
 	namespace detail
 	{
-		static std::string ToLower(const std::string_view& str)
+		/// @brief 大文字小文字を区別せずにUTF-8の名前を比較する
+		/// @param lowerName 小文字の名前
+		static bool EqualsIgnoreCase(const std::string_view str, const std::string_view lowerName)
 		{
-			std::string result{ str };
-			std::transform(
-				result.cbegin(),
-				result.cend(),
-				result.begin(),
-				[](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+			return std::equal(
+				str.begin(),
+				str.end(),
+				lowerName.begin(),
+				lowerName.end(),
+				[](unsigned char c, unsigned char lower) { return std::tolower(c) == lower; }
 			);
-			return result;
 		}
 
 		static const tinyxml2::XMLElement* FirstChildElement(const tinyxml2::XMLElement* element, const std::string_view& name)
 		{
 			for (auto child = element->FirstChildElement(); child; child = child->NextSiblingElement())
 			{
-				if (ToLower(child->Name()) == name)
+				if (EqualsIgnoreCase(child->Name(), name))
 				{
 					return child;
 				}
@@ -59,13 +61,63 @@ namespace FlexLayout::Internal
 			return Unicode::FromUTF8(innerText);
 		}
 
+		/// @brief 属性が前回の読み込みと同じかをUTF-8のまま比較する
+		static bool IsSameAttributes(const tinyxml2::XMLElement& element, const Array<std::pair<std::string, std::string>>& previous)
+		{
+			size_t index = 0;
+			for (auto attr = element.FirstAttribute(); attr; attr = attr->Next(), index++)
+			{
+				if (index >= previous.size() ||
+					previous[index].first != attr->Name() ||
+					previous[index].second != attr->Value())
+				{
+					return false;
+				}
+			}
+
+			return index == previous.size();
+		}
+
 		static void LoadAttributes(FlexBoxNode& node, const tinyxml2::XMLElement& element)
 		{
-			node.clearProperties();
+			auto& xmlAttr = node.getComponent<Component::XmlAttributeComponent>();
+
+			const auto& previous = xmlAttr.sourceAttributes();
+			if (IsSameAttributes(element, previous))
+			{
+				return;
+			}
+
+			Array<std::pair<std::string, std::string>> attributes;
 			for (auto attr = element.FirstAttribute(); attr; attr = attr->Next())
 			{
-				node.setProperty(Unicode::FromUTF8(attr->Name()), Unicode::FromUTF8(attr->Value()));
+				attributes.emplace_back(attr->Name(), attr->Value());
+			}
+
+			// 前回の読み込みとの差分のみUTF-32へ変換して反映する
+			for (const auto& [key, value] : previous)
+			{
+				if (not attributes.any([&](const auto& attr) { return attr.first == key; }))
+				{
+					node.removeProperty(Unicode::FromUTF8(key));
+				}
 			}
+
+			for (const auto& [key, value] : attributes)
+			{
+				auto itr = std::find_if(
+					previous.begin(),
+					previous.end(),
+					[&](const auto& attr) { return attr.first == key; }
+				);
+
+				if (itr == previous.end() || itr->second != value)
+				{
+					node.setProperty(Unicode::FromUTF8(key), Unicode::FromUTF8(value));
+				}
+			}
+
+			xmlAttr.setSourceAttributes(std::move(attributes));
 		}
 	}
 
@@ -77,7 +129,6 @@ namespace FlexLayout::Internal
 		}
 
 		auto rootElement = document.RootElement();
-		auto rootName = detail::ToLower(rootElement->Name());
 		if (!rootElement)
 		{
 			return false;
@@ -93,11 +144,11 @@ namespace FlexLayout::Internal
 		// 読み込み
 		bool result = false;
 
-		if (rootName == "layout")
+		if (detail::EqualsIgnoreCase(rootElement->Name(), "layout"))
 		{
 			// 独自フォーマットのXMLとして
 
-			if (auto childElement = rootElement->FirstChildElement())
+			if (auto childElement = GetRootNodeElement(*rootElement))
 			{
 				rootRef = loadNode(*childElement, true);
 			}
@@ -112,9 +163,69 @@ namespace FlexLayout::Internal
 		m_rootCache.reset();
 		m_id2NodeDic.clear();
 
+		// テンプレートはキャッシュを使用せずに作成する
+		if (result)
+		{
+			loadTemplates(*rootElement);
+		}
+
 		return result;
 	}
 
+	bool XMLLoader::IsTemplateElement(const tinyxml2::XMLElement& element)
+	{
+		return detail::EqualsIgnoreCase(element.Name(), "template");
+	}
+
+	const tinyxml2::XMLElement* XMLLoader::GetRootNodeElement(const tinyxml2::XMLElement& layoutElement)
+	{
+		for (auto child = layoutElement.FirstChildElement(); child; child = child->NextSiblingElement())
+		{
+			if (not IsTemplateElement(*child))
+			{
+				return child;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void XMLLoader::loadTemplates(const tinyxml2::XMLElement& layoutElement)
+	{
+		HashTable<String, std::shared_ptr<FlexBoxNode>> templates;
+
+		for (auto child = layoutElement.FirstChildElement(); child; child = child->NextSiblingElement())
+		{
+			if (not IsTemplateElement(*child))
+			{
+				continue;
+			}
+
+			auto name = child->Attribute("name");
+			auto contentElement = child->FirstChildElement();
+			if (not name || not contentElement)
+			{
+				continue;
+			}
+
+			auto node = loadNode(*contentElement, false);
+
+			// 複製したノードがYogaのスタイルをそのまま引き継げるよう、事前に適用しておく
+			node->context()
+				.getContext<Context::StyleContext>()
+				.applyStyles(*node);
+
+			templates[Unicode::FromUTF8(name)] = std::move(node);
+		}
+
+		m_templates = std::move(templates);
+	}
+
+	String XMLLoader::LoadInnerText(const tinyxml2::XMLElement& element)
+	{
+		return detail::LoadInnerText(element);
+	}
+
 	void XMLLoader::registerStateFactory(const String& tagName, std::unique_ptr<UIState>(*factory)())
 	{
 		assert(tagName);
@@ -127,28 +238,32 @@ namespace FlexLayout::Internal
 		m_stateFactories[name] = factory;
 	}
 
-	std::shared_ptr<FlexBoxNode> XMLLoader::loadNode(const tinyxml2::XMLElement& element, bool isRoot)
+	std::shared_ptr<FlexBoxNode> XMLLoader::loadNode(const tinyxml2::XMLElement& element, bool isRoot, const std::shared_ptr<FlexBoxNode>& previousNode)
 	{
 		std::shared_ptr<FlexBoxNode> node;
 
-		String tagName = Unicode::FromUTF8(element.Name());
-		tagName.lowercase();
+		// タグ名とIDはUTF-8のまま比較する (UTF-32への変換は値を設定するノードでのみ行う)
+		const Atom tag = internTagName(element.Name());
 
-		auto idOrNull = element.Attribute("id");
-		String id = idOrNull ? Unicode::FromUTF8(idOrNull) : U"";
+		const char* id = element.Attribute("id");
+		if (id && *id == '\0')
+		{
+			id = nullptr;
+		}
 
 		// キャッシュからnodeへ取得、見つからない場合は新規作成、失敗したらnullptr
 		if (auto cachedNode = popCachedNode({
 			.root = isRoot,
 			.id = id,
-			.tagName = tagName,
+			.tag = tag,
+			.previous = previousNode,
 		}))
 		{
 			node = cachedNode;
 		}
 		else
 		{
-			auto createdNode = createNodeFromTagName(tagName);
+			auto createdNode = createNodeFromTagName(AtomTable::ToString(tag));
 			node = createdNode;
 		}
 		assert(node);
@@ -170,22 +285,29 @@ namespace FlexLayout::Internal
 					.setTextContent(detail::LoadInnerText(element));
 			}
 
-			auto newChildren = loadChildren(element);
-			node->setChildren(newChildren);
+			// 子要素は切り離さずに並べ替え、変化のないノードのスタイルやレイアウト結果を維持する
+			const auto previousChildren = node->children();
+			auto newChildren = loadChildren(element, previousChildren);
+			node->reconcileChildren(newChildren);
 		}
 		
 		return node;
 	}
 
-	Array<std::shared_ptr<FlexBoxNode>> XMLLoader::loadChildren(const tinyxml2::XMLElement& element)
+	Array<std::shared_ptr<FlexBoxNode>> XMLLoader::loadChildren(const tinyxml2::XMLElement& element, const Array<std::shared_ptr<FlexBoxNode>>& previousChildren)
 	{
 		Array<std::shared_ptr<FlexBoxNode>> children;
 
+		size_t index = 0;
 		for (auto childElement = element.FirstChildElement();
 			childElement;
-			childElement = childElement->NextSiblingElement())
+			childElement = childElement->NextSiblingElement(), index++)
 		{
-			children.push_back(loadNode(*childElement, false));
+			children.push_back(loadNode(
+				*childElement,
+				false,
+				index < previousChildren.size() ? previousChildren[index] : nullptr
+			));
 		}
 
 		return children;
@@ -233,31 +355,46 @@ namespace FlexLayout::Internal
 		return nullptr;
 	}
 
-	void XMLLoader::cacheNodesById(std::shared_ptr<FlexBoxNode> node)
+	Atom XMLLoader::internTagName(const char* name)
 	{
-		if (auto id = node->getComponent<Component::XmlAttributeComponent>().id())
+		std::string key{ name };
+		if (auto itr = m_tagAtoms.find(key);
+			itr != m_tagAtoms.end())
 		{
-			auto itr = m_id2NodeDic.find(*id);
-			if (itr == m_id2NodeDic.end())
-			{
-				m_id2NodeDic.emplace(*id, node);
-			}
+			return itr->second;
 		}
 
-		for (auto& child : node->children())
-		{
-			cacheNodesById(child);
-		}
+		// 初めて現れた表記のみ変換する
+		String tagName = Unicode::FromUTF8(key);
+		tagName.lowercase();
+
+		return m_tagAtoms.emplace(std::move(key), AtomTable::Intern(tagName)).first->second;
+	}
+
+	void XMLLoader::cacheNodesById(std::shared_ptr<FlexBoxNode> node)
+	{
+		TraversePreOrder(*node, [&](FlexBoxNode& item)
+			{
+				if (auto id = item.getComponent<Component::XmlAttributeComponent>().id())
+				{
+					m_id2NodeDic.emplace(id->toUTF8(), item.shared_from_this());
+				}
+			});
 	}
 
 	std::shared_ptr<FlexBoxNode> XMLLoader::popCachedNode(_CacheFilters filters)
 	{
 		std::shared_ptr<FlexBoxNode> node;
 
-		if (auto itr = m_id2NodeDic.find(filters.id);
-			itr != m_id2NodeDic.end())
+		if (filters.id)
 		{
-			// IDで検索
+			// IDで検索 (IDを持つ要素は、同じIDのノードのみ再利用する)
+			auto itr = m_id2NodeDic.find(std::string{ filters.id });
+			if (itr == m_id2NodeDic.end())
+			{
+				return nullptr;
+			}
+
 			node = std::move(itr->second);
 			m_id2NodeDic.erase(itr);
 		}
@@ -266,6 +403,12 @@ namespace FlexLayout::Internal
 			// ルート要素のキャッシュを利用
 			node = m_rootCache;
 		}
+		else if (filters.previous &&
+			not filters.previous->getComponent<Component::XmlAttributeComponent>().id())
+		{
+			// 同じ位置にあったIDを持たないノードを利用
+			node = filters.previous;
+		}
 		else
 		{
 			// ヒットしない場合はnullptr
@@ -276,12 +419,7 @@ namespace FlexLayout::Internal
 
 		auto& component = node->getComponent<Component::XmlAttributeComponent>();
 
-		if (filters.id && component.id() != filters.id)
-		{
-			return nullptr;
-		}
-
-		if (filters.tagName && component.tagName() != filters.tagName)
+		if (component.tagAtom() != filters.tag)
 		{
 			return nullptr;
 		}
@@ -1,12 +1,21 @@
 ﻿#pragma once
+#include <span>
+#include <string>
 #include <tinyxml2.h>
 #include "FlexBoxNode.hpp"
+#include "Atom.hpp"
 #include "../UIState.hpp"
 
 using namespace s3d;
 
 namespace FlexLayout::Internal
 {
+	namespace detail
+	{
+		class CompiledLayoutWriter;
+		class CompiledLayoutReader;
+	}
+
 	class XMLLoader
 	{
 	public:
@@ -17,29 +26,86 @@ namespace FlexLayout::Internal
 
 		void registerSimpleGUIFactories();
 
+		/// @brief 最後に読み込んだXMLの`<Template name="...">`要素から作成したノード
+		/// @remark ノードはスタイルを適用した状態で保持され、`deepClone()`で複製して使用します
+		const HashTable<String, std::shared_ptr<FlexBoxNode>>& templates() const { return m_templates; }
+
+		/// @brief XMLをバイナリ形式に変換する
+		/// @remark スタイルは解析済みのStyleValueとして格納されます。`<Template>`要素もルート要素と同じ形式で格納されます
+		/// @return 変換に失敗した場合はnone
+		static Optional<Array<uint8>> Compile(const tinyxml2::XMLDocument& document);
+
+		/// @brief バイナリ形式のレイアウトを読み込む
+		/// @remark XMLやCSSの解析は行わず、常に新しいツリーを作成します。テンプレートも格納されたものに置き換わります
+		/// @return 読み込みに失敗した場合はfalse (rootRefは変更されません)
+		bool loadCompiled(std::shared_ptr<FlexBoxNode>& rootRef, std::span<const uint8> data);
+
+		/// @brief バイナリ形式のレイアウトかを判定する
+		static bool IsCompiled(std::span<const uint8> data);
+
 	private:
 
 		struct _CacheFilters
 		{
 			bool root = false;
-			const StringView id = U"";
-			const StringView tagName = U"";
+
+			/// @brief UTF-8のID (IDを持たない場合はnullptr)
+			const char* id = nullptr;
+
+			Atom tag = Atom::None;
+
+			std::shared_ptr<FlexBoxNode> previous = nullptr;
 		};
 
 		std::shared_ptr<FlexBoxNode> m_rootCache;
 
-		HashTable<String, std::shared_ptr<FlexBoxNode>> m_id2NodeDic;
+		/// @brief 再読み込み時に再利用するノード (キーはUTF-8のID)
+		HashTable<std::string, std::shared_ptr<FlexBoxNode>> m_id2NodeDic;
+
+		/// @brief XMLに記述されたタグ名 (UTF-8) と、小文字に変換したタグ名のアトム
+		HashTable<std::string, Atom> m_tagAtoms;
 
 		HashTable<String, std::unique_ptr<UIState>(*)()> m_stateFactories;
 
-		std::shared_ptr<FlexBoxNode> loadNode(const tinyxml2::XMLElement& element, bool isRoot);
+		HashTable<String, std::shared_ptr<FlexBoxNode>> m_templates;
 
-		Array<std::shared_ptr<FlexBoxNode>> loadChildren(const tinyxml2::XMLElement& element);
+		/// @brief `<Template>`要素かを判定する
+		static bool IsTemplateElement(const tinyxml2::XMLElement& element);
+
+		/// @brief `<Layout>`直下の要素のうち、ルート要素になるもの (`<Template>`以外の最初の要素) を取得する
+		static const tinyxml2::XMLElement* GetRootNodeElement(const tinyxml2::XMLElement& layoutElement);
+
+		void loadTemplates(const tinyxml2::XMLElement& layoutElement);
+
+		/// @param previousNode 前回の読み込みで同じ位置にあったノード、IDを持たない場合は再利用の候補になります
+		std::shared_ptr<FlexBoxNode> loadNode(const tinyxml2::XMLElement& element, bool isRoot, const std::shared_ptr<FlexBoxNode>& previousNode = nullptr);
+
+		Array<std::shared_ptr<FlexBoxNode>> loadChildren(const tinyxml2::XMLElement& element, const Array<std::shared_ptr<FlexBoxNode>>& previousChildren);
 
 		std::shared_ptr<FlexBoxNode> createNodeFromTagName(const StringView tagName);
 
+		/// @brief タグ名を小文字に変換したアトムを取得する
+		/// @remark 同じ表記のタグ名はUTF-32へ変換せずに取得します
+		Atom internTagName(const char* name);
+
 		void cacheNodesById(std::shared_ptr<FlexBoxNode> node);
 
 		std::shared_ptr<FlexBoxNode> popCachedNode(_CacheFilters filters);
+
+		static String LoadInnerText(const tinyxml2::XMLElement& element);
+
+		/// @brief 要素とその子孫を行きがけ順に書き出す
+		/// @return 書き出した要素の数
+		static uint32 CompileNode(detail::CompiledLayoutWriter& writer, const tinyxml2::XMLElement& element, FlexBoxNode& scratchNode);
+
+		/// @brief 1要素分 (子要素を除く) を書き出す
+		/// @return 子要素を書き出さない要素 (Label) の場合はtrue
+		static bool CompileNodeRecord(detail::CompiledLayoutWriter& writer, const tinyxml2::XMLElement& element, FlexBoxNode& scratchNode);
+
+		std::shared_ptr<FlexBoxNode> loadCompiledTree(detail::CompiledLayoutReader& reader);
+
+		/// @brief 1要素分 (子要素を除く) を読み込む
+		/// @param childCount 続けて格納されている子要素の数
+		std::shared_ptr<FlexBoxNode> loadCompiledNode(detail::CompiledLayoutReader& reader, uint32& childCount);
 	};
 }
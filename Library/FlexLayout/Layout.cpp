@@ -1,14 +1,127 @@
 ﻿#include "Layout.hpp"
+#include "VirtualList.hpp"
+#include "Debugger.hpp"
+#include <array>
 #include <Siv3D/FileSystem.hpp>
+#include <Siv3D/AsyncTask.hpp>
+#include <Siv3D/HashTable.hpp>
+#include <Siv3D/BinaryReader.hpp>
+#include <Siv3D/BinaryWriter.hpp>
+#include <Siv3D/MemoryMappedFileView.hpp>
 #include "Internal/FlexBoxNode.hpp"
 #include "Internal/XMLLoader.hpp"
 #include "Internal/TreeContext.hpp"
+#include "Internal/NodeGraveyard.hpp"
 #include "Internal/Accessor.hpp"
+#include "Internal/Config.hpp"
+#include "Internal/LayoutSnapshot.hpp"
 
 #include "Internal/NodeComponent/LayoutComponent.hpp"
 
 namespace FlexLayout
 {
+	namespace detail
+	{
+		/// @brief ワーカースレッドで読み込んだファイルの内容
+		struct ParsedLayoutFile
+		{
+			s3d::FilePath path;
+
+			size_t contentHash = 0;
+
+			/// @brief 前回の読み込みから内容が変化していない
+			bool unchanged = false;
+
+			/// @brief 解析済みのXML、読み込みに失敗した場合はnullptr
+			std::unique_ptr<tinyxml2::XMLDocument> document;
+
+			/// @brief バイナリ形式のファイルの場合はその内容
+			std::string compiledData;
+		};
+
+		static size_t HashContent(const std::string& utf8Content)
+		{
+			return std::hash<std::string_view>{}(utf8Content);
+		}
+
+		/// @brief ファイルの内容をUTF-8のまま1つのバッファへ読み込む
+		/// @remark UTF-16のファイルのみTextReaderで変換します
+		static s3d::Optional<std::string> ReadFileUTF8(const s3d::FilePath& path)
+		{
+			BinaryReader reader{ path };
+			if (not reader)
+			{
+				return none;
+			}
+
+			std::string content(static_cast<size_t>(reader.size()), '\0');
+			if (reader.read(content.data(), reader.size()) != reader.size())
+			{
+				return none;
+			}
+
+			if (content.starts_with("\xEF\xBB\xBF"))
+			{
+				content.erase(0, 3);
+			}
+			else if (content.starts_with("\xFF\xFE") || content.starts_with("\xFE\xFF"))
+			{
+				String text;
+				if (not TextReader(path).readAll(text))
+				{
+					return none;
+				}
+				return text.toUTF8();
+			}
+
+			return content;
+		}
+
+		static bool IsCompiledLayoutFile(const s3d::FilePath& path)
+		{
+			std::array<uint8, 4> header{ };
+
+			BinaryReader reader{ path };
+			return reader &&
+				reader.read(header.data(), header.size()) == static_cast<int64>(header.size()) &&
+				Internal::XMLLoader::IsCompiled(header);
+		}
+
+		static ParsedLayoutFile ReadAndParseFile(s3d::FilePath path, s3d::Optional<size_t> previousContentHash)
+		{
+			ParsedLayoutFile result{ .path = path };
+
+			auto utf8Content = ReadFileUTF8(path);
+			if (not utf8Content)
+			{
+				return result;
+			}
+
+			result.contentHash = HashContent(*utf8Content);
+			if (result.contentHash == previousContentHash)
+			{
+				result.unchanged = true;
+				return result;
+			}
+
+			// バイナリ形式のツリー構築はメインスレッドで行う
+			if (Internal::XMLLoader::IsCompiled({ reinterpret_cast<const uint8*>(utf8Content->data()), utf8Content->size() }))
+			{
+				result.compiledData = std::move(*utf8Content);
+				return result;
+			}
+
+			auto document = std::make_unique<tinyxml2::XMLDocument>(true, tinyxml2::COLLAPSE_WHITESPACE);
+			if (document->Parse(utf8Content->data(), utf8Content->size()) != tinyxml2::XML_SUCCESS)
+			{
+				return result;
+			}
+
+			result.document = std::move(document);
+			return result;
+		}
+	}
+
 	struct Layout::Impl
 	{
 		Layout* intf;
@@ -23,6 +136,19 @@ namespace FlexLayout
 
 		s3d::Stopwatch reloadTimer{ };
 
+		/// @brief 最後に読み込んだファイル内容のハッシュ値
+		s3d::Optional<size_t> contentHash{ };
+
+		/// @brief ファイル読み込み・XML解析タスク (ホットリロード, loadAsync)
+		s3d::AsyncTask<detail::ParsedLayoutFile> loadTask{ };
+
+		/// @brief 新しい読み込みで置き換えられた、実行中の読み込みタスク
+		/// @remark 破棄するとタスクの完了を待つため、完了してから`pollLoadTask()`で破棄する
+		s3d::Array<s3d::AsyncTask<detail::ParsedLayoutFile>> staleLoadTasks{ };
+
+		/// @brief loadAsyncの完了通知
+		s3d::Optional<std::promise<bool>> loadPromise{ };
+
 		std::shared_ptr<Internal::FlexBoxNode> root;
 
 		s3d::Optional<float> width = none;
@@ -31,29 +157,121 @@ namespace FlexLayout
 
 		s3d::Vec2 offset = { 0, 0 };
 
+		/// @brief レイアウト境界の部分木を並列に計算する
+		bool parallelSubtreeLayout = false;
+
+		/// @brief レイアウトの計算を描画と並行して行う
+		bool pipelined = false;
+
+		/// @brief ダブルバッファのスナップショット
+		std::array<Internal::LayoutSnapshotBuffer, 2> snapshots;
+
+		/// @brief `snapshot()`で書き出したスナップショット
+		Internal::LayoutSnapshotBuffer exportedSnapshot;
+
+		/// @brief 確定済みのスナップショットの番号
+		size_t committedSlot = 0;
+
+		/// @brief 計算中のスナップショットの番号
+		size_t pendingSlot = 0;
+
+		/// @brief パイプライン化したレイアウトの計算タスク (snapshotsより後に破棄する必要があるため、後に宣言する)
+		s3d::AsyncTask<void> layoutTask{ };
+
 		Internal::XMLLoader loader{ };
 
-		bool loadDocument(const tinyxml2::XMLDocument& document)
+		/// @brief 切り離された要素の解放待ちリスト (解放を遅延させない場合はnullptr)
+		std::shared_ptr<Internal::NodeGraveyard> graveyard{ };
+
+		/// @brief 1回のupdateUI()で解放処理に使用する時間
+		s3d::Duration graveyardBudget{ };
+
+		/// @brief ルート要素の差し替え後の処理
+		/// @param previousRoot 差し替え前のルート要素
+		void onRootReplaced(std::shared_ptr<Internal::FlexBoxNode> previousRoot)
 		{
-			if (loader.load(root, document))
+			// 切り離したツリーはこのレイアウトのスナップショットを参照しない
+			if (previousRoot && previousRoot != root
+				&& (not root || &previousRoot->context() != &root->context()))
+			{
+				previousRoot->context().setLayoutPipelined(false);
+			}
+
+			if (graveyard)
 			{
-				if (onLoad)
+				if (previousRoot != root)
 				{
-					Box root{ root };
-					onLoad(*intf, root);
+					graveyard->bury(std::move(previousRoot));
 				}
+
+				if (root)
+				{
+					root->context().setGraveyard(graveyard);
+				}
+			}
+		}
+
+		void notifyLoaded(std::shared_ptr<Internal::FlexBoxNode> previousRoot)
+		{
+			onRootReplaced(std::move(previousRoot));
+
+			if (onLoad)
+			{
+				Box document{ root };
+				onLoad(*intf, document);
+			}
+		}
+
+		bool loadDocument(const tinyxml2::XMLDocument& document)
+		{
+			finishLayoutTask();
+
+			auto previousRoot = root;
+			if (loader.load(root, document))
+			{
+				notifyLoaded(std::move(previousRoot));
 				return true;
 			}
 			return false;
 		}
 
+		bool loadCompiledFile(const s3d::FilePath& fullPath)
+		{
+			finishLayoutTask();
+
+			MemoryMappedFileView file{ fullPath };
+			if (not file)
+			{
+				return false;
+			}
+
+			const auto mapped = file.mapAll();
+			if (not mapped.data)
+			{
+				return false;
+			}
+
+			const std::span<const uint8> data{ reinterpret_cast<const uint8*>(mapped.data), mapped.size };
+			auto previousRoot = root;
+			if (not loader.loadCompiled(root, data))
+			{
+				return false;
+			}
+
+			notifyLoaded(std::move(previousRoot));
+			return true;
+		}
+
 		bool loadFileContent(s3d::StringView content)
 		{
-			auto utf8Content = content.toUTF8();
+			return loadUTF8Content(content.toUTF8());
+		}
 
+		bool loadUTF8Content(const std::string& utf8Content)
+		{
 			tinyxml2::XMLDocument document(true, tinyxml2::COLLAPSE_WHITESPACE);
 
-			if (document.Parse(utf8Content.data()) != tinyxml2::XML_SUCCESS)
+			if (document.Parse(utf8Content.data(), utf8Content.size()) != tinyxml2::XML_SUCCESS)
 			{
 				return false;
 			}
@@ -61,6 +279,22 @@ namespace FlexLayout
 			return loadDocument(document);
 		}
 
+		void setupHotReload(const s3d::FilePath& fullPath, bool enableHotReload)
+		{
+			if (enableHotReload)
+			{
+				if (fileFullPath != fullPath || not dirWatcher)
+				{
+					FilePath watchDirectory = FileSystem::ParentPath(fullPath);
+					dirWatcher = std::make_unique<DirectoryWatcher>(watchDirectory);
+				}
+			}
+			else
+			{
+				dirWatcher.reset();
+			}
+		}
+
 		bool loadFile(s3d::FilePathView path, bool enableHotReload)
 		{
 			FilePath fullPath = FileSystem::FullPath(path);
@@ -69,31 +303,124 @@ namespace FlexLayout
 				return false;
 			}
 
-			// ホットリロードの設定
-			if (enableHotReload)
+			// バイナリ形式の場合はメモリマップして読み込む (ホットリロードは非対応)
+			if (detail::IsCompiledLayoutFile(fullPath))
 			{
-				if (fileFullPath != fullPath)
+				dirWatcher.reset();
+				contentHash.reset();
+
+				if (not loadCompiledFile(fullPath))
 				{
-					FilePath watchDirectory = FileSystem::ParentPath(fullPath);
-					dirWatcher = std::make_unique<DirectoryWatcher>(watchDirectory);
+					return false;
 				}
+
+				fileFullPath = fullPath;
+				return true;
 			}
-			else
+
+			// ホットリロードの設定
+			setupHotReload(fullPath, enableHotReload);
+
+			// ファイル内容読み込み (UTF-8のままtinyxml2へ渡す)
+			const auto utf8Content = detail::ReadFileUTF8(fullPath);
+			if (not utf8Content)
 			{
-				dirWatcher.reset();
+				return false;
 			}
 
-			// ファイル内容読み込み
-			String fileContent;
+			fileFullPath = fullPath;
 
-			if (not TextReader(fullPath).readAll(fileContent))
+			if (not loadUTF8Content(*utf8Content))
 			{
+				contentHash.reset();
 				return false;
 			}
 
+			contentHash = detail::HashContent(*utf8Content);
+			return true;
+		}
+
+		std::shared_future<bool> loadFileAsync(s3d::FilePathView path, bool enableHotReload)
+		{
+			// 完了前の非同期読み込みは失敗として扱う
+			resolveLoadPromise(false);
+
+			std::promise<bool> promise;
+			auto future = promise.get_future().share();
+
+			FilePath fullPath = FileSystem::FullPath(path);
+			if (fullPath.isEmpty())
+			{
+				promise.set_value(false);
+				return future;
+			}
+
+			// ホットリロードの設定
+			setupHotReload(fullPath, enableHotReload);
+
 			fileFullPath = fullPath;
+			pendingReload = false;
+
+			// 実行中のタスクは結果を反映しない
+			if (loadTask.isValid())
+			{
+				staleLoadTasks.push_back(std::move(loadTask));
+			}
+
+			// 内容が同じでも必ず読み込むため、ハッシュ値は渡さない
+			loadTask = Async(detail::ReadAndParseFile, fullPath, s3d::Optional<size_t>{});
+			loadPromise = std::move(promise);
+
+			return future;
+		}
+
+		void resolveLoadPromise(bool result)
+		{
+			if (loadPromise)
+			{
+				loadPromise->set_value(result);
+				loadPromise.reset();
+			}
+		}
+
+		bool pollLoadTask()
+		{
+			staleLoadTasks.remove_if([](const s3d::AsyncTask<detail::ParsedLayoutFile>& task) { return task.isReady(); });
+
+			if (not loadTask.isReady())
+			{
+				return false;
+			}
+
+			finishLayoutTask();
+
+			auto parsed = loadTask.get();
+
+			// 読み込み中に別のファイルが読み込まれた場合は破棄
+			bool loaded = false;
+			if (parsed.path == fileFullPath && parsed.document)
+			{
+				if (loadDocument(*parsed.document))
+				{
+					contentHash = parsed.contentHash;
+					loaded = true;
+				}
+			}
+			else if (parsed.path == fileFullPath && not parsed.compiledData.empty())
+			{
+				const std::span<const uint8> data{ reinterpret_cast<const uint8*>(parsed.compiledData.data()), parsed.compiledData.size() };
+				auto previousRoot = root;
+				if (loader.loadCompiled(root, data))
+				{
+					notifyLoaded(std::move(previousRoot));
+					dirWatcher.reset();
+					loaded = true;
+				}
+			}
 
-			return loadFileContent(fileContent);
+			resolveLoadPromise(loaded);
+
+			return loaded;
 		}
 
 		bool reloadFile()
@@ -127,16 +454,166 @@ namespace FlexLayout
 				dirWatcher->clearChanges();
 			}
 
-			// ファイルの更新を反映 (ホットリロード)
-			if (pendingReload && reloadTimer.elapsed() > SecondsF{ 0.5 })
+			// ワーカースレッドで解析したXMLを反映
+			reloaded = pollLoadTask();
+
+			// ファイルの読み込みとXMLの解析はワーカースレッドで行う
+			// 内容が前回の読み込みから変化していない場合は反映しない
+			if (pendingReload &&
+				reloadTimer.elapsed() > SecondsF{ 0.5 } &&
+				not loadTask.isValid() &&
+				not fileFullPath.isEmpty())
 			{
-				reloaded = reloadFile();
+				pendingReload = false;
+				loadTask = Async(detail::ReadAndParseFile, fileFullPath, contentHash);
 			}
 
 			return reloaded;
 		}
 
 		void calculateLayout()
+		{
+			if (not pipelined)
+			{
+				runLayoutPass();
+				return;
+			}
+
+			// 同期的に計算し、直ちに確定する
+			finishLayoutTask();
+			const size_t slot = 1 - committedSlot;
+			runPipelinedLayoutPass(slot);
+			commitSnapshot(slot);
+		}
+
+		/// @brief 描画と並行してレイアウトの計算を開始する
+		void calculateLayoutAsync()
+		{
+			if (not pipelined)
+			{
+				calculateLayout();
+				return;
+			}
+
+			finishLayoutTask();
+
+			if (root)
+			{
+				root->context().setLayoutPipelined(true);
+			}
+
+			// 確定済みでない方のバッファに書き込む
+			pendingSlot = 1 - committedSlot;
+			layoutTask = Async([this, slot = pendingSlot] { runPipelinedLayoutPass(slot); });
+
+			// 計算中に要素を変更する場合は、計算の完了を待ってから変更する
+			if (root)
+			{
+				root->context().setLayoutTaskWaiter([this] { finishLayoutTask(); });
+			}
+		}
+
+		/// @brief 計算中のレイアウトの完了を待って確定する
+		/// @return 新しい計算結果を確定した場合はtrue
+		bool finishLayoutTask()
+		{
+			if (not layoutTask.isValid())
+			{
+				return false;
+			}
+
+			if (root)
+			{
+				root->context().setLayoutTaskWaiter(nullptr);
+			}
+
+			layoutTask.get();
+			commitSnapshot(pendingSlot);
+			return true;
+		}
+
+		void runPipelinedLayoutPass(size_t slot)
+		{
+			const Internal::ScopedLayoutPass layoutPass;
+
+			runLayoutPass();
+
+			if (root)
+			{
+				snapshots[slot].capture(*root, slot);
+			}
+			else
+			{
+				snapshots[slot].clear();
+			}
+		}
+
+		void commitSnapshot(size_t slot)
+		{
+			committedSlot = slot;
+
+			if (root)
+			{
+				auto& context = root->context();
+				context.setLayoutPipelined(true);
+				context.setCommittedSnapshot(&snapshots[slot], slot);
+			}
+		}
+
+		const LayoutSnapshot& snapshot()
+		{
+			if (pipelined)
+			{
+				// 計算中のバッファには触れず、確定済みのものを返す
+				if (root)
+				{
+					if (const auto* committed = root->context().committedSnapshot())
+					{
+						return *committed;
+					}
+				}
+
+				exportedSnapshot.clear();
+				return exportedSnapshot;
+			}
+
+			if (root)
+			{
+				const Internal::ScopedLayoutPass layoutPass;
+				exportedSnapshot.capture(*root, none);
+			}
+			else
+			{
+				exportedSnapshot.clear();
+			}
+			return exportedSnapshot;
+		}
+
+		void setPipelined(bool enabled)
+		{
+			if (pipelined == enabled)
+			{
+				return;
+			}
+
+			finishLayoutTask();
+			pipelined = enabled;
+
+			if (root)
+			{
+				root->context().setLayoutPipelined(enabled);
+			}
+
+			if (not enabled)
+			{
+				for (auto& snapshot : snapshots)
+				{
+					snapshot.clear();
+				}
+			}
+		}
+
+		void runLayoutPass()
 		{
 			if (root)
 			{
@@ -146,7 +623,14 @@ namespace FlexLayout
 					.applyStyles(*root);
 
 				// Yogaのレイアウト計算
-				Internal::CalculateLayout(*root, width, height);
+				if (parallelSubtreeLayout)
+				{
+					Internal::CalculateLayoutParallel(*root, width, height);
+				}
+				else
+				{
+					Internal::CalculateLayout(*root, width, height);
+				}
 
 				// ローカル座標からグローバル座標の計算
 				root->getComponent<Internal::Component::LayoutComponent>()
@@ -156,12 +640,43 @@ namespace FlexLayout
 
 		void updateUI()
 		{
+			finishLayoutTask();
+
 			if (root)
 			{
 				root->context()
 					.getContext<Internal::Context::UIContext>()
 					.update(*root);
 			}
+
+			if (graveyard)
+			{
+				graveyard->drain(graveyardBudget);
+			}
+		}
+
+		void setDeferredDestruction(s3d::Optional<s3d::Duration> budget)
+		{
+			finishLayoutTask();
+
+			if (budget)
+			{
+				if (not graveyard)
+				{
+					graveyard = std::make_shared<Internal::NodeGraveyard>();
+				}
+				graveyardBudget = *budget;
+				onRootReplaced(root);
+			}
+			else if (graveyard)
+			{
+				if (root)
+				{
+					root->context().setGraveyard(nullptr);
+				}
+				graveyard->clear();
+				graveyard.reset();
+			}
 		}
 
 		void drawUI() const
@@ -182,6 +697,10 @@ namespace FlexLayout
 		})
 	{
 		m_impl->loader.registerSimpleGUIFactories();
+		m_impl->loader.registerStateFactory(
+			U"VirtualList",
+			[]() -> std::unique_ptr<UIState> { return std::make_unique<VirtualList>(); }
+		);
 	}
 
 	bool Layout::load(s3d::FilePathView path, EnableHotReload enableHotReload)
@@ -189,6 +708,16 @@ namespace FlexLayout
 		return m_impl->loadFile(path, enableHotReload.getBool());
 	}
 
+	std::shared_future<bool> Layout::loadAsync(s3d::FilePathView path, EnableHotReload enableHotReload)
+	{
+		return m_impl->loadFileAsync(path, enableHotReload.getBool());
+	}
+
+	bool Layout::poll()
+	{
+		return m_impl->pollLoadTask();
+	}
+
 	bool Layout::load(s3d::Arg::code_<s3d::String> code)
 	{
 		return m_impl->loadFileContent(code.value());
@@ -199,6 +728,88 @@ namespace FlexLayout
 		return m_impl->loadDocument(document);
 	}
 
+	bool Layout::Compile(s3d::FilePathView xmlPath, s3d::FilePathView outputPath)
+	{
+		const auto utf8Content = detail::ReadFileUTF8(FilePath{ xmlPath });
+		if (not utf8Content)
+		{
+			return false;
+		}
+
+		tinyxml2::XMLDocument document(true, tinyxml2::COLLAPSE_WHITESPACE);
+		if (document.Parse(utf8Content->data(), utf8Content->size()) != tinyxml2::XML_SUCCESS)
+		{
+			return false;
+		}
+
+		const auto compiled = Internal::XMLLoader::Compile(document);
+		if (not compiled)
+		{
+			return false;
+		}
+
+		BinaryWriter writer{ outputPath };
+		if (not writer)
+		{
+			return false;
+		}
+
+		return writer.write(compiled->data(), compiled->size()) == static_cast<int64>(compiled->size());
+	}
+
+	void Layout::SetAsyncFontLoading(bool enabled)
+	{
+		Internal::GetConfig().setAsyncFontLoading(enabled);
+	}
+
+	void Layout::CalculateLayoutParallel(std::span<Layout* const> layouts)
+	{
+		// ツリーを共有するレイアウトは同じスレッドで順番に計算する
+		s3d::Array<s3d::Array<Impl*>> groups;
+		s3d::HashTable<const Internal::TreeContext*, size_t> groupIndices;
+
+		for (auto* layout : layouts)
+		{
+			if (not layout || not layout->m_impl->root)
+			{
+				continue;
+			}
+
+			const auto* context = &layout->m_impl->root->context();
+			const auto [itr, inserted] = groupIndices.emplace(context, groups.size());
+			if (inserted)
+			{
+				groups.emplace_back();
+			}
+			groups[itr->second].push_back(layout->m_impl.get());
+		}
+
+		if (groups.size() <= 1)
+		{
+			for (auto& group : groups)
+			{
+				for (auto* impl : group)
+				{
+					impl->calculateLayout();
+				}
+			}
+			return;
+		}
+
+		Internal::GetConfig().parallelFor(groups.size(), [&](size_t i)
+			{
+				for (auto* impl : groups[i])
+				{
+					impl->calculateLayout();
+				}
+			});
+	}
+
+	void Layout::SetParallelExecutor(std::function<void(size_t count, const std::function<void(size_t)>& job)> executor)
+	{
+		Internal::GetConfig().setParallelExecutor(std::move(executor));
+	}
+
 	bool Layout::reload()
 	{
 		return m_impl->reloadFile();
@@ -221,6 +832,8 @@ namespace FlexLayout
 
 	void Layout::setConstraints(s3d::Vec2 offset, s3d::Optional<double> width, s3d::Optional<double> height)
 	{
+		m_impl->finishLayoutTask();
+
 		m_impl->offset = offset;
 		m_impl->width = width.map([](double d) { return static_cast<float>(d); });
 		m_impl->height = height.map([](double d) { return static_cast<float>(d); });
@@ -242,7 +855,58 @@ namespace FlexLayout
 
 	void Layout::setDocument(Box root)
 	{
-		m_impl->root = Internal::Accessor::GetNode(root);
+		m_impl->finishLayoutTask();
+
+		auto previousRoot = std::exchange(m_impl->root, Internal::Accessor::GetNode(root));
+		m_impl->onRootReplaced(std::move(previousRoot));
+	}
+
+	void Layout::setParallelSubtreeLayout(bool enabled)
+	{
+		m_impl->finishLayoutTask();
+		m_impl->parallelSubtreeLayout = enabled;
+	}
+
+	bool Layout::isParallelSubtreeLayoutEnabled() const
+	{
+		return m_impl->parallelSubtreeLayout;
+	}
+
+	void Layout::setDeferredDestruction(Optional<Duration> budget)
+	{
+		m_impl->setDeferredDestruction(budget);
+	}
+
+	size_t Layout::pendingDestructionCount() const
+	{
+		return m_impl->graveyard ? m_impl->graveyard->size() : 0;
+	}
+
+	MemoryUsageReport Layout::memoryReport() const
+	{
+		m_impl->finishLayoutTask();
+
+		if (m_impl->root)
+		{
+			return Debugger::MemoryReport(Box{ m_impl->root });
+		}
+		return {};
+	}
+
+	const LayoutSnapshot& Layout::snapshot() const
+	{
+		return m_impl->snapshot();
+	}
+
+	Optional<Box> Layout::instantiate(StringView templateName) const
+	{
+		const auto& templates = m_impl->loader.templates();
+		if (auto itr = templates.find(templateName);
+			itr != templates.end())
+		{
+			return Box{ itr->second->deepClone() };
+		}
+		return none;
 	}
 
 	void Layout::updateUI()
@@ -255,6 +919,26 @@ namespace FlexLayout
 		m_impl->drawUI();
 	}
 
+	void Layout::calculateLayoutAsync()
+	{
+		m_impl->calculateLayoutAsync();
+	}
+
+	bool Layout::commitLayout()
+	{
+		return m_impl->finishLayoutTask();
+	}
+
+	void Layout::setPipelinedLayout(bool enabled)
+	{
+		m_impl->setPipelined(enabled);
+	}
+
+	bool Layout::isPipelinedLayoutEnabled() const
+	{
+		return m_impl->pipelined;
+	}
+
 	void Layout::registerCustomComponentImpl(
 		const s3d::String& tagName,
 		std::unique_ptr<UIState>(*factory)())
@@ -263,5 +947,12 @@ namespace FlexLayout
 	}
 
 	Layout::~Layout()
-	{ }
+	{
+		// 解放待ちの要素はコンテキストを介して解放待ちリストを参照しているため、明示的に解放する
+		if (m_impl)
+		{
+			m_impl->finishLayoutTask();
+			m_impl->setDeferredDestruction(none);
+		}
+	}
 }
@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <future>
+#include <span>
 #include <Siv3D/IReader.hpp>
 #include <Siv3D/TextReader.hpp>
 #include <Siv3D/DirectoryWatcher.hpp>
@@ -7,6 +9,8 @@
 #include "Label.hpp"
 #include "Util/StyleValueHelper.hpp"
 #include "UIState.hpp"
+#include "MemoryReport.hpp"
+#include "LayoutSnapshot.hpp"
 
 namespace tinyxml2
 {
@@ -67,11 +71,24 @@ namespace FlexLayout
 	public:
 
 		/// @brief XMLファイルをファイルパスから読み込む
+		/// @remark `Layout::Compile()`で変換したバイナリ形式のファイルも読み込めます (ホットリロードは無効になります)
 		/// @param path XMLファイルのパス
 		/// @param enableHotReload ホットリロードを有効にするか
 		/// @return 成功した場合はtrue、失敗した場合はfalse
 		bool load(s3d::FilePathView path, EnableHotReload enableHotReload = EnableHotReload::No);
 
+		/// @brief XMLファイルをワーカースレッドで読み込む
+		/// @remark ファイルの読み込みとXMLの解析はワーカースレッドで行われ、
+		/// `poll()`または`handleHotReload()`の呼び出し時にメインスレッドでツリーへ反映されます
+		/// @param path XMLファイルのパス
+		/// @param enableHotReload ホットリロードを有効にするか
+		/// @return ツリーへの反映が完了した時点で結果(成功した場合はtrue)が設定されるfuture
+		std::shared_future<bool> loadAsync(s3d::FilePathView path, EnableHotReload enableHotReload = EnableHotReload::No);
+
+		/// @brief ワーカースレッドでの読み込みが完了していれば、ツリーへ反映する
+		/// @return ツリーが更新された場合はtrue
+		bool poll();
+
 		/// @brief XMLを読み込む
 		/// @return 成功した場合はtrue、失敗した場合はfalse
 		bool load(s3d::Arg::code_<s3d::String> code);
@@ -95,6 +112,19 @@ namespace FlexLayout
 		/// @return 成功した場合はtrue、失敗した場合はfalse
 		bool load(const tinyxml2::XMLDocument& element);
 
+		/// @brief XMLファイルをバイナリ形式に変換する
+		/// @remark バイナリ形式のファイルは`load()`でメモリマップして読み込まれ、XMLやCSSの解析が行われません。
+		/// ライブラリの列挙型が変更された場合は再変換が必要です
+		/// @param xmlPath 変換元のXMLファイルのパス
+		/// @param outputPath 出力先のファイルパス
+		/// @return 成功した場合はtrue、失敗した場合はfalse
+		static bool Compile(s3d::FilePathView xmlPath, s3d::FilePathView outputPath);
+
+		/// @brief `siv3d-font`で指定したフォントアセットを非同期で読み込むかを設定する
+		/// @remark 有効な場合、読み込みが完了するまでは親要素またはデフォルトのフォントでレイアウトし、
+		/// 完了後のレイアウト計算でそのフォントを使用する要素のみ再計算します。デフォルトは無効です
+		static void SetAsyncFontLoading(bool enabled);
+
 		/// @brief XMLファイルを再読み込みする
 		/// @remark ファイルパス以外からXMLデータを読み込んだ場合は常に失敗します
 		/// @return 成功した場合はtrue、失敗した場合はfalse
@@ -107,6 +137,8 @@ namespace FlexLayout
 		bool isHotReloadEnabled() const;
 
 		/// @brief ホットリロードの処理を行う
+		/// @remark ファイルの読み込みとXMLの解析はワーカースレッドで行われ、完了後の呼び出しでツリーに反映されます。
+		/// ファイルの内容が前回の読み込みから変化していない場合は反映しません
 		/// @return 再読み込みが行われた場合はtrue,それ以外はfalse
 		bool handleHotReload();
 
@@ -180,13 +212,87 @@ namespace FlexLayout
 		/// @remark XMLの読込の際に上書きされる可能性があります
 		void setDocument(Box root);
 
+		/// @brief `<Template name="...">`で定義した要素を複製する
+		/// @remark 複製した要素は解析済みのスタイルをテンプレートと共有し、変更時にのみ複製します
+		/// @param templateName テンプレート名
+		/// @return テンプレートが見つからない場合はnone
+		s3d::Optional<Box> instantiate(s3d::StringView templateName) const;
+
+		/// @brief 大きさの固定された部分木 (レイアウト境界) を並列に計算する
+		/// @remark 有効にすると、`calculateLayout()`でwidth, heightがpx指定かつflex-grow, flex-shrinkが0 (または絶対配置) の要素を検出し、
+		/// 変更のある境界の部分木をワーカースレッドで別々に計算してからツリー全体を計算します。
+		/// 32要素未満の部分木や、境界が2つ未満の場合は並列化しません。デフォルトは無効です
+		void setParallelSubtreeLayout(bool enabled);
+
+		bool isParallelSubtreeLayoutEnabled() const;
+
+		/// @brief 不要になった要素の解放を遅延させる
+		/// @remark 有効にすると、再読み込みや子要素の削除で切り離された要素は即座に解放されず、
+		/// `updateUI()`の呼び出しごとに指定した時間の範囲で少しずつ解放されます (他から参照されている要素は解放されません)
+		/// @param budget 1回の`updateUI()`で解放処理に使用する時間、noneの場合は遅延を無効にして残りの要素をすべて解放します
+		void setDeferredDestruction(s3d::Optional<s3d::Duration> budget);
+
+		/// @brief 解放待ちの要素の数
+		size_t pendingDestructionCount() const;
+
+		/// @brief 読み込んだレイアウトのメモリ使用量を集計する
+		/// @remark ルート要素以下のツリーのみを集計します (`Debugger::MemoryReport()`と同じ)
+		MemoryUsageReport memoryReport() const;
+
+		/// @brief すべての要素のレイアウト結果を平坦な配列で取得する
+		/// @remark 1回のツリーの走査で書き出します。パイプライン化が有効な場合は、走査を行わず確定済みの計算結果をそのまま返します (計算の完了は待ちません)
+		/// @return 次に`snapshot()`を呼び出すか、(パイプライン化が有効な場合) 次の計算結果が確定するまで有効な参照
+		const LayoutSnapshot& snapshot() const;
+
+		/// @brief 独立した複数のレイアウトを並列に再計算する
+		/// @remark スタイルの適用とYogaのレイアウト計算をワーカースレッドで行い、すべて完了するまで待ちます。
+		/// 同じツリーを共有するレイアウトが含まれる場合は順番に計算します。
+		/// 計算中は対象のレイアウトや要素を他のスレッドから操作してはいけません
+		/// @param layouts 計算するレイアウト (nullptrは無視されます)
+		static void CalculateLayoutParallel(std::span<Layout* const> layouts);
+
+		/// @brief `CalculateLayoutParallel()`で使用する並列処理の実行方法を設定する
+		/// @remark アプリケーションのジョブシステムを使用する場合に設定します。
+		/// executorは`job(0)`から`job(count - 1)`までを実行し、すべて完了するまで待つ必要があります
+		/// @param executor nullptrの場合はライブラリのワーカースレッドを使用します
+		static void SetParallelExecutor(std::function<void(size_t count, const std::function<void(size_t)>& job)> executor);
+
 		/// @brief UIの更新を行う
+		/// @remark `setDeferredDestruction()`が有効な場合、解放待ちの要素の解放も行います
 		void updateUI();
 
+		/// @brief レイアウトの計算を描画と並行して行うかを設定する
+		/// @remark 有効にすると、`updateAll()`は前のフレームで開始した計算結果を確定させてUIを更新し、次のフレームのレイアウト計算をワーカースレッドで開始します。
+		/// 描画や要素の矩形の取得 (`Box::rect()`など) は確定済みの計算結果を参照するため、表示は1フレーム遅れます。
+		/// 計算中に要素を変更 (`Box::setStyle()`, `appendChild()`など) した場合は、計算の完了を待ってから変更するため並行して計算する効果は失われます。
+		/// 要素の変更は`updateAll()`の中 (`UIState::update`など) で行ってください。デフォルトは無効です
+		void setPipelinedLayout(bool enabled);
+
+		bool isPipelinedLayoutEnabled() const;
+
+		/// @brief レイアウトの再計算をワーカースレッドで開始する
+		/// @remark パイプライン化が無効な場合は`calculateLayout()`と同じです
+		void calculateLayoutAsync();
+
+		/// @brief 計算中のレイアウトの完了を待ち、描画や矩形の取得で参照する計算結果を更新する
+		/// @return 新しい計算結果を確定した場合はtrue
+		bool commitLayout();
+
 		/// @brief 更新処理をまとめて行う
 		template<class... ConstraintArgs>
 		void updateAll(ConstraintArgs... args)
 		{
+			if (isPipelinedLayoutEnabled())
+			{
+				// フレームNの描画中にフレームN+1のレイアウトを計算する
+				commitLayout();
+				handleHotReload();
+				setConstraints(args...);
+				updateUI();
+				calculateLayoutAsync();
+				return;
+			}
+
 			handleHotReload();
 			setConstraints(args...);
 			calculateLayout();
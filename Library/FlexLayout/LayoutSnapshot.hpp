@@ -0,0 +1,68 @@
+﻿#pragma once
+#include <limits>
+#include <Siv3D/Array.hpp>
+#include "BoxRef.hpp"
+#include "Thickness.hpp"
+
+namespace FlexLayout
+{
+	/// @brief ツリーのレイアウト結果を要素ごとの配列 (structure of arrays) に平坦化したもの
+	/// @details 要素を行きがけ順に格納し、i番目の要素の値は各配列のi番目に格納されます。
+	/// 独自の描画処理やUIの自動テストで、要素ごとに`rect()`や`margin()`を呼び出さずにすべての要素の配置を取得する場合に使用します。
+	/// @remark 要素の追加・削除やレイアウトの再計算を行うと`boxes`の参照先は無効になる場合があります
+	struct LayoutSnapshot
+	{
+		/// @brief 要素ごとのフラグ
+		struct Flags
+		{
+			/// @brief レイアウトが確定している (display: noneの要素とその子孫を除く)
+			static constexpr s3d::uint8 HasLayout = 1 << 0;
+
+			/// @brief overflowがvisible以外
+			static constexpr s3d::uint8 ClipsContents = 1 << 1;
+
+			/// @brief overflowがscroll
+			static constexpr s3d::uint8 ScrollContainer = 1 << 2;
+		};
+
+		/// @brief 親要素がない (ルート要素) ことを表す番号
+		static constexpr s3d::uint32 NoParent = std::numeric_limits<s3d::uint32>::max();
+
+		/// @brief 要素
+		s3d::Array<BoxRef> boxes;
+
+		/// @brief 親要素の番号 (ルート要素は`NoParent`)
+		/// @remark 親要素は常に子要素より前に格納されます
+		s3d::Array<s3d::uint32> parentIndices;
+
+		/// @brief ローカル座標からグローバル座標へのオフセット (`HasLayout`の場合のみ有効)
+		s3d::Array<s3d::Vec2> offsets;
+
+		/// @brief グローバル座標のボーダー領域 (`HasLayout`でない場合は空の矩形)
+		s3d::Array<s3d::RectF> borderRects;
+
+		s3d::Array<Thickness> margins;
+
+		s3d::Array<Thickness> borders;
+
+		s3d::Array<Thickness> paddings;
+
+		/// @brief `Flags`の組み合わせ
+		s3d::Array<s3d::uint8> flags;
+
+		size_t size() const noexcept { return boxes.size(); }
+
+		bool empty() const noexcept { return boxes.empty(); }
+
+		bool hasLayout(size_t index) const { return flags[index] & Flags::HasLayout; }
+
+		/// @brief i番目の要素のパディング領域 (グローバル座標)
+		s3d::RectF paddingRect(size_t index) const { return borders[index].shrinkRect(borderRects[index]); }
+
+		/// @brief i番目の要素のコンテンツ領域 (グローバル座標)
+		s3d::RectF contentRect(size_t index) const { return paddings[index].shrinkRect(paddingRect(index)); }
+
+		/// @brief i番目の要素のマージン領域 (グローバル座標)
+		s3d::RectF marginRect(size_t index) const { return margins[index].expandRect(borderRects[index]); }
+	};
+}
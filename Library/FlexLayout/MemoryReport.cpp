@@ -0,0 +1,34 @@
+﻿#include "MemoryReport.hpp"
+#include <Siv3D/FormatLiteral.hpp>
+
+using namespace s3d;
+
+namespace FlexLayout
+{
+	String MemoryUsageReport::toString() const
+	{
+		const std::array<std::pair<StringView, const MemoryUsage*>, 12> rows{ {
+			{ U"nodes", &nodes },
+			{ U"yoga nodes", &yogaNodes },
+			{ U"layout components", &layoutComponents },
+			{ U"style components", &styleComponents },
+			{ U"xml attribute components", &xmlAttributeComponents },
+			{ U"text components", &textComponents },
+			{ U"ui components", &uiComponents },
+			{ U"style tables", &styleTables },
+			{ U"style values", &styleValues },
+			{ U"glyph caches", &glyphCaches },
+			{ U"additional properties", &additionalProperties },
+			{ U"ui states", &uiStates },
+		} };
+
+		String output;
+		for (const auto& [name, usage] : rows)
+		{
+			output += U"{:<26}{:>12} bytes{:>8}\n"_fmt(name, usage->bytes, usage->count);
+		}
+		output += U"{:<26}{:>12} bytes"_fmt(U"total", totalBytes());
+
+		return output;
+	}
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+#include <Siv3D/String.hpp>
+
+namespace FlexLayout
+{
+	/// @brief メモリ使用量
+	struct MemoryUsage
+	{
+		/// @brief バイト数
+		size_t bytes = 0;
+
+		/// @brief 個数
+		size_t count = 0;
+
+		MemoryUsage& add(size_t addBytes, size_t addCount = 1) noexcept
+		{
+			bytes += addBytes;
+			count += addCount;
+			return *this;
+		}
+	};
+
+	/// @brief ツリーのメモリ使用量の内訳
+	/// @remark 各コンテナの容量から算出した見積もりです。アロケータの管理領域や、フォントなど複数のツリーで共有されるリソースは含みません
+	struct MemoryUsageReport
+	{
+		/// @brief ノード本体と子要素の配列
+		MemoryUsage nodes;
+
+		/// @brief Yogaのノード本体と子要素の配列
+		MemoryUsage yogaNodes;
+
+		MemoryUsage layoutComponents;
+
+		MemoryUsage styleComponents;
+
+		/// @brief タグ名・ID・クラス名と、ホットリロード用の属性のキャッシュ
+		MemoryUsage xmlAttributeComponents;
+
+		/// @brief テキストノードの文字列
+		MemoryUsage textComponents;
+
+		MemoryUsage uiComponents;
+
+		/// @brief スタイルのテーブル (スタイルの値を除く)
+		/// @remark 複数のノードで共有されているテーブルは1度だけ計上します
+		MemoryUsage styleTables;
+
+		/// @brief 解析済みのスタイルの値の配列
+		MemoryUsage styleValues;
+
+		/// @brief テキストノードのグリフ・改行位置・行幅のキャッシュ
+		/// @remark 同じ文字列のテキストノードで共有されているシェーピング結果は1度だけ計上します
+		MemoryUsage glyphCaches;
+
+		/// @brief 追加の属性
+		MemoryUsage additionalProperties;
+
+		/// @brief UIの状態 (`UIState::memoryUsage()`の合計)
+		MemoryUsage uiStates;
+
+		/// @brief すべての項目のバイト数の合計
+		size_t totalBytes() const noexcept
+		{
+			return nodes.bytes + yogaNodes.bytes
+				+ layoutComponents.bytes + styleComponents.bytes + xmlAttributeComponents.bytes
+				+ textComponents.bytes + uiComponents.bytes
+				+ styleTables.bytes + styleValues.bytes + glyphCaches.bytes
+				+ additionalProperties.bytes + uiStates.bytes;
+		}
+
+		/// @brief 内訳を表形式の文字列で取得する
+		s3d::String toString() const;
+	};
+}
@@ -22,12 +22,13 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void Button::draw(UIStateQuery query, const Box& box)
+	void Button::draw(UIStateQuery query, BoxRef box)
 	{
 		m_clicked = false;
 		auto rect = box.contentAreaRect();
 		if (rect)
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			m_clicked = s3d::SimpleGUI::Button(
 				query.textContent(),
 				rect->pos,
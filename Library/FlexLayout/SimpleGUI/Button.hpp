@@ -10,12 +10,14 @@ namespace FlexLayout::SimpleGUI
 
 		void attach(UIStateQuery query) override;
 
-		void draw(UIStateQuery query, const Box& box) override;
+		void draw(UIStateQuery query, BoxRef box) override;
 
 		void setTextContent(UIStateQuery query, s3d::StringView text) override;
 
 		std::unique_ptr<UIState> clone() override;
 
+		size_t memoryUsage() const override { return sizeof(*this); }
+
 		bool clicked() const
 		{
 			return m_clicked;
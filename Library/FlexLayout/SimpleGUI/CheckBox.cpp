@@ -22,12 +22,13 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void CheckBox::draw(UIStateQuery query, const Box& box)
+	void CheckBox::draw(UIStateQuery query, BoxRef box)
 	{
 		m_changed = false;
 		auto rect = box.contentAreaRect();
 		if (rect)
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			m_changed = s3d::SimpleGUI::CheckBox(
 				m_checked,
 				query.textContent(),
@@ -10,7 +10,7 @@ namespace FlexLayout::SimpleGUI
 
 		void attach(UIStateQuery query) override;
 
-		void draw(UIStateQuery query, const Box& box) override;
+		void draw(UIStateQuery query, BoxRef box) override;
 
 		void setProperty(UIStateQuery query, s3d::StringView key, s3d::StringView value) override;
 
@@ -20,6 +20,8 @@ namespace FlexLayout::SimpleGUI
 
 		std::unique_ptr<UIState> clone() override;
 
+		size_t memoryUsage() const override { return sizeof(*this); }
+
 		bool checked() const
 		{
 			return m_checked;
@@ -25,7 +25,7 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void ColorPicker::draw(UIStateQuery, const Box& box)
+	void ColorPicker::draw(UIStateQuery, BoxRef box)
 	{
 		m_changed = false;
 		if (auto rect = box.contentAreaRect())
@@ -10,10 +10,12 @@ namespace FlexLayout::SimpleGUI
 
 		void attach(UIStateQuery query) override;
 
-		void draw(UIStateQuery query, const Box& box) override;
+		void draw(UIStateQuery query, BoxRef box) override;
 
 		std::unique_ptr<UIState> clone() override;
 
+		size_t memoryUsage() const override { return sizeof(*this); }
+
 		s3d::HSV value() const
 		{
 			return m_value;
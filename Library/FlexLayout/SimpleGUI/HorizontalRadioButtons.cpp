@@ -25,11 +25,12 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void HorizontalRadioButtons::draw(UIStateQuery, const Box& box)
+	void HorizontalRadioButtons::draw(UIStateQuery, BoxRef box)
 	{
 		m_changed = false;
 		if (auto rect = box.contentAreaRect())
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			m_changed = s3d::SimpleGUI::HorizontalRadioButtons(
 				m_index,
 				m_options,
@@ -79,4 +80,14 @@ namespace FlexLayout::SimpleGUI
 
 		return ptr;
 	}
+
+	size_t HorizontalRadioButtons::memoryUsage() const
+	{
+		size_t bytes = sizeof(*this) + m_options.capacity() * sizeof(String);
+		for (const auto& option : m_options)
+		{
+			bytes += option.capacity() * sizeof(String::value_type);
+		}
+		return bytes;
+	}
 }
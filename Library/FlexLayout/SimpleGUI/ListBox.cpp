@@ -20,11 +20,12 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void ListBox::draw(UIStateQuery, const Box& box)
+	void ListBox::draw(UIStateQuery, BoxRef box)
 	{
 		m_changed = false;
 		if (auto rect = box.contentAreaRect())
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			m_changed = s3d::SimpleGUI::ListBox(
 				m_state,
 				rect->pos,
@@ -64,4 +65,14 @@ namespace FlexLayout::SimpleGUI
 
 		return ptr;
 	}
+
+	size_t ListBox::memoryUsage() const
+	{
+		size_t bytes = sizeof(*this) + m_state.items.capacity() * sizeof(String);
+		for (const auto& item : m_state.items)
+		{
+			bytes += item.capacity() * sizeof(String::value_type);
+		}
+		return bytes;
+	}
 }
@@ -26,7 +26,7 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void Slider::draw(UIStateQuery, const Box& box)
+	void Slider::draw(UIStateQuery, BoxRef box)
 	{
 		m_changed = false;
 		if (auto rect = box.contentAreaRect())
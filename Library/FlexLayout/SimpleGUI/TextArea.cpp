@@ -33,10 +33,11 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void TextArea::draw(UIStateQuery, const Box& box)
+	void TextArea::draw(UIStateQuery, BoxRef box)
 	{
 		if (auto rect = box.contentAreaRect())
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			s3d::SimpleGUI::TextArea(
 				*m_state,
 				rect->pos,
@@ -78,4 +79,11 @@ namespace FlexLayout::SimpleGUI
 
 		return ptr;
 	}
+
+	size_t TextArea::memoryUsage() const
+	{
+		return sizeof(*this)
+			+ sizeof(TextAreaEditState)
+			+ m_state->text.capacity() * sizeof(String::value_type);
+	}
 }
@@ -16,7 +16,7 @@ namespace FlexLayout::SimpleGUI
 
 		void attach(UIStateQuery query) override;
 
-		void draw(UIStateQuery query, const Box& box) override;
+		void draw(UIStateQuery query, BoxRef box) override;
 
 		void setProperty(UIStateQuery query, s3d::StringView key, s3d::StringView value) override;
 
@@ -26,6 +26,8 @@ namespace FlexLayout::SimpleGUI
 
 		std::unique_ptr<UIState> clone() override;
 
+		size_t memoryUsage() const override;
+
 		const s3d::String& text() const
 		{
 			return m_state->text;
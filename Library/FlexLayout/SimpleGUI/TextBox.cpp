@@ -33,10 +33,11 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void TextBox::draw(UIStateQuery, const Box& box)
+	void TextBox::draw(UIStateQuery, BoxRef box)
 	{
 		if (auto rect = box.contentAreaRect())
 		{
+			const auto fontLock = UIStateQuery::LockFontAccess();
 			s3d::SimpleGUI::TextBox(
 				*m_state,
 				rect->pos,
@@ -77,4 +78,11 @@ namespace FlexLayout::SimpleGUI
 
 		return ptr;
 	}
+
+	size_t TextBox::memoryUsage() const
+	{
+		return sizeof(*this)
+			+ sizeof(TextEditState)
+			+ m_state->text.capacity() * sizeof(String::value_type);
+	}
 }
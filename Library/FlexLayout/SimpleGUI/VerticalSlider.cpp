@@ -26,7 +26,7 @@ namespace FlexLayout::SimpleGUI
 		);
 	}
 
-	void VerticalSlider::draw(UIStateQuery, const Box& box)
+	void VerticalSlider::draw(UIStateQuery, BoxRef box)
 	{
 		m_changed = false;
 		if (auto rect = box.contentAreaRect())
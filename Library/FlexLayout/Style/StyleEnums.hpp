@@ -24,8 +24,11 @@
 #include "../Enum/FlexDirection.hpp"
 #include "../Enum/FlexWrap.hpp"
 #include "../Enum/JustifyContent.hpp"
+#include "../Enum/Overflow.hpp"
 #include "../Enum/Position.hpp"
 #include "../Enum/TextAlign.hpp"
+#include "../Enum/TextOverflow.hpp"
+#include "../Enum/WhiteSpace.hpp"
 // #include "../Enum/[.....].hpp"
 
 // ^^^^^----------^^^^^
@@ -43,8 +46,11 @@ namespace FlexLayout::Style::detail
 		FlexDirection,
 		FlexWrap,
 		JustifyContent,
+		Overflow,
 		Position,
-		TextAlign
+		TextAlign,
+		TextOverflow,
+		WhiteSpace
 		// [.....],
 
 		// ^^^^^----------^^^^^
@@ -7,6 +7,8 @@
 namespace FlexLayout::Internal
 {
 	struct StyleValueParser;
+
+	struct StyleValueSerializer;
 }
 
 namespace FlexLayout::Style
@@ -211,6 +213,8 @@ namespace FlexLayout::Style
 			, m_enumTypeId(enumid) { }
 
 		friend struct Internal::StyleValueParser;
+
+		friend struct Internal::StyleValueSerializer;
 	};
 
 	using ValueInputVariant = detail::concat_variant_types<
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Box.hpp"
+#include "BoxRef.hpp"
 #include "UIState.hpp"
 
 namespace FlexLayout
@@ -61,4 +62,10 @@ namespace FlexLayout
 		}
 		return s3d::none;
 	}
+
+	template <class State>
+	s3d::Optional<UIBox<State>> BoxRef::as() const
+	{
+		return lock().as<State>();
+	}
 }
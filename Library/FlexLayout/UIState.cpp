@@ -1,5 +1,6 @@
 ﻿#include "UIState.hpp"
 #include "Internal/FlexBoxNode.hpp"
+#include "Internal/FontAccess.hpp"
 #include "Internal/Style/StyleProperty.hpp"
 #include "Internal/NodeComponent/StyleComponent.hpp"
 #include "Internal/NodeComponent/UIComponent.hpp"
@@ -124,6 +125,11 @@ namespace FlexLayout
 			.setFont(Font{});
 	}
 
+	std::unique_lock<std::recursive_mutex> UIStateQuery::LockFontAccess()
+	{
+		return Internal::LockFontAccess();
+	}
+
 	const String& UIStateQuery::textContent() const
 	{
 		return m_node
@@ -138,4 +144,28 @@ namespace FlexLayout
 			.setTextContent(text);
 	}
 
+	// 以前のシグネチャでオーバーライドしたUIStateのために、非推奨の関数を呼び出す
+#if defined(_MSC_VER)
+#	pragma warning(push)
+#	pragma warning(disable: 4996)
+#else
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+	void UIState::draw(UIStateQuery query, BoxRef box)
+	{
+		draw(query, box.lock());
+	}
+
+	void UIState::update(UIStateQuery query, BoxRef box)
+	{
+		update(query, box.lock());
+	}
+
+#if defined(_MSC_VER)
+#	pragma warning(pop)
+#else
+#	pragma GCC diagnostic pop
+#endif
 }
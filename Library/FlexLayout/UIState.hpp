@@ -1,9 +1,11 @@
 ﻿#pragma once
 #include <memory>
+#include <mutex>
 #include <Siv3D/Array.hpp>
 #include <Siv3D/Font.hpp>
 #include <Siv3D/String.hpp>
 #include "Style/StyleValue.hpp"
+#include "BoxRef.hpp"
 
 namespace FlexLayout::Internal
 {
@@ -12,8 +14,6 @@ namespace FlexLayout::Internal
 
 namespace FlexLayout
 {
-	class Box;
-
 	class UIStateQuery
 	{
 	public:
@@ -106,6 +106,14 @@ namespace FlexLayout
 
 		void setTextContent(s3d::StringView text);
 
+		// Font
+
+		/// @brief フォントへのアクセスを排他制御するロックを取得する
+		/// @remark パイプライン化・並列化したレイアウトでは描画中も別のスレッドでテキストを計測するため、
+		/// `UIState::draw()`でフォントを使用する (テキストを含むSimpleGUIの描画を含む) 場合は、その間このロックを保持してください
+		[[nodiscard]]
+		static std::unique_lock<std::recursive_mutex> LockFontAccess();
+
 	private:
 
 		Internal::FlexBoxNode& m_node;
@@ -117,9 +125,23 @@ namespace FlexLayout
 
 		virtual void attach(UIStateQuery query) { }
 
-		virtual void draw(UIStateQuery query, const Box&) { }
+		/// @remark boxはこの呼び出しの間のみ有効です。保持する場合は`BoxRef::lock()`を使用してください。
+		/// デフォルトの実装は互換性のため`draw(UIStateQuery, const Box&)`を呼び出します
+		virtual void draw(UIStateQuery query, BoxRef box);
 
-		virtual void update(UIStateQuery query, const Box&) { }
+		/// @remark boxはこの呼び出しの間のみ有効です。保持する場合は`BoxRef::lock()`を使用してください。
+		/// デフォルトの実装は互換性のため`update(UIStateQuery, const Box&)`を呼び出します
+		virtual void update(UIStateQuery query, BoxRef box);
+
+		/// @brief 以前のバージョンの描画処理
+		/// @remark `draw(UIStateQuery, BoxRef)`をオーバーライドしない場合のみ呼び出されます。毎フレームBoxを生成するため非推奨です
+		[[deprecated("draw(UIStateQuery, BoxRef)をオーバーライドしてください")]]
+		virtual void draw(UIStateQuery query, const Box& box) { }
+
+		/// @brief 以前のバージョンの更新処理
+		/// @remark `update(UIStateQuery, BoxRef)`をオーバーライドしない場合のみ呼び出されます。毎フレームBoxを生成するため非推奨です
+		[[deprecated("update(UIStateQuery, BoxRef)をオーバーライドしてください")]]
+		virtual void update(UIStateQuery query, const Box& box) { }
 
 		virtual void setProperty(UIStateQuery query, s3d::StringView key, s3d::StringView value) { }
 
@@ -129,6 +151,10 @@ namespace FlexLayout
 
 		virtual std::unique_ptr<UIState> clone() = 0;
 
+		/// @brief 状態が使用するメモリの量 (バイト)
+		/// @remark `Debugger::MemoryReport()`の集計に使用します。動的に確保した領域も含めてください
+		virtual size_t memoryUsage() const { return 0; }
+
 	public:
 
 		virtual ~UIState() { };
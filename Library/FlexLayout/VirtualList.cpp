@@ -0,0 +1,444 @@
+﻿#include "VirtualList.hpp"
+#include <bit>
+#include <Siv3D/Parse.hpp>
+#include "Internal/Accessor.hpp"
+#include "Internal/NodeComponent/LayoutComponent.hpp"
+#include "Internal/NodeComponent/StyleComponent.hpp"
+#include "Internal/NodeComponent/XmlAttributeComponent.hpp"
+
+using namespace s3d;
+
+namespace FlexLayout
+{
+	namespace detail
+	{
+		static void SetPresetStyle(Internal::FlexBoxNode& node, const StringView styleName, StyleValue value)
+		{
+			node.getComponent<Internal::Component::StyleComponent>()
+				.setStyle(Internal::StylePropertyGroup::Preset, styleName, std::array{ value });
+		}
+
+		static std::shared_ptr<Internal::FlexBoxNode> CreateSpacer()
+		{
+			auto node = std::make_shared<Internal::FlexBoxNode>();
+			node->getComponent<Internal::Component::XmlAttributeComponent>()
+				.setTagName(U"#spacer");
+			SetPresetStyle(*node, U"flex-shrink", StyleValue::Number(0));
+			return node;
+		}
+
+		/// @brief Fenwick木の添字の最下位ビット
+		static constexpr size_t LowestBit(size_t k)
+		{
+			return k & (~k + 1);
+		}
+	}
+
+	void VirtualList::attach(UIStateQuery query)
+	{
+		query.setStyle(U"overflow", StyleValue::Enum(Overflow::Scroll));
+		query.setStyle(U"flex-direction", StyleValue::Enum(FlexDirection::Column));
+	}
+
+	void VirtualList::update(UIStateQuery, BoxRef box)
+	{
+		auto& node = Internal::Accessor::GetNode(box);
+		const auto& layout = node.getComponent<Internal::Component::LayoutComponent>();
+
+		// 行の入れ替え前に、前回のレイアウト計算の結果を記録する
+		measureRows();
+
+		if (not isChildrenIntact(node))
+		{
+			rebuildChildren(node);
+		}
+
+		// 表示範囲を計算 (パディング領域の座標系)
+		size_t first = 0;
+		size_t last = 0;
+		if (m_itemCount > 0 && m_rowHeight > 0.0)
+		{
+			const double viewportHeight = layout.localPaddingAreaRect().h;
+			const double top = layout.scrollOffset().y - layout.padding().top;
+			const double bottom = top + viewportHeight;
+
+			size_t visibleFirst, visibleLast;
+			if (m_rowHeightEstimated)
+			{
+				visibleFirst = rowIndexAt(top);
+
+				const size_t bottomIndex = rowIndexAt(bottom);
+				visibleLast = (rowOffset(bottomIndex) < bottom) ? bottomIndex + 1 : bottomIndex;
+			}
+			else
+			{
+				visibleFirst = static_cast<size_t>(Max(Math::Floor(top / m_rowHeight), 0.0));
+				visibleLast = static_cast<size_t>(Max(Math::Ceil(bottom / m_rowHeight), 0.0));
+			}
+
+			first = Min(visibleFirst > m_overscan ? visibleFirst - m_overscan : 0, m_itemCount);
+			last = Min(visibleLast + m_overscan, m_itemCount);
+		}
+
+		// 範囲外になった行をプールへ戻す
+		const size_t keepFirst = Max(first, m_firstIndex);
+		const size_t keepLast = Min(last, m_firstIndex + m_rows.size());
+		if (keepFirst >= keepLast)
+		{
+			for (const auto& row : m_rows)
+			{
+				releaseRow(node, row);
+			}
+			m_rows.clear();
+			m_firstIndex = first;
+		}
+		else
+		{
+			while (m_firstIndex < keepFirst)
+			{
+				releaseRow(node, m_rows.front());
+				m_rows.pop_front();
+				m_firstIndex++;
+			}
+			while (m_firstIndex + m_rows.size() > keepLast)
+			{
+				releaseRow(node, m_rows.back());
+				m_rows.pop_back();
+			}
+		}
+
+		if (m_invalidated)
+		{
+			for (size_t i = 0; i < m_rows.size(); i++)
+			{
+				bindRow(m_rows[i], m_firstIndex + i);
+			}
+			m_invalidated = false;
+		}
+
+		// 先頭側に行を追加
+		while (m_firstIndex > first)
+		{
+			auto row = acquireRow();
+			bindRow(row, --m_firstIndex);
+			node.insertChild(row, 1);
+			m_rows.push_front(std::move(row));
+		}
+
+		// 末尾側に行を追加
+		while (m_firstIndex + m_rows.size() < last)
+		{
+			auto row = acquireRow();
+			bindRow(row, m_firstIndex + m_rows.size());
+			node.insertChild(row, node.children().size() - 1);
+			m_rows.push_back(std::move(row));
+		}
+
+		updateSpacers();
+	}
+
+	void VirtualList::setProperty(UIStateQuery, s3d::StringView key, s3d::StringView value)
+	{
+		if (key == U"item-count")
+		{
+			setItemCount(ParseOpt<size_t>(value).value_or(0));
+		}
+		else if (key == U"row-height")
+		{
+			setRowHeight(ParseOpt<double>(value).value_or(m_rowHeight), false);
+		}
+		else if (key == U"estimated-row-height")
+		{
+			setRowHeight(ParseOpt<double>(value).value_or(m_rowHeight), true);
+		}
+		else if (key == U"overscan")
+		{
+			setOverscan(ParseOpt<size_t>(value).value_or(m_overscan));
+		}
+	}
+
+	std::unique_ptr<UIState> VirtualList::clone()
+	{
+		auto ptr = std::make_unique<VirtualList>();
+
+		ptr->m_itemCount = m_itemCount;
+		ptr->m_rowHeight = m_rowHeight;
+		ptr->m_rowHeightEstimated = m_rowHeightEstimated;
+		ptr->m_overscan = m_overscan;
+		ptr->m_rowFactory = m_rowFactory;
+		ptr->m_rowBinder = m_rowBinder;
+		ptr->m_template = m_template ? m_template->deepClone() : nullptr;
+		ptr->rebuildHeightTree();
+
+		return ptr;
+	}
+
+	size_t VirtualList::memoryUsage() const
+	{
+		return sizeof(*this)
+			+ m_rows.size() * sizeof(decltype(m_rows)::value_type)
+			+ m_pool.capacity() * sizeof(decltype(m_pool)::value_type)
+			+ (m_measuredHeights.capacity() + m_heightTree.capacity()) * sizeof(double);
+	}
+
+	void VirtualList::setItemCount(size_t count)
+	{
+		m_itemCount = count;
+		m_invalidated = true;
+
+		rebuildHeightTree();
+	}
+
+	void VirtualList::setRowHeight(double height, bool estimated)
+	{
+		assert(height > 0.0);
+
+		m_rowHeight = height;
+		m_rowHeightEstimated = estimated;
+		m_invalidated = true;
+
+		rebuildHeightTree();
+	}
+
+	void VirtualList::setOverscan(size_t rows)
+	{
+		m_overscan = rows;
+	}
+
+	void VirtualList::setRowFactory(RowFactory factory)
+	{
+		m_rowFactory = std::move(factory);
+
+		// 生成方法が変わるため既存の行は再利用しない
+		m_pool.clear();
+	}
+
+	void VirtualList::setRowBinder(RowBinder binder)
+	{
+		m_rowBinder = std::move(binder);
+		m_invalidated = true;
+	}
+
+	bool VirtualList::isChildrenIntact(const Internal::FlexBoxNode& node) const
+	{
+		const auto& children = node.children();
+
+		return m_topSpacer &&
+			children.size() == m_rows.size() + 2 &&
+			children.front() == m_topSpacer &&
+			children.back() == m_bottomSpacer;
+	}
+
+	void VirtualList::rebuildChildren(Internal::FlexBoxNode& node)
+	{
+		// XMLなどから追加された子要素の先頭を行のテンプレートとして扱う
+		std::shared_ptr<Internal::FlexBoxNode> newTemplate;
+		for (const auto& child : node.children())
+		{
+			if (child != m_topSpacer &&
+				child != m_bottomSpacer &&
+				std::find(m_rows.begin(), m_rows.end(), child) == m_rows.end())
+			{
+				newTemplate = child;
+				break;
+			}
+		}
+
+		node.removeChildren();
+
+		if (newTemplate)
+		{
+			m_template = std::move(newTemplate);
+			m_pool.clear();
+		}
+		else
+		{
+			m_pool.insert(m_pool.end(), m_rows.begin(), m_rows.end());
+		}
+		m_rows.clear();
+		m_firstIndex = 0;
+
+		if (not m_topSpacer)
+		{
+			m_topSpacer = detail::CreateSpacer();
+			m_bottomSpacer = detail::CreateSpacer();
+		}
+		node.appendChild(m_topSpacer);
+		node.appendChild(m_bottomSpacer);
+		m_spacerHeights = { -1.0, -1.0 };
+
+		m_invalidated = true;
+	}
+
+	std::shared_ptr<Internal::FlexBoxNode> VirtualList::acquireRow()
+	{
+		if (not m_pool.empty())
+		{
+			auto row = std::move(m_pool.back());
+			m_pool.pop_back();
+			return row;
+		}
+
+		std::shared_ptr<Internal::FlexBoxNode> row;
+		if (m_rowFactory)
+		{
+			row = Internal::Accessor::GetNode(m_rowFactory());
+		}
+		else if (m_template)
+		{
+			row = m_template->deepClone();
+		}
+		else
+		{
+			row = std::make_shared<Internal::FlexBoxNode>();
+		}
+
+		detail::SetPresetStyle(*row, U"flex-shrink", StyleValue::Number(0));
+
+		return row;
+	}
+
+	void VirtualList::bindRow(const std::shared_ptr<Internal::FlexBoxNode>& row, size_t index)
+	{
+		if (m_rowHeightEstimated)
+		{
+			row->getComponent<Internal::Component::StyleComponent>()
+				.removeStyle(Internal::StylePropertyGroup::Preset, U"height");
+		}
+		else
+		{
+			detail::SetPresetStyle(*row, U"height", StyleValue::Length(static_cast<float>(m_rowHeight), LengthUnit::Pixel));
+		}
+
+		if (m_rowBinder)
+		{
+			Box rowBox{ row };
+			m_rowBinder(rowBox, index);
+		}
+	}
+
+	void VirtualList::releaseRow(Internal::FlexBoxNode& node, const std::shared_ptr<Internal::FlexBoxNode>& row)
+	{
+		node.removeChild(row);
+		m_pool.push_back(row);
+	}
+
+	void VirtualList::updateSpacers()
+	{
+		const double topHeight = rowOffset(Min(m_firstIndex, m_itemCount));
+		const double bottomHeight = rowOffset(m_itemCount) - rowOffset(Min(m_firstIndex + m_rows.size(), m_itemCount));
+
+		if (m_spacerHeights.first != topHeight)
+		{
+			detail::SetPresetStyle(*m_topSpacer, U"height", StyleValue::Length(static_cast<float>(topHeight), LengthUnit::Pixel));
+			m_spacerHeights.first = topHeight;
+		}
+
+		if (m_spacerHeights.second != bottomHeight)
+		{
+			detail::SetPresetStyle(*m_bottomSpacer, U"height", StyleValue::Length(static_cast<float>(bottomHeight), LengthUnit::Pixel));
+			m_spacerHeights.second = bottomHeight;
+		}
+	}
+
+	void VirtualList::measureRows()
+	{
+		if (not m_rowHeightEstimated)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < m_rows.size(); i++)
+		{
+			const size_t index = m_firstIndex + i;
+			if (index >= m_itemCount)
+			{
+				break;
+			}
+
+			// 追加後にまだレイアウトされていない行は計測しない
+			const auto rect = m_rows[i]->getComponent<Internal::Component::LayoutComponent>().marginAreaRect();
+			if (not rect)
+			{
+				continue;
+			}
+
+			const double height = Max(rect->h, 0.0);
+			const double previous = (m_measuredHeights[index] < 0.0) ? m_rowHeight : m_measuredHeights[index];
+			if (height == previous)
+			{
+				m_measuredHeights[index] = height;
+				continue;
+			}
+
+			m_measuredHeights[index] = height;
+
+			for (size_t k = index + 1; k < m_heightTree.size(); k += detail::LowestBit(k))
+			{
+				m_heightTree[k] += height - previous;
+			}
+		}
+	}
+
+	void VirtualList::rebuildHeightTree()
+	{
+		if (not m_rowHeightEstimated)
+		{
+			m_measuredHeights = {};
+			m_heightTree = {};
+			return;
+		}
+
+		// 残っている項目の計測結果は引き継ぐ
+		m_measuredHeights.resize(m_itemCount, -1.0);
+
+		m_heightTree.assign(m_itemCount + 1, 0.0);
+		for (size_t k = 1; k <= m_itemCount; k++)
+		{
+			const double height = m_measuredHeights[k - 1];
+			m_heightTree[k] += (height < 0.0) ? m_rowHeight : height;
+
+			if (const size_t parent = k + detail::LowestBit(k); parent <= m_itemCount)
+			{
+				m_heightTree[parent] += m_heightTree[k];
+			}
+		}
+	}
+
+	double VirtualList::rowOffset(size_t index) const
+	{
+		if (not m_rowHeightEstimated)
+		{
+			return index * m_rowHeight;
+		}
+
+		double offset = 0.0;
+		for (size_t k = index; k > 0; k -= detail::LowestBit(k))
+		{
+			offset += m_heightTree[k];
+		}
+		return offset;
+	}
+
+	size_t VirtualList::rowIndexAt(double y) const
+	{
+		if (y <= 0.0 || m_itemCount == 0)
+		{
+			return 0;
+		}
+
+		// 累積和がy以下となる最大の行数を二分探索する
+		size_t index = 0;
+		double remaining = y;
+		for (size_t step = std::bit_floor(m_itemCount); step > 0; step >>= 1)
+		{
+			if (index + step <= m_itemCount && m_heightTree[index + step] <= remaining)
+			{
+				index += step;
+				remaining -= m_heightTree[index];
+			}
+		}
+
+		return Min(index, m_itemCount - 1);
+	}
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+#include <deque>
+#include <functional>
+#include "UIBox.hpp"
+
+namespace FlexLayout
+{
+	/// @brief 表示範囲の行だけノードを生成するリスト
+	/// @details 項目数と行の高さから全体の大きさを計算し、表示範囲(とその前後`overscan`行)の行だけを子ノードとして保持します。
+	/// 範囲外に出た行はプールに戻され、別の行として再利用されます。
+	/// XMLで最初の子要素を記述した場合、その要素を行のテンプレートとして複製します。
+	/// @remark 行の入れ替えは`Layout::updateUI()`で行われ、次のレイアウト計算で反映されます
+	class VirtualList : public UIState
+	{
+	public:
+
+		/// @brief 新しい行ノードを生成するコールバック
+		using RowFactory = std::function<Box()>;
+
+		/// @brief 行ノードの内容をindex番目の項目に合わせて更新するコールバック
+		using RowBinder = std::function<void(Box& row, size_t index)>;
+
+		void attach(UIStateQuery query) override;
+
+		void update(UIStateQuery query, BoxRef box) override;
+
+		void setProperty(UIStateQuery query, s3d::StringView key, s3d::StringView value) override;
+
+		std::unique_ptr<UIState> clone() override;
+
+		/// @remark 行ノード自体の大きさは含みません
+		size_t memoryUsage() const override;
+
+		size_t itemCount() const { return m_itemCount; }
+
+		/// @brief 項目数を設定する
+		void setItemCount(size_t count);
+
+		double rowHeight() const { return m_rowHeight; }
+
+		bool isRowHeightEstimated() const { return m_rowHeightEstimated; }
+
+		/// @brief 行の高さを設定する
+		/// @param estimated trueの場合、行の高さは内容から計算され、heightは一度も表示していない行の見積もりにのみ使用されます。
+		/// 表示した行の高さは項目ごとに記録され、表示範囲とスペーサーの計算に使用されます
+		void setRowHeight(double height, bool estimated = false);
+
+		size_t overscan() const { return m_overscan; }
+
+		/// @brief 表示範囲の前後に余分に生成する行数を設定する
+		void setOverscan(size_t rows);
+
+		/// @brief 行ノードの生成方法を設定する
+		/// @remark 未設定の場合はXMLのテンプレート要素を複製します
+		void setRowFactory(RowFactory factory);
+
+		/// @brief 行ノードの更新方法を設定する
+		void setRowBinder(RowBinder binder);
+
+		/// @brief 生成済みのすべての行を次の更新で再度バインドする
+		void invalidate() { m_invalidated = true; }
+
+		/// @brief 生成済みの行の範囲 [first, last)
+		std::pair<size_t, size_t> materializedRange() const { return { m_firstIndex, m_firstIndex + m_rows.size() }; }
+
+	private:
+
+		size_t m_itemCount = 0;
+
+		double m_rowHeight = 24.0;
+
+		bool m_rowHeightEstimated = false;
+
+		size_t m_overscan = 4;
+
+		RowFactory m_rowFactory;
+
+		RowBinder m_rowBinder;
+
+		bool m_invalidated = true;
+
+		std::shared_ptr<Internal::FlexBoxNode> m_template;
+
+		std::shared_ptr<Internal::FlexBoxNode> m_topSpacer;
+
+		std::shared_ptr<Internal::FlexBoxNode> m_bottomSpacer;
+
+		/// @brief 生成済みの行 (m_firstIndex番目の項目から順に格納)
+		std::deque<std::shared_ptr<Internal::FlexBoxNode>> m_rows;
+
+		size_t m_firstIndex = 0;
+
+		/// @brief 再利用待ちの行
+		s3d::Array<std::shared_ptr<Internal::FlexBoxNode>> m_pool;
+
+		/// @brief スペーサーに設定済みの高さ (負の値は未設定)
+		std::pair<double, double> m_spacerHeights{ -1.0, -1.0 };
+
+		/// @brief 項目ごとの計測済みの行の高さ (負の値は未計測、行の高さを見積もる場合のみ使用)
+		s3d::Array<double> m_measuredHeights;
+
+		/// @brief 項目ごとの行の高さ (未計測の行は見積もり) の累積和を求めるFenwick木 (1始まり)
+		s3d::Array<double> m_heightTree;
+
+		bool isChildrenIntact(const Internal::FlexBoxNode& node) const;
+
+		void rebuildChildren(Internal::FlexBoxNode& node);
+
+		std::shared_ptr<Internal::FlexBoxNode> acquireRow();
+
+		void bindRow(const std::shared_ptr<Internal::FlexBoxNode>& row, size_t index);
+
+		void releaseRow(Internal::FlexBoxNode& node, const std::shared_ptr<Internal::FlexBoxNode>& row);
+
+		void updateSpacers();
+
+		/// @brief 表示した行の高さを記録する
+		void measureRows();
+
+		void rebuildHeightTree();
+
+		/// @brief index番目の項目の行の上端 (index == itemCountの場合は全体の高さ)
+		double rowOffset(size_t index) const;
+
+		/// @brief 上端がy以下である最後の行
+		size_t rowIndexAt(double y) const;
+	};
+}
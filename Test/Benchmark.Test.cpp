@@ -0,0 +1,185 @@
+﻿#include <gtest/gtest.h>
+#include <Siv3D.hpp>
+#include "FlexLayout/Layout.hpp"
+#include "FlexLayout/Internal/FlexBoxNode.hpp"
+#include "FlexLayout/Internal/ShapingCache.hpp"
+#include "FlexLayout/Internal/TreeTraversal.hpp"
+
+////////////////////////////////////////////////////
+//
+// 実行時間を計測するベンチマーク
+//
+// 環境によって結果が変わるため、既定では実行しません (DISABLED_)
+// 実行する場合:
+//   Test --gtest_also_run_disabled_tests --gtest_filter=Benchmark.*
+//
+////////////////////////////////////////////////////
+
+namespace FlexLayout::Internal
+{
+	namespace detail
+	{
+		static size_t CountNodesRecursive(const FlexBoxNode& node)
+		{
+			size_t count = 1;
+			for (const auto& child : node.children())
+			{
+				count += CountNodesRecursive(*child);
+			}
+			return count;
+		}
+	}
+
+	TEST(Benchmark, DISABLED_Traversal)
+	{
+		// 再帰版と明示的なスタックによる走査の比較
+		const auto benchmark = [](const char* name, const FlexBoxNode& root)
+			{
+				constexpr size_t Iterations = 20;
+
+				size_t recursiveCount = 0;
+				Stopwatch recursiveTime{ StartImmediately::Yes };
+				for (size_t i = 0; i < Iterations; i++)
+				{
+					recursiveCount += detail::CountNodesRecursive(root);
+				}
+				recursiveTime.pause();
+
+				size_t iterativeCount = 0;
+				Stopwatch iterativeTime{ StartImmediately::Yes };
+				for (size_t i = 0; i < Iterations; i++)
+				{
+					TraversePreOrder(root, [&](const FlexBoxNode&) { iterativeCount++; });
+				}
+				iterativeTime.pause();
+
+				ASSERT_EQ(recursiveCount, iterativeCount);
+
+				std::cout << name << ": recursive " << recursiveTime.usF() / Iterations << "us, iterative " << iterativeTime.usF() / Iterations << "us" << std::endl;
+			};
+
+		// 幅の広いツリー (100 x 100)
+		auto wide = std::make_shared<FlexBoxNode>();
+		for (size_t i = 0; i < 100; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			for (size_t j = 0; j < 100; j++)
+			{
+				child->appendChild(std::make_shared<FlexBoxNode>());
+			}
+			wide->appendChild(child);
+		}
+		benchmark("wide", *wide);
+
+		// 深いツリー (再帰版がスタックオーバーフローしない深さ)
+		auto deep = std::make_shared<FlexBoxNode>();
+		auto leaf = deep;
+		for (size_t i = 0; i < 2000; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			leaf->appendChild(child);
+			leaf = child;
+		}
+		benchmark("deep", *deep);
+	}
+
+	TEST(Benchmark, DISABLED_ParallelSubtreeLayout)
+	{
+		// 大きさの固定されたパネルを並べたダッシュボード
+		String panels;
+		for (size_t i = 0; i < 8; i++)
+		{
+			String rows;
+			for (size_t j = 0; j < 60; j++)
+			{
+				rows += U"<Box style=\"flex-direction: row; justify-content: space-between\"><Label>Item {}-{}</Label><Label>{}</Label></Box>"_fmt(i, j, i * j);
+			}
+			panels += U"<Box id=\"panel{}\" style=\"width: 300px; height: 400px; flex-shrink: 0; padding: 8px; flex-wrap: wrap\">{}</Box>"_fmt(i, rows);
+		}
+		const String code = U"<Layout><Box id=\"root\" style=\"flex-direction: row; flex-wrap: wrap; gap: 8px\">{}</Box></Layout>"_fmt(panels);
+
+		Layout sequential{ Arg::code = code };
+		Layout parallel{ Arg::code = code };
+		parallel.setParallelSubtreeLayout(true);
+
+		// 各パネルの内容を変更して再計算する時間を比較する
+		const auto benchmark = [](Layout& layout)
+			{
+				constexpr size_t Iterations = 10;
+
+				Stopwatch time{ StartImmediately::No };
+				for (size_t i = 0; i < Iterations; i++)
+				{
+					for (size_t j = 0; j < 8; j++)
+					{
+						layout.document()->getElementById(U"panel{}"_fmt(j))->setStyle(U"padding", Pixel(static_cast<float>(8 + i % 2)));
+					}
+					layout.setConstraints(SizeF{ 1280, 1000 });
+
+					time.start();
+					layout.calculateLayout();
+					time.pause();
+				}
+				return time.usF() / Iterations;
+			};
+
+		const double sequentialTime = benchmark(sequential);
+		const double parallelTime = benchmark(parallel);
+		std::cout << "dashboard: sequential " << sequentialTime << "us, parallel " << parallelTime << "us" << std::endl;
+	}
+
+	TEST(Benchmark, DISABLED_ParallelTextMeasurement)
+	{
+		// ラベルの多いレイアウトを、逐次と並列でシェーピングから計算する時間を比較する
+		constexpr size_t LayoutCount = 8;
+
+		const auto makeLayouts = [](size_t iteration)
+			{
+				Array<std::unique_ptr<Layout>> layouts;
+				for (size_t i = 0; i < LayoutCount; i++)
+				{
+					String labels;
+					for (size_t j = 0; j < 200; j++)
+					{
+						labels += U"<Label>Layout {}-{} label {}: The quick brown fox jumps over the lazy dog. 吾輩は猫である。</Label>"_fmt(iteration, i, j);
+					}
+					layouts.push_back(std::make_unique<Layout>(Arg::code = U"<Layout><Box style=\"flex-direction: column\">{}</Box></Layout>"_fmt(labels)));
+					layouts.back()->setConstraints(SizeF{ 400, 10000 });
+				}
+				return layouts;
+			};
+
+		const auto benchmark = [&](bool parallel)
+			{
+				constexpr size_t Iterations = 5;
+
+				Stopwatch time{ StartImmediately::No };
+				for (size_t i = 0; i < Iterations; i++)
+				{
+					// 毎回異なる文字列にして、キャッシュを使わずにシェーピングさせる
+					auto layouts = makeLayouts(i + (parallel ? Iterations : 0));
+					const Array<Layout*> targets = layouts.map([](const auto& layout) { return layout.get(); });
+					Internal::ShapingCache::Clear();
+
+					time.start();
+					if (parallel)
+					{
+						Layout::CalculateLayoutParallel(targets);
+					}
+					else
+					{
+						for (auto* layout : targets)
+						{
+							layout->calculateLayout();
+						}
+					}
+					time.pause();
+				}
+				return time.usF() / Iterations;
+			};
+
+		const double sequentialTime = benchmark(false);
+		const double parallelTime = benchmark(true);
+		std::cout << "text measurement: sequential " << sequentialTime << "us, parallel " << parallelTime << "us (x" << sequentialTime / parallelTime << ")" << std::endl;
+	}
+}
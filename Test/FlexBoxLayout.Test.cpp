@@ -44,4 +44,46 @@ namespace FlexLayout::Internal
 
 		ASSERT_EQ(childLayout.layoutOffset(), (s3d::Vec2{ 0, 0 }));
 	}
+
+	TEST(FlexBoxLayoutTest, ScrollOffset)
+	{
+		std::shared_ptr<FlexBoxNode> root;
+
+		tinyxml2::XMLDocument document;
+		document.Parse(R"(
+			<Layout>
+				<Box style="overflow: scroll; flex-direction: column; height: 100px">
+					<Box style="flex-shrink: 0; height: 300px"/>
+				</Box>
+			</Layout>
+		)");
+
+		XMLLoader{}.load(root, document);
+
+		root->context()
+			.getContext<Context::StyleContext>()
+			.applyStyles(*root);
+
+		CalculateLayout(*root, s3d::none, s3d::none);
+
+		auto child = root->children()[0];
+
+		auto& layout = root->getComponent<Component::LayoutComponent>();
+		auto& childLayout = child->getComponent<Component::LayoutComponent>();
+
+		layout.setLayoutOffsetRecursive(s3d::Vec2{ 0, 0 }, true);
+
+		ASSERT_EQ(layout.maxScrollOffset(), (s3d::Vec2{ 0, 200 }));
+
+		// スクロールはYogaのレイアウト再計算を伴わない
+		layout.setScrollOffset(s3d::Vec2{ 0, 50 });
+
+		ASSERT_FALSE(YGNodeIsDirty(root->yogaNode()));
+		ASSERT_EQ(childLayout.layoutOffset(), (s3d::Vec2{ 0, -50 }));
+
+		layout.setScrollOffset(s3d::Vec2{ 0, 1000 });
+
+		ASSERT_EQ(layout.scrollOffset(), (s3d::Vec2{ 0, 200 }));
+		ASSERT_EQ(childLayout.layoutOffset(), (s3d::Vec2{ 0, -200 }));
+	}
 }
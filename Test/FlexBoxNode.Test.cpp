@@ -4,8 +4,12 @@
 #include "FlexLayout/Layout.hpp"
 #include "FlexLayout/Internal/FlexBoxNode.hpp"
 #include "FlexLayout/Internal/XMLLoader.hpp"
+#include "FlexLayout/Internal/TreeContext.hpp"
+#include "FlexLayout/Internal/TreeTraversal.hpp"
+#include "FlexLayout/Internal/PropertyMap.hpp"
 #include "FlexLayout/Error.hpp"
 
+#include "FlexLayout/Internal/NodeComponent/LayoutComponent.hpp"
 #include "FlexLayout/Internal/NodeComponent/XmlAttributeComponent.hpp"
 #include "FlexLayout/Internal/NodeComponent/StyleComponent.hpp"
 #include "FlexLayout/Internal/NodeComponent/TextComponent.hpp"
@@ -259,6 +263,56 @@ namespace FlexLayout::Internal
 		ASSERT_THROW(root->removeChild(child1), NotFoundError);
 	}
 
+	TEST(FlexBoxTreeTest, ReconcileChildren)
+	{
+		auto root = std::make_shared<FlexBoxNode>();
+
+		auto child1 = std::make_shared<FlexBoxNode>();
+		auto child2 = std::make_shared<FlexBoxNode>();
+		auto child3 = std::make_shared<FlexBoxNode>();
+		auto child4 = std::make_shared<FlexBoxNode>();
+
+		root->setChildren({ child1, child2, child3 });
+		auto context = &root->context();
+
+		ASSERT_NO_THROW(root->reconcileChildren({ child3, child4, child1 }));
+		ASSERT_EQ(root->children().size(), 3);
+		ASSERT_EQ(root->children()[0], child3);
+		ASSERT_EQ(root->children()[1], child4);
+		ASSERT_EQ(root->children()[2], child1);
+
+		// Yogaのツリーも同じ順序になる
+		ASSERT_EQ(YGNodeGetChildCount(root->yogaNode()), 3);
+		ASSERT_EQ(YGNodeGetChild(root->yogaNode(), 0), child3->yogaNode());
+		ASSERT_EQ(YGNodeGetChild(root->yogaNode(), 1), child4->yogaNode());
+		ASSERT_EQ(YGNodeGetChild(root->yogaNode(), 2), child1->yogaNode());
+
+		ASSERT_EQ(child2->parent(), nullptr);
+		ASSERT_EQ(child4->parent(), root.get());
+
+		ASSERT_EQ(&root->context(), context);
+		ASSERT_EQ(&child1->context(), context);
+		ASSERT_EQ(&child4->context(), context);
+		ASSERT_NE(&child2->context(), context);
+	}
+
+	TEST(FlexBoxTreeTest, ReconcileChildren_DuplicatedChild)
+	{
+		auto root = std::make_shared<FlexBoxNode>();
+
+		auto child1 = std::make_shared<FlexBoxNode>();
+		auto child2 = std::make_shared<FlexBoxNode>();
+
+		root->appendChild(child1);
+		child1->appendChild(child2);
+
+		ASSERT_THROW(root->reconcileChildren({ child1, child1 }), InvalidTreeOperationError);
+		ASSERT_THROW(root->reconcileChildren({ child1, child2 }), InvalidTreeOperationError);
+
+		ASSERT_EQ(root->children().size(), 1);
+		ASSERT_EQ(child2->parent(), child1.get());
+	}
+
 	TEST(FlexBoxTreeTest, GetDepth)
 	{
 		auto root = std::make_shared<FlexBoxNode>();
@@ -336,4 +390,455 @@ namespace FlexLayout::Internal
 
 		ASSERT_NE(&clone->context(), &root->context());
 	}
+
+	TEST(FlexBoxTreeTest, AttributeAtoms)
+	{
+		ASSERT_EQ(AtomTable::Intern(U""), Atom::None);
+		ASSERT_EQ(AtomTable::Intern(U"atom-test"), AtomTable::Intern(U"atom-test"));
+		ASSERT_EQ(AtomTable::Find(U"atom-test"), AtomTable::Intern(U"atom-test"));
+		ASSERT_EQ(AtomTable::Find(U"atom-test-unregistered"), Atom::Invalid);
+		ASSERT_EQ(AtomTable::ToString(AtomTable::Intern(U"atom-test")), U"atom-test");
+
+		auto node = std::make_shared<FlexBoxNode>();
+		auto& attr = node->getComponent<Component::XmlAttributeComponent>();
+
+		attr.setTagName(U"box");
+		attr.setId(U"main");
+		attr.setClassText(U" b  a b ");
+		ASSERT_EQ(attr.tagName(), U"box");
+		ASSERT_EQ(attr.id(), U"main");
+		ASSERT_EQ(attr.classes(), (Array<String>{ U"b", U"a" }));
+		ASSERT_EQ(attr.getClassText(), U"b a");
+		ASSERT_TRUE(attr.hasClass(AtomTable::Find(U"a")));
+
+		ASSERT_FALSE(attr.addClass(U"a"));
+		ASSERT_TRUE(attr.addClass(U"c"));
+		ASSERT_FALSE(attr.removeClass(U"atom-test-unregistered"));
+		ASSERT_TRUE(attr.removeClass(U"b"));
+		ASSERT_EQ(attr.classes(), (Array<String>{ U"a", U"c" }));
+
+		attr.setId(none);
+		ASSERT_FALSE(attr.id());
+		ASSERT_EQ(attr.idAtom(), Atom::None);
+
+		// 未登録の名前では検索しても登録されない
+		ASSERT_FALSE(attr.lookupNodeById(U"atom-test-unregistered"));
+		ASSERT_EQ(AtomTable::Find(U"atom-test-unregistered"), Atom::Invalid);
+	}
+
+	TEST(FlexBoxTreeTest, Reload_KeepsRuntimeProperties)
+	{
+		std::shared_ptr<FlexBoxNode> root;
+		XMLLoader loader;
+
+		const auto load = [&](const char* xml)
+			{
+				tinyxml2::XMLDocument document{};
+				document.Parse(xml);
+				loader.load(root, document);
+			};
+
+		load(R"(<Layout><Box><Box id="a" class="x" foo="1"/></Box></Layout>)");
+		auto a = root->children()[0];
+
+		// 実行時に変更した属性・クラス
+		a->setProperty(U"foo", U"2");
+		a->setProperty(U"bar", U"runtime");
+		a->setProperty(U"class", U"y");
+
+		// XMLの属性が変化していない場合は、実行時の変更を維持する
+		load(R"(<Layout><Box><Box id="a" class="x" foo="1"/></Box></Layout>)");
+		ASSERT_EQ(root->children()[0], a);
+		ASSERT_EQ(a->getProperty(U"foo"), U"2");
+		ASSERT_EQ(a->getProperty(U"bar"), U"runtime");
+		ASSERT_EQ(a->getProperty(U"class"), U"y");
+
+		// XMLで変更・削除された属性のみXMLの内容で上書きする
+		load(R"(<Layout><Box><Box id="a" class="z"/></Box></Layout>)");
+		ASSERT_EQ(root->children()[0], a);
+		ASSERT_EQ(a->getProperty(U"foo"), none);
+		ASSERT_EQ(a->getProperty(U"bar"), U"runtime");
+		ASSERT_EQ(a->getProperty(U"class"), U"z");
+	}
+
+	TEST(FlexBoxTreeTest, Reload_ReusesUnchangedNodes)
+	{
+		std::shared_ptr<FlexBoxNode> root;
+		XMLLoader loader;
+
+		tinyxml2::XMLDocument document1{};
+		document1.Parse(R"(
+			<Layout>
+				<Box>
+					<Box style="width: 100px"/>
+					<Label class="abc">foobar</Label>
+				</Box>
+			</Layout>
+		)");
+		loader.load(root, document1);
+
+		root->context()
+			.getContext<Context::StyleContext>()
+			.applyStyles(*root);
+
+		auto box = root->children()[0];
+		auto label = root->children()[1];
+
+		tinyxml2::XMLDocument document2{};
+		document2.Parse(R"(
+			<Layout>
+				<Box>
+					<Box style="width: 100px"/>
+					<Label class="def">foobar</Label>
+				</Box>
+			</Layout>
+		)");
+		loader.load(root, document2);
+
+		// IDがなくても同じ位置・同じタグのノードは再利用される
+		ASSERT_EQ(root->children()[0], box);
+		ASSERT_EQ(root->children()[1], label);
+
+		// 変更のないノードはスタイルが再適用されない
+		ASSERT_FALSE(box->getComponent<Component::StyleComponent>().isStyleApplicationScheduled());
+		ASSERT_FALSE(box->getComponent<Component::StyleComponent>().getStyle(StylePropertyGroup::Inline, U"width").isEmpty());
+
+		ASSERT_EQ(label->getComponent<Component::XmlAttributeComponent>().classes(), Array<String>{ U"def" });
+	}
+
+	TEST(FlexBoxTreeTest, CompiledLayout_RoundTrip)
+	{
+		tinyxml2::XMLDocument document{};
+		document.Parse(R"(
+			<Layout>
+				<Box id="root">
+					<Box class="a b" style="width: 100px; flex-direction: column"/>
+					<Label>foobar</Label>
+				</Box>
+			</Layout>
+		)");
+
+		auto data = XMLLoader::Compile(document);
+		ASSERT_TRUE(data.has_value());
+		ASSERT_TRUE(XMLLoader::IsCompiled(*data));
+
+		std::shared_ptr<FlexBoxNode> root;
+		ASSERT_TRUE(XMLLoader{}.loadCompiled(root, *data));
+
+		ASSERT_EQ(root->getComponent<Component::XmlAttributeComponent>().id(), U"root");
+		ASSERT_EQ(root->children().size(), 2);
+
+		auto box = root->children()[0];
+		ASSERT_EQ(box->getComponent<Component::XmlAttributeComponent>().classes(), (Array<String>{ U"a", U"b" }));
+		ASSERT_EQ(box->getComponent<Component::StyleComponent>().getStyle(StylePropertyGroup::Inline, U"width").size(), 1);
+		ASSERT_EQ(box->getComponent<Component::StyleComponent>().getStyle(StylePropertyGroup::Inline, U"flex-direction").size(), 1);
+
+		ASSERT_EQ(root->children()[1]->getComponent<Component::TextComponent>().text(), U"foobar");
+
+		// 壊れたデータは読み込まない
+		auto broken = *data;
+		broken.resize(broken.size() / 2);
+		ASSERT_FALSE(XMLLoader{}.loadCompiled(root, broken));
+	}
+
+	TEST(FlexBoxTreeTest, CompiledLayout_Templates)
+	{
+		tinyxml2::XMLDocument document{};
+		document.Parse(R"(
+			<Layout>
+				<Template name="row">
+					<Box class="row" style="flex-direction: row">
+						<Label>item</Label>
+					</Box>
+				</Template>
+				<Box id="root"/>
+				<Template name="empty"/>
+			</Layout>
+		)");
+
+		auto data = XMLLoader::Compile(document);
+		ASSERT_TRUE(data.has_value());
+
+		XMLLoader loader;
+		std::shared_ptr<FlexBoxNode> root;
+		ASSERT_TRUE(loader.loadCompiled(root, *data));
+
+		ASSERT_EQ(root->getComponent<Component::XmlAttributeComponent>().id(), U"root");
+
+		// 内容のないテンプレートはXMLの読み込みと同様に無視する
+		ASSERT_EQ(loader.templates().size(), 1);
+		ASSERT_TRUE(loader.templates().contains(U"row"));
+
+		const auto& row = loader.templates().at(U"row");
+		ASSERT_EQ(row->getComponent<Component::XmlAttributeComponent>().classes(), Array<String>{ U"row" });
+		ASSERT_EQ(row->getComponent<Component::StyleComponent>().getStyle(StylePropertyGroup::Inline, U"flex-direction").size(), 1);
+		ASSERT_EQ(row->children().size(), 1);
+		ASSERT_EQ(row->children()[0]->getComponent<Component::TextComponent>().text(), U"item");
+	}
+
+	TEST(FlexBoxTreeTest, CompiledLayout_DeepTree)
+	{
+		// 以前の深さの上限 (1024) を超える
+		constexpr size_t Depth = 2000;
+
+		tinyxml2::XMLDocument document{};
+		auto parent = document.InsertEndChild(document.NewElement("Layout"));
+		for (size_t i = 0; i < Depth; i++)
+		{
+			auto element = document.NewElement("Box");
+			element->SetAttribute("id", static_cast<unsigned>(i));
+			parent->InsertEndChild(element);
+
+			// 兄弟要素の順序が保たれることを確認する
+			auto sibling = document.NewElement("Box");
+			sibling->SetAttribute("id", "sibling");
+			parent->InsertEndChild(sibling);
+
+			parent = element;
+		}
+
+		auto data = XMLLoader::Compile(document);
+		ASSERT_TRUE(data.has_value());
+
+		std::shared_ptr<FlexBoxNode> root;
+		ASSERT_TRUE(XMLLoader{}.loadCompiled(root, *data));
+
+		// ルート要素はLayoutの最初の子要素
+		auto node = root;
+		for (size_t i = 1; i < Depth; i++)
+		{
+			ASSERT_EQ(node->children().size(), 2);
+			ASSERT_EQ(node->children()[1]->getComponent<Component::XmlAttributeComponent>().id(), U"sibling");
+
+			node = node->children()[0];
+			ASSERT_EQ(node->getComponent<Component::XmlAttributeComponent>().id(), Format(i));
+		}
+		ASSERT_TRUE(node->children().isEmpty());
+	}
+
+	TEST(FlexBoxTreeTest, DeepTreeDoesNotOverflowStack)
+	{
+		constexpr size_t Depth = 10000;
+
+		auto root = std::make_shared<FlexBoxNode>();
+		auto leaf = root;
+		for (size_t i = 0; i < Depth; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			leaf->appendChild(child);
+			leaf = child;
+		}
+		leaf->getComponent<Component::XmlAttributeComponent>().setId(U"leaf");
+
+		root->context()
+			.getContext<Context::StyleContext>()
+			.applyStyles(*root);
+
+		root->getComponent<Component::LayoutComponent>().setLayoutOffsetRecursive(Vec2::Zero(), true);
+		ASSERT_TRUE(leaf->getComponent<Component::LayoutComponent>().layoutOffset());
+
+		ASSERT_EQ(root->getComponent<Component::XmlAttributeComponent>().lookupNodeById(U"leaf"), leaf);
+
+		auto clone = root->deepClone();
+		ASSERT_EQ(clone->getComponent<Component::XmlAttributeComponent>().lookupNodeById(U"leaf")->getDepth(), Depth);
+
+		// 葉ノードのみ参照を残して解放する
+		root.reset();
+		clone.reset();
+		ASSERT_EQ(leaf->parent(), nullptr);
+		ASSERT_EQ(std::as_const(*leaf).context(), nullptr);
+		ASSERT_FALSE(leaf->getComponent<Component::LayoutComponent>().layoutOffset());
+	}
+
+	namespace detail
+	{
+		static void CollectNodesRecursive(const FlexBoxNode& node, Array<const FlexBoxNode*>& output)
+		{
+			output.push_back(&node);
+			for (const auto& child : node.children())
+			{
+				CollectNodesRecursive(*child, output);
+			}
+		}
+	}
+
+	TEST(FlexBoxTreeTest, TraversalMatchesRecursiveOrder)
+	{
+		// 幅の広いツリー (10 x 10 x 10)
+		auto root = std::make_shared<FlexBoxNode>();
+		for (size_t i = 0; i < 10; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			for (size_t j = 0; j < 10; j++)
+			{
+				auto grandchild = std::make_shared<FlexBoxNode>();
+				for (size_t k = 0; k < 10; k++)
+				{
+					grandchild->appendChild(std::make_shared<FlexBoxNode>());
+				}
+				child->appendChild(grandchild);
+			}
+			root->appendChild(child);
+		}
+
+		Array<const FlexBoxNode*> expected;
+		detail::CollectNodesRecursive(*root, expected);
+		ASSERT_EQ(expected.size(), 1111);
+
+		Array<const FlexBoxNode*> preOrder;
+		TraversePreOrder(std::as_const(*root), [&](const FlexBoxNode& node) { preOrder.push_back(&node); });
+		ASSERT_TRUE(preOrder == expected);
+
+		Array<const FlexBoxNode*> entered;
+		size_t left = 0;
+		TraverseDepthFirst(std::as_const(*root),
+			[&](const FlexBoxNode& node) { entered.push_back(&node); },
+			[&](const FlexBoxNode& node)
+			{
+				// 子要素はすべて先に処理されている
+				for (const auto& child : node.children())
+				{
+					ASSERT_NE(std::find(entered.begin(), entered.end(), child.get()), entered.end());
+				}
+				left++;
+			});
+		ASSERT_TRUE(entered == expected);
+		ASSERT_EQ(left, expected.size());
+
+		// SkipChildren・Stop
+		size_t visited = 0;
+		TraversePreOrder(std::as_const(*root), [&](const FlexBoxNode& node)
+			{
+				visited++;
+				return &node == root.get() ? TraversalAction::Continue : TraversalAction::SkipChildren;
+			});
+		ASSERT_EQ(visited, 11);
+
+		visited = 0;
+		ASSERT_FALSE(TraversePreOrder(std::as_const(*root), [&](const FlexBoxNode&)
+			{
+				return ++visited == 5 ? TraversalAction::Stop : TraversalAction::Continue;
+			}));
+		ASSERT_EQ(visited, 5);
+	}
+
+	TEST(FlexBoxTreeTest, TraversalOfDeepChain)
+	{
+		// 再帰呼び出しではスタックが溢れる深さ
+		constexpr size_t Depth = 100000;
+
+		auto root = std::make_shared<FlexBoxNode>();
+		auto leaf = root;
+		for (size_t i = 0; i < Depth; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			leaf->appendChild(child);
+			leaf = child;
+		}
+
+		size_t preOrderCount = 0;
+		const FlexBoxNode* lastVisited = nullptr;
+		ASSERT_TRUE(TraversePreOrder(std::as_const(*root), [&](const FlexBoxNode& node)
+			{
+				preOrderCount++;
+				lastVisited = &node;
+			}));
+		ASSERT_EQ(preOrderCount, Depth + 1);
+		ASSERT_EQ(lastVisited, leaf.get());
+
+		// 帰りがけの処理は葉から順に呼び出される
+		size_t enterCount = 0;
+		const FlexBoxNode* firstLeft = nullptr;
+		size_t leaveCount = 0;
+		ASSERT_TRUE(TraverseDepthFirst(std::as_const(*root),
+			[&](const FlexBoxNode&) { enterCount++; },
+			[&](const FlexBoxNode& node)
+			{
+				if (leaveCount++ == 0)
+				{
+					firstLeft = &node;
+				}
+			}));
+		ASSERT_EQ(enterCount, Depth + 1);
+		ASSERT_EQ(leaveCount, Depth + 1);
+		ASSERT_EQ(firstLeft, leaf.get());
+	}
+
+	TEST(FlexBoxTreeTest, AdditionalProperties)
+	{
+		PropertyMap map;
+		const auto a = AtomTable::Intern(U"data-a");
+		const auto b = AtomTable::Intern(U"data-b");
+		const auto c = AtomTable::Intern(U"data-c");
+
+		ASSERT_TRUE(map.set(a, U"1"));
+		ASSERT_FALSE(map.set(a, U"1"));
+		ASSERT_EQ(map.size(), 1);
+
+		// インライン容量を超えると動的確保した領域へ移る
+		ASSERT_TRUE(map.set(b, U"2"));
+		ASSERT_TRUE(map.set(c, U"3"));
+		ASSERT_TRUE(map.set(a, U"4"));
+		ASSERT_EQ(map.size(), 3);
+		ASSERT_EQ(*map.find(a), U"4");
+		ASSERT_EQ(map.find(AtomTable::Find(U"data-unregistered")), nullptr);
+
+		ASSERT_TRUE(map.erase(b));
+		ASSERT_FALSE(map.erase(b));
+		ASSERT_EQ(map.begin()->first, a);
+		ASSERT_EQ((map.begin() + 1)->first, c);
+
+		map.clear();
+		ASSERT_TRUE(map.isEmpty());
+		ASSERT_TRUE(map.set(b, U"5"));
+		ASSERT_EQ(*map.find(b), U"5");
+
+		// ノードの属性として使用
+		auto node = std::make_shared<FlexBoxNode>();
+		node->setProperty(U"data-a", U"x");
+		ASSERT_EQ(node->getProperty(U"data-a"), U"x");
+		ASSERT_TRUE(node->removeProperty(U"data-a"));
+		ASSERT_FALSE(node->getProperty(U"data-a"));
+		ASSERT_FALSE(node->removeProperty(U"data-unregistered"));
+	}
+
+	TEST(FlexBoxTreeTest, AdditionalPropertiesMemory)
+	{
+		const auto stringBytes = [](const PropertyMap& map)
+			{
+				size_t bytes = 0;
+				for (const auto& [key, value] : map)
+				{
+					bytes += value.capacity() * sizeof(String::value_type);
+				}
+				return bytes;
+			};
+
+		// 10,000ノードのうち半数が追加属性を1つ持つレイアウト
+		auto root = std::make_shared<FlexBoxNode>();
+		for (size_t i = 0; i < 10000; i++)
+		{
+			auto child = std::make_shared<FlexBoxNode>();
+			if (i % 2 == 0)
+			{
+				child->setProperty(U"key", U"{}"_fmt(i));
+			}
+			root->appendChild(child);
+		}
+
+		// 属性が1件以下のノードは、文字列以外の動的確保を行わない
+		for (const auto& [i, child] : Indexed(root->children()))
+		{
+			const auto& properties = child->getAdditionalProperties();
+			ASSERT_EQ(properties.size(), (i % 2 == 0) ? 1 : 0);
+			ASSERT_EQ(properties.allocatedBytes(), stringBytes(properties));
+		}
+		ASSERT_EQ(root->children()[1]->getAdditionalProperties().allocatedBytes(), 0);
+
+		// インライン容量を超えると動的確保する
+		const auto node = root->children()[0];
+		node->setProperty(U"key2", U"x");
+		const auto& properties = node->getAdditionalProperties();
+		ASSERT_GT(properties.allocatedBytes(), stringBytes(properties));
+	}
 }
@@ -197,4 +197,32 @@ namespace FlexLayout::Internal
 			(YGValue{ GetConfig().defaultTextStyle().fontSizePx * 2, YGUnitPoint })
 		);
 	}
+
+	TEST(FlexBoxStyleTest, AsyncFontIsAppliedAfterLoading)
+	{
+		const String fontId = U"FlexBoxStyleTest.AsyncFont";
+		FontAsset::Register(fontId, 20, Typeface::Regular);
+		GetConfig().setAsyncFontLoading(true);
+
+		auto parent = std::make_shared<FlexBoxNode>();
+		auto child = std::make_shared<FlexBoxNode>();
+		parent->setChildren({ child });
+		auto& style = parent->getComponent<Component::StyleComponent>();
+
+		style.setFont(fontId);
+
+		// 読み込みが完了するまではフォントを設定しない
+		ASSERT_EQ(style.pendingFontId(), fontId);
+
+		FontAsset::Wait(fontId);
+		parent->context().getContext<Context::StyleContext>().applyStyles(*parent);
+
+		EXPECT_TRUE(style.pendingFontId().isEmpty());
+		EXPECT_EQ(parent->context().getContext<Context::StyleContext>().pendingFontCount(), 0);
+		EXPECT_EQ(style.computedTextStyle().font, FontAsset{ fontId });
+		EXPECT_EQ(child->getComponent<Component::StyleComponent>().computedTextStyle().font, FontAsset{ fontId });
+
+		GetConfig().setAsyncFontLoading(false);
+		FontAsset::Unregister(fontId);
+	}
 }
@@ -1,6 +1,15 @@
 ﻿#include <gtest/gtest.h>
 #include <Siv3D.hpp>
+#include <yoga/node/Node.h>
 #include "FlexLayout/Layout.hpp"
+#include "FlexLayout/VirtualList.hpp"
+#include "FlexLayout/BoxRef.hpp"
+#include "FlexLayout/BoxRange.hpp"
+#include "FlexLayout/SimpleGUI.hpp"
+#include "FlexLayout/Debugger.hpp"
+#include "FlexLayout/Internal/Accessor.hpp"
+#include "FlexLayout/Internal/NodeComponent/TextComponent.hpp"
+#include "FlexLayout/Internal/ShapingCache.hpp"
 
 namespace FlexLayout
 {
@@ -19,4 +28,964 @@ namespace FlexLayout
 
 		ASSERT_TRUE(called);
 	}
+
+	TEST(LayoutTest, LoadAsyncSupersedesOlderLoad)
+	{
+		const FilePath directory = FileSystem::PathAppend(FileSystem::TemporaryDirectoryPath(), U"FlexLayoutTest");
+		const FilePath first = FileSystem::PathAppend(directory, U"first.xml");
+		const FilePath second = FileSystem::PathAppend(directory, U"second.xml");
+		TextWriter{ first }.write(U"<Layout><Box id=\"first\" /></Layout>");
+		TextWriter{ second }.write(U"<Layout><Box id=\"second\" /></Layout>");
+
+		Layout layout;
+		auto older = layout.loadAsync(first);
+		auto newer = layout.loadAsync(second);
+
+		// 新しい読み込みを開始した時点で、古い読み込みは失敗として完了する
+		ASSERT_EQ(older.wait_for(std::chrono::seconds{ 0 }), std::future_status::ready);
+		ASSERT_FALSE(older.get());
+
+		const Stopwatch timeout{ StartImmediately::Yes };
+		while (newer.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+		{
+			ASSERT_LT(timeout.sF(), 5.0);
+			layout.poll();
+			System::Sleep(1);
+		}
+		ASSERT_TRUE(newer.get());
+
+		ASSERT_TRUE(layout.document()->getElementById(U"second"));
+		ASSERT_FALSE(layout.document()->getElementById(U"first"));
+
+		FileSystem::Remove(directory);
+	}
+
+	TEST(LayoutTest, VirtualListMaterializesVisibleRowsOnly)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<VirtualList id="list" item-count="10000" row-height="20" overscan="2" style="height: 100px">
+					<Box/>
+				</VirtualList>
+			</Layout>
+		)" };
+
+		auto list = layout.document()->getElementById(U"list")->as<VirtualList>();
+		ASSERT_TRUE(list);
+
+		size_t boundRows = 0;
+		(*list)->setRowBinder([&](Box&, size_t) { boundRows++; });
+
+		layout.updateAll(SizeF{ 400, 400 });
+		layout.updateAll(SizeF{ 400, 400 });
+
+		// 5行 + 後方のoverscan 2行
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 0 }, size_t{ 7 }));
+		ASSERT_EQ(list->children().size(), 7 + 2);
+
+		list->setScrollOffset(Vec2{ 0, 1000 });
+		boundRows = 0;
+		layout.updateAll(SizeF{ 400, 400 });
+
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 48 }, size_t{ 57 }));
+		ASSERT_EQ(boundRows, 9);
+	}
+
+	TEST(LayoutTest, VirtualListMeasuresEstimatedRows)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<VirtualList id="list" item-count="10000" estimated-row-height="20" overscan="2" style="height: 100px">
+					<Box style="height: 40px"/>
+				</VirtualList>
+			</Layout>
+		)" };
+
+		auto list = layout.document()->getElementById(U"list")->as<VirtualList>();
+		ASSERT_TRUE(list);
+		ASSERT_TRUE((*list)->isRowHeightEstimated());
+
+		// 1回目は見積もり (20px) で5行 + overscan 2行を生成する
+		layout.updateAll(SizeF{ 400, 400 });
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 0 }, size_t{ 7 }));
+
+		// 計測した高さ (40px) では3行 + overscan 2行
+		layout.updateAll(SizeF{ 400, 400 });
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 0 }, size_t{ 5 }));
+
+		// 先頭7行は40px、以降は20pxとして1000pxの位置は43行目
+		list->setScrollOffset(Vec2{ 0, 1000 });
+		layout.updateAll(SizeF{ 400, 400 });
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 41 }, size_t{ 50 }));
+
+		// 41～49行目を計測すると42行目から表示される
+		layout.updateAll(SizeF{ 400, 400 });
+		ASSERT_EQ((*list)->materializedRange(), std::make_pair(size_t{ 40 }, size_t{ 47 }));
+
+		// 前の更新で設定したスペーサーは計測済みの行の高さを含む (7 * 40 + 33 * 20)
+		layout.updateAll(SizeF{ 400, 400 });
+		ASSERT_EQ(list->children().front().rect()->h, 7 * 40 + 33 * 20);
+	}
+
+	TEST(LayoutTest, InstantiateTemplate)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Template name="card">
+					<Box style="width: 100px; height: 50px">
+						<Label>title</Label>
+					</Box>
+				</Template>
+				<Box id="root" style="flex-direction: column"/>
+			</Layout>
+		)" };
+
+		// テンプレートはルート要素にならない
+		ASSERT_TRUE(layout.document()->getElementById(U"root"));
+		ASSERT_FALSE(layout.instantiate(U"unknown"));
+
+		auto root = *layout.document();
+		auto card1 = root.appendChild(*layout.instantiate(U"card"));
+		auto card2 = root.appendChild(*layout.instantiate(U"card"));
+		ASSERT_EQ(card1.children().size(), 1);
+
+		// 変更は他の複製に影響しない
+		card2.setStyle(U"width", Pixel(200));
+
+		layout.updateAll(SizeF{ 400, 400 });
+
+		ASSERT_EQ(card1.rect()->size, SizeF(100, 50));
+		ASSERT_EQ(card2.rect()->size, SizeF(200, 50));
+		ASSERT_EQ(layout.instantiate(U"card")->getStyle(U"width"), card1.getStyle(U"width"));
+	}
+
+	TEST(LayoutTest, ReconcileChildrenWithDuplicatedKeys)
+	{
+		Layout layout{ Arg::code = U"<Layout><Box><Box key=\"a\" id=\"a1\"/><Box key=\"b\" id=\"b\"/><Box key=\"a\" id=\"a2\"/></Box></Layout>" };
+		auto root = *layout.document();
+
+		size_t created = 0;
+		root.reconcileChildren(
+			{ U"a", U"a", U"b", U"a" },
+			[&](StringView)
+			{
+				created++;
+				return Box{ std::make_shared<Internal::FlexBoxNode>() };
+			});
+
+		// 同じキーの子要素は出現順に再利用され、不足する分のみ生成される
+		ASSERT_EQ(created, 1);
+		const auto children = root.children();
+		ASSERT_EQ(children.size(), 4);
+		ASSERT_EQ(children[0].getAttribute(U"id"), U"a1");
+		ASSERT_EQ(children[1].getAttribute(U"id"), U"a2");
+		ASSERT_EQ(children[2].getAttribute(U"id"), U"b");
+		ASSERT_EQ(children[3].getAttribute(U"id"), none);
+		ASSERT_EQ(children[3].getAttribute(U"key"), U"a");
+	}
+
+	TEST(LayoutTest, BoxRefMirrorsBox)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box id="root" style="padding: 10px">
+					<Box id="child" class="item" style="width: 100px; height: 50px"/>
+				</Box>
+			</Layout>
+		)" };
+		layout.updateAll(SizeF{ 400, 400 });
+
+		const Box root = *layout.document();
+		const Box child = *root.getElementById(U"child");
+
+		static_assert(std::is_trivially_copyable_v<BoxRef>);
+		const BoxRef ref{ child };
+
+		ASSERT_EQ(ref.rect(), child.rect());
+		ASSERT_EQ(ref.padding().left, child.padding().left);
+		ASSERT_EQ(ref.getStyle(U"width"), child.getStyle(U"width"));
+		ASSERT_EQ(ref.getAttribute(U"class"), child.getAttribute(U"class"));
+
+		// ツリーの参照はBoxRefのまま辿れる
+		ASSERT_EQ(ref.parent(), BoxRef{ root });
+		ASSERT_EQ(ref.getRootNode(), BoxRef{ root });
+		ASSERT_EQ(BoxRef{ root }.getElementById(U"child"), ref);
+		ASSERT_TRUE(BoxRef{ root }.contains(ref));
+		ASSERT_FALSE(ref.contains(BoxRef{ root }));
+
+		// lockで所有権を持つBoxに戻せる
+		ASSERT_EQ(BoxRef{ ref.lock() }, ref);
+	}
+
+	TEST(LayoutTest, BoxRangeTraversal)
+	{
+		static_assert(std::ranges::forward_range<ChildBoxRange>);
+		static_assert(std::ranges::common_range<DescendantBoxRange>);
+		static_assert(std::ranges::borrowed_range<AncestorBoxRange>);
+
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box id="root">
+					<Box id="a" class="item">
+						<Label id="a1">a1</Label>
+						<SimpleGUI.Button id="a2" class="item">a2</SimpleGUI.Button>
+					</Box>
+					<Box id="b"/>
+					<Box id="c" class="item">
+						<Label id="c1">c1</Label>
+					</Box>
+				</Box>
+			</Layout>
+		)" };
+
+		Box root = *layout.document();
+
+		const auto ids = [](auto&& range)
+			{
+				Array<String> result;
+				for (BoxRef box : range)
+				{
+					result.push_back(box.getAttribute(U"id").value_or(U""));
+				}
+				return result;
+			};
+
+		ASSERT_EQ(ids(root.childRange()), (Array<String>{ U"a", U"b", U"c" }));
+		ASSERT_EQ(ids(root.descendants()), (Array<String>{ U"a", U"a1", U"a2", U"b", U"c", U"c1" }));
+		ASSERT_EQ(ids(root.descendantsPostOrder()), (Array<String>{ U"a1", U"a2", U"a", U"b", U"c1", U"c" }));
+
+		const Box a2 = *root.getElementById(U"a2");
+		ASSERT_EQ(ids(a2.ancestors()), (Array<String>{ U"a", U"root" }));
+		ASSERT_EQ(ids(root.getElementById(U"b")->siblings()), (Array<String>{ U"a", U"c" }));
+		ASSERT_TRUE(root.siblings().empty());
+
+		// 絞り込み
+		ASSERT_EQ(ids(root.descendants().withClass(U"item")), (Array<String>{ U"a", U"a2", U"c" }));
+		ASSERT_EQ(ids(root.descendants().withTag(U"label")), (Array<String>{ U"a1", U"c1" }));
+		ASSERT_EQ(ids(root.descendants().ofType<SimpleGUI::Button>()), (Array<String>{ U"a2" }));
+		ASSERT_EQ(ids(root.descendants().withTag(U"box").withClass(U"item")), (Array<String>{ U"a", U"c" }));
+
+		// 空文字列や未登録の名前はどの要素にも一致しない
+		ASSERT_TRUE(root.descendants().withTag(U"").empty());
+		ASSERT_TRUE(root.descendants().withClass(U"").empty());
+		ASSERT_TRUE(root.descendants().withClass(U"no-such-class").empty());
+
+		// std::rangesとの組み合わせ
+		ASSERT_EQ(std::ranges::distance(root.descendants()), 6);
+		ASSERT_EQ(ids(root.childRange() | std::views::filter([](BoxRef box) { return box.hasChildNodes(); })), (Array<String>{ U"a", U"c" }));
+
+		// 子要素の変更後も兄弟要素を正しく辿れる
+		root.removeChild(*root.getElementById(U"a"));
+		root.appendChild(root.getElementById(U"b")->cloneNode());
+		ASSERT_EQ(ids(root.childRange()), (Array<String>{ U"b", U"c", U"b" }));
+		ASSERT_EQ(ids(root.descendantsPostOrder()), (Array<String>{ U"b", U"c1", U"c", U"b" }));
+	}
+
+	TEST(LayoutTest, MemoryReport)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box id="root" class="a b" style="width: 100px; padding: 4px" data-key="x">
+					<Label>memory</Label>
+					<SimpleGUI.TextBox id="input"/>
+				</Box>
+			</Layout>
+		)" };
+		layout.updateAll(SizeF{ 400, 400 });
+
+		const auto report = layout.memoryReport();
+
+		// 項目ごとに1行と合計の行
+		const auto lines = report.toString().split(U'\n');
+		ASSERT_EQ(lines.size(), 13);
+		ASSERT_TRUE(lines.front().starts_with(U"nodes"));
+		ASSERT_TRUE(lines.back().starts_with(U"total"));
+		ASSERT_TRUE(lines.back().includes(Format(report.totalBytes())));
+
+		ASSERT_EQ(report.nodes.count, 3);
+		ASSERT_EQ(report.yogaNodes.count, 3);
+		ASSERT_GE(report.yogaNodes.bytes, 3 * sizeof(facebook::yoga::Node));
+		ASSERT_EQ(report.textComponents.count, 1);
+		ASSERT_EQ(report.uiComponents.count, 1);
+		ASSERT_EQ(report.uiStates.count, 1);
+		ASSERT_EQ(report.additionalProperties.count, 1);
+		ASSERT_GT(report.glyphCaches.bytes, 0);
+		ASSERT_GE(report.styleValues.count, 2);
+		ASSERT_GT(report.totalBytes(), report.nodes.bytes);
+
+		// 部分木の集計
+		const auto sub = Debugger::MemoryReport(*layout.document()->getElementById(U"input"));
+		ASSERT_EQ(sub.nodes.count, 1);
+		ASSERT_EQ(sub.uiStates.count, 1);
+
+		// テンプレートの複製はスタイルのテーブルを共有するため、1度だけ計上される
+		Layout templated{ Arg::code = UR"(
+			<Layout>
+				<Template name="row"><Box style="height: 20px"/></Template>
+				<Box id="root"/>
+			</Layout>
+		)" };
+		auto root = *templated.document();
+		for (size_t i = 0; i < 10; i++)
+		{
+			root.appendChild(*templated.instantiate(U"row"));
+		}
+		ASSERT_EQ(templated.memoryReport().styleTables.count, 1);
+	}
+
+	TEST(LayoutTest, LabelGlyphCacheIsCompact)
+	{
+		String labels;
+		size_t charCount = 0;
+		for (size_t i = 0; i < 1000; i++)
+		{
+			const String text = U"label {:0>4}"_fmt(i);
+			labels += U"<Label>{}</Label>"_fmt(text);
+			charCount += text.size();
+		}
+
+		Layout layout{ Arg::code = U"<Layout><Box>{}</Box></Layout>"_fmt(labels) };
+		layout.updateAll(SizeF{ 800, 600 });
+
+		// すべての文字をグリフとして保持している
+		size_t glyphCount = 0;
+		for (const auto label : layout.document()->children())
+		{
+			glyphCount += Internal::Accessor::GetNode(label)->getComponent<Internal::Component::TextComponent>().glyphCount();
+		}
+		ASSERT_EQ(glyphCount, charCount);
+
+		// Array<Glyph>を保持していた場合の見積もりの半分未満
+		const size_t compactBytes = layout.memoryReport().glyphCaches.bytes;
+		const size_t glyphArrayBytes = charCount * sizeof(Glyph);
+		ASSERT_GT(compactBytes, 0);
+		ASSERT_LT(compactBytes * 2, glyphArrayBytes);
+	}
+
+	TEST(LayoutTest, LabelWrapsAtBreakOpportunities)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box style="align-items: flex-start">
+					<Label id="word">aaaa</Label>
+					<Label id="text">aaaa aaaa</Label>
+					<Label id="kana">あ</Label>
+					<Label id="cjk">あいうえお</Label>
+					<Label id="narrow1" style="width: 0px">ab</Label>
+					<Label id="narrow2" style="width: 0px">a b c</Label>
+					<Label id="narrow3" style="width: 0px">あいう</Label>
+					<Label id="narrow4" style="width: 0px">ab</Label>
+				</Box>
+			</Layout>
+		)" };
+		layout.updateAll(SizeF{ 800, 600 });
+
+		auto document = *layout.document();
+		const SizeF word = document.getElementById(U"word")->localContentAreaRect().size;
+		const SizeF kana = document.getElementById(U"kana")->localContentAreaRect().size;
+		auto text = *document.getElementById(U"text");
+		auto cjk = *document.getElementById(U"cjk");
+		document.getElementById(U"narrow4")->setTextContent(U"ab\n\nc");
+
+		ASSERT_DOUBLE_EQ(text.localContentAreaRect().h, word.y);
+
+		// 単語の途中ではなく空白の位置で改行する
+		text.setStyle(U"max-width", Pixel(static_cast<float>(word.x * 1.5)));
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_DOUBLE_EQ(text.localContentAreaRect().h, word.y * 2);
+		ASSERT_NEAR(text.localContentAreaRect().w, word.x, 0.5);
+
+		// 空白を含まない単語が収まらない場合はグリフ単位で改行する
+		text.setStyle(U"max-width", Pixel(static_cast<float>(word.x * 0.6)));
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_GE(text.localContentAreaRect().h, word.y * 4);
+
+		// かな・漢字は文字の間で改行できる
+		cjk.setStyle(U"max-width", Pixel(static_cast<float>(kana.x * 2.5)));
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_DOUBLE_EQ(cjk.localContentAreaRect().h, kana.y * 3);
+
+		// 幅を広げると1行に戻る
+		cjk.setStyle(U"max-width", Pixel(800));
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_DOUBLE_EQ(cjk.localContentAreaRect().h, kana.y);
+
+		// 幅が0の場合は1グリフずつ改行し、空の行を追加しない (空の段落を除く)
+		ASSERT_DOUBLE_EQ(document.getElementById(U"narrow1")->localContentAreaRect().h, kana.y * 2);
+		ASSERT_DOUBLE_EQ(document.getElementById(U"narrow2")->localContentAreaRect().h, kana.y * 3);
+		ASSERT_DOUBLE_EQ(document.getElementById(U"narrow3")->localContentAreaRect().h, kana.y * 3);
+		ASSERT_DOUBLE_EQ(document.getElementById(U"narrow4")->localContentAreaRect().h, kana.y * 4);
+	}
+
+	TEST(LayoutTest, LabelTextOverflow)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box style="align-items: flex-start">
+					<Label id="line">aaaa</Label>
+					<Label id="clamped" style="width: 40px; max-lines: 2">aaaa aaaa aaaa aaaa aaaa aaaa</Label>
+					<Label id="nowrap" style="max-width: 40px; white-space: nowrap">aaaa aaaa aaaa</Label>
+					<Label id="ellipsis" style="max-width: 40px; white-space: nowrap; text-overflow: ellipsis">aaaa aaaa aaaa</Label>
+					<Box style="width: 40px; white-space: nowrap; max-lines: 3">
+						<Label id="inherited">aaaa aaaa aaaa</Label>
+					</Box>
+				</Box>
+			</Layout>
+		)" };
+		layout.updateAll(SizeF{ 800, 600 });
+
+		auto document = *layout.document();
+		const double lineHeight = document.getElementById(U"line")->localContentAreaRect().h;
+		const auto height = [&](StringView id) { return document.getElementById(id)->localContentAreaRect().h; };
+
+		// max-linesを超える行は計算されない
+		ASSERT_DOUBLE_EQ(height(U"clamped"), lineHeight * 2);
+
+		// nowrapでは折り返さない
+		ASSERT_DOUBLE_EQ(height(U"nowrap"), lineHeight);
+		ASSERT_DOUBLE_EQ(height(U"ellipsis"), lineHeight);
+		ASSERT_LE(document.getElementById(U"ellipsis")->localContentAreaRect().w, 40.0);
+
+		// white-spaceは継承される
+		ASSERT_DOUBLE_EQ(height(U"inherited"), lineHeight);
+
+		// 制限を解除すると再計算される
+		auto clamped = *document.getElementById(U"clamped");
+		clamped.setStyle(U"max-lines", StyleValue::None());
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_GT(clamped.localContentAreaRect().h, lineHeight * 2);
+	}
+
+	TEST(LayoutTest, NowrapClampedLabelShapesVisibleLinesOnly)
+	{
+		Layout layout{ Arg::code = UR"(
+			<Layout>
+				<Box style="align-items: flex-start">
+					<Label id="label" style="white-space: nowrap; max-lines: 2; text-overflow: ellipsis"/>
+				</Box>
+			</Layout>
+		)" };
+
+		auto label = *layout.document()->getElementById(U"label");
+		label.setTextContent(U"abc\ndef\n" + String(1000, U'x'));
+		layout.updateAll(SizeF{ 800, 600 });
+
+		const auto& text = Internal::Accessor::GetNode(label)->getComponent<Internal::Component::TextComponent>();
+
+		// 2番目の改行文字までのみシェーピングする
+		ASSERT_EQ(text.glyphCount(), 8);
+		ASSERT_EQ(text.lineCount(), 2);
+		ASSERT_TRUE(text.isTruncated());
+
+		// 制限を解除するとすべてシェーピングされる
+		label.setStyle(U"max-lines", StyleValue::None());
+		layout.updateAll(SizeF{ 800, 600 });
+		ASSERT_EQ(text.glyphCount(), 1008);
+		ASSERT_EQ(text.lineCount(), 3);
+		ASSERT_FALSE(text.isTruncated());
+	}
+
+	TEST(LayoutTest, LabelsShareShapingResults)
+	{
+		String labels;
+		for (size_t i = 0; i < 100; i++)
+		{
+			labels += U"<Label>OK</Label><Label>Cancel</Label>";
+		}
+
+		Debugger::ResetShapingCacheStats();
+
+		Layout layout{ Arg::code = U"<Layout><Box>{}</Box></Layout>"_fmt(labels) };
+		layout.updateAll(SizeF{ 800, 600 });
+
+		const auto stats = Debugger::GetShapingCacheStats();
+
+		// 文字列ごとに1度だけシェーピングされる
+		ASSERT_LE(stats.misses, 2);
+		ASSERT_GE(stats.hits, 198);
+		ASSERT_GE(stats.entries, 2);
+
+		// 同じ文字列のラベルは同じ結果を参照する
+		const auto shapedText = [](const Box& label)
+			{
+				return Internal::Accessor::GetNode(label)->getComponent<Internal::Component::TextComponent>().shapedText().get();
+			};
+		const auto labelBoxes = layout.document()->children();
+		ASSERT_NE(shapedText(labelBoxes[0]), nullptr);
+		ASSERT_NE(shapedText(labelBoxes[0]), shapedText(labelBoxes[1]));
+		for (size_t i = 2; i < labelBoxes.size(); i++)
+		{
+			ASSERT_EQ(shapedText(labelBoxes[i]), shapedText(labelBoxes[i % 2]));
+		}
+	}
+
+	TEST(LayoutTest, CalculateLayoutParallel)
+	{
+		const auto code = UR"(
+			<Layout>
+				<Box id="root" style="flex-direction: row; flex-wrap: wrap; padding: 1em">
+					<Label id="label">The quick brown fox jumps over the lazy dog</Label>
+					<Box id="box" style="width: 30%; height: 3em"/>
+				</Box>
+			</Layout>
+		)";
+
+		Array<std::unique_ptr<Layout>> sequential, parallel;
+		for (size_t i = 0; i < 20; i++)
+		{
+			const SizeF size{ 100 + i * 20, 400 };
+
+			sequential.push_back(std::make_unique<Layout>(Arg::code = code));
+			sequential.back()->updateAll(size);
+
+			parallel.push_back(std::make_unique<Layout>(Arg::code = code));
+			parallel.back()->setConstraints(size);
+		}
+
+		size_t jobCount = 0;
+		Layout::SetParallelExecutor([&](size_t count, const std::function<void(size_t)>& job)
+			{
+				jobCount = count;
+				Array<std::thread> threads;
+				for (size_t i = 0; i < count; i++)
+				{
+					threads.emplace_back(job, i);
+				}
+				for (auto& thread : threads)
+				{
+					thread.join();
+				}
+			});
+
+		Array<Layout*> targets = parallel.map([](const auto& layout) { return layout.get(); });
+		targets.push_back(nullptr);
+		Layout::CalculateLayoutParallel(targets);
+
+		Layout::SetParallelExecutor(nullptr);
+		ASSERT_EQ(jobCount, 20);
+
+		for (size_t i = 0; i < 20; i++)
+		{
+			for (const auto id : { U"root", U"label", U"box" })
+			{
+				ASSERT_EQ(
+					sequential[i]->document()->getElementById(id)->rect(),
+					parallel[i]->document()->getElementById(id)->rect());
+			}
+		}
+
+		// 既定のワーカースレッドでも同じ結果になる
+		for (auto& layout : parallel)
+		{
+			layout->setConstraints(SizeF{ 200, 400 });
+		}
+		Layout::CalculateLayoutParallel(targets);
+		ASSERT_EQ(
+			parallel[0]->document()->getElementById(U"label")->rect(),
+			parallel[5]->document()->getElementById(U"label")->rect());
+	}
+
+	TEST(LayoutTest, CalculateLayoutParallelShapesText)
+	{
+		// レイアウトごとに異なる文字列にして、シェーピングを並列に行わせる
+		const auto makeCode = [](size_t index)
+			{
+				String labels;
+				for (size_t i = 0; i < 10; i++)
+				{
+					labels += U"<Label id=\"label{0}\">Layout {1} label {0}: 吾輩は猫である。名前はまだ無い。</Label>"_fmt(i, index);
+				}
+				return U"<Layout><Box style=\"flex-direction: column; padding: 1em\">{}</Box></Layout>"_fmt(labels);
+			};
+
+		Array<std::unique_ptr<Layout>> sequential, parallel;
+		for (size_t i = 0; i < 8; i++)
+		{
+			sequential.push_back(std::make_unique<Layout>(Arg::code = makeCode(i)));
+			sequential.back()->updateAll(SizeF{ 200, 800 });
+		}
+
+		Internal::ShapingCache::Clear();
+		Debugger::ResetShapingCacheStats();
+
+		for (size_t i = 0; i < 8; i++)
+		{
+			parallel.push_back(std::make_unique<Layout>(Arg::code = makeCode(i)));
+			parallel.back()->setConstraints(SizeF{ 200, 800 });
+		}
+
+		Layout::SetParallelExecutor([&](size_t count, const std::function<void(size_t)>& job)
+			{
+				Array<std::thread> threads;
+				for (size_t i = 0; i < count; i++)
+				{
+					threads.emplace_back(job, i);
+				}
+				for (auto& thread : threads)
+				{
+					thread.join();
+				}
+			});
+
+		const Array<Layout*> targets = parallel.map([](const auto& layout) { return layout.get(); });
+		Layout::CalculateLayoutParallel(targets);
+
+		Layout::SetParallelExecutor(nullptr);
+
+		// すべてのラベルがワーカースレッドでシェーピングされる
+		ASSERT_GE(Debugger::GetShapingCacheStats().misses, 80);
+
+		for (size_t i = 0; i < 8; i++)
+		{
+			for (size_t j = 0; j < 10; j++)
+			{
+				const auto id = U"label{}"_fmt(j);
+				ASSERT_EQ(
+					sequential[i]->document()->getElementById(id)->rect(),
+					parallel[i]->document()->getElementById(id)->rect());
+			}
+		}
+	}
+
+	TEST(LayoutTest, ParallelSubtreeLayout)
+	{
+		// 大きさの固定されたパネルを並べたダッシュボード
+		String panels;
+		for (size_t i = 0; i < 8; i++)
+		{
+			String rows;
+			for (size_t j = 0; j < 20; j++)
+			{
+				rows += U"<Box style=\"flex-direction: row; justify-content: space-between\"><Label>Item {}-{}</Label><Label>{}</Label></Box>"_fmt(i, j, i * j);
+			}
+			panels += U"<Box id=\"panel{}\" style=\"width: 300px; height: 400px; flex-shrink: 0; padding: 8px; flex-wrap: wrap\">{}</Box>"_fmt(i, rows);
+		}
+		const String code = U"<Layout><Box id=\"root\" style=\"flex-direction: row; flex-wrap: wrap; gap: 8px\">{}</Box></Layout>"_fmt(panels);
+
+		Layout sequential{ Arg::code = code };
+		Layout parallel{ Arg::code = code };
+		parallel.setParallelSubtreeLayout(true);
+		ASSERT_TRUE(parallel.isParallelSubtreeLayoutEnabled());
+
+		ASSERT_TRUE(Internal::IsLayoutBoundary(*Internal::Accessor::GetNode(*parallel.document()->getElementById(U"panel0"))));
+		ASSERT_FALSE(Internal::IsLayoutBoundary(*Internal::Accessor::GetNode(*parallel.document())));
+
+		size_t jobCount = 0;
+		Layout::SetParallelExecutor([&](size_t count, const std::function<void(size_t)>& job)
+			{
+				jobCount += count;
+				for (size_t i = 0; i < count; i++)
+				{
+					job(i);
+				}
+			});
+
+		for (auto* layout : { &sequential, &parallel })
+		{
+			layout->setConstraints(SizeF{ 1280, 1000 });
+			layout->calculateLayout();
+		}
+
+		Layout::SetParallelExecutor(nullptr);
+
+		// パネルごとに1つのジョブとして計算される
+		ASSERT_EQ(jobCount, 8);
+
+		// 並列に計算しても結果は変わらない
+		const auto sequentialRoot = *sequential.document();
+		const auto parallelRoot = *parallel.document();
+		const auto sequentialBoxes = Array<BoxRef>(sequentialRoot.descendants().begin(), sequentialRoot.descendants().end());
+		const auto parallelBoxes = Array<BoxRef>(parallelRoot.descendants().begin(), parallelRoot.descendants().end());
+		ASSERT_EQ(sequentialBoxes.size(), parallelBoxes.size());
+		for (size_t i = 0; i < sequentialBoxes.size(); i++)
+		{
+			ASSERT_EQ(sequentialBoxes[i].rect(), parallelBoxes[i].rect());
+		}
+	}
+
+	TEST(LayoutTest, ParallelSubtreeLayoutRightToLeft)
+	{
+		// 部分木は親要素から継承した方向 (rtl) で計算する
+		String panels;
+		for (size_t i = 0; i < 4; i++)
+		{
+			String rows;
+			for (size_t j = 0; j < 20; j++)
+			{
+				rows += U"<Box style=\"flex-direction: row; width: 100px; height: 10px\"><Box style=\"width: 10px; height: 10px\"/></Box>";
+			}
+			panels += U"<Box style=\"width: 300px; height: 400px; flex-shrink: 0\">{}</Box>"_fmt(rows);
+		}
+		const String code = U"<Layout><Box style=\"direction: rtl; flex-direction: row\">{}</Box></Layout>"_fmt(panels);
+
+		Layout sequential{ Arg::code = code };
+		Layout parallel{ Arg::code = code };
+		parallel.setParallelSubtreeLayout(true);
+
+		size_t jobCount = 0;
+		Layout::SetParallelExecutor([&](size_t count, const std::function<void(size_t)>& job)
+			{
+				jobCount += count;
+				for (size_t i = 0; i < count; i++)
+				{
+					job(i);
+				}
+			});
+
+		for (auto* layout : { &sequential, &parallel })
+		{
+			layout->setConstraints(SizeF{ 1280, 1000 });
+			layout->calculateLayout();
+		}
+
+		Layout::SetParallelExecutor(nullptr);
+		ASSERT_EQ(jobCount, 4);
+
+		const auto sequentialRoot = *sequential.document();
+		const auto parallelRoot = *parallel.document();
+		const auto sequentialBoxes = Array<BoxRef>(sequentialRoot.descendants().begin(), sequentialRoot.descendants().end());
+		const auto parallelBoxes = Array<BoxRef>(parallelRoot.descendants().begin(), parallelRoot.descendants().end());
+		ASSERT_EQ(sequentialBoxes.size(), parallelBoxes.size());
+		for (size_t i = 0; i < sequentialBoxes.size(); i++)
+		{
+			ASSERT_EQ(sequentialBoxes[i].rect(), parallelBoxes[i].rect());
+		}
+
+		// 右から左に配置される
+		const auto firstRow = parallelRoot.children()[0].children()[0];
+		ASSERT_EQ(firstRow.children()[0].rect()->rightX(), firstRow.rect()->rightX());
+	}
+
+	TEST(LayoutTest, PipelinedLayout)
+	{
+		const String code = U"<Layout><Box id=\"root\" style=\"flex-direction: row\"><Box id=\"a\" style=\"width: 100px; height: 50px\" /><Label id=\"label\">Hello</Label></Box></Layout>";
+
+		Layout sequential{ Arg::code = code };
+		sequential.setConstraints(SizeF{ 400, 300 });
+		sequential.calculateLayout();
+
+		Layout pipelined{ Arg::code = code };
+		pipelined.setPipelinedLayout(true);
+		ASSERT_TRUE(pipelined.isPipelinedLayoutEnabled());
+		pipelined.setConstraints(SizeF{ 400, 300 });
+
+		// 最初の確定までは矩形を取得できない
+		pipelined.calculateLayoutAsync();
+		auto a = *pipelined.document()->getElementById(U"a");
+		ASSERT_EQ(a.rect(), none);
+
+		ASSERT_TRUE(pipelined.commitLayout());
+		ASSERT_FALSE(pipelined.commitLayout());
+
+		for (const auto& id : { U"root", U"a", U"label" })
+		{
+			ASSERT_EQ(sequential.document()->getElementById(id)->rect(), pipelined.document()->getElementById(id)->rect());
+		}
+
+		// 計算中は確定済みの結果を参照する
+		a.setStyle(U"width", Pixel(200));
+		pipelined.calculateLayoutAsync();
+		ASSERT_EQ(a.rect()->w, 100);
+
+		pipelined.commitLayout();
+		ASSERT_EQ(a.rect()->w, 200);
+
+		// 計算中に要素を変更すると、計算の完了を待って結果を確定してから変更する
+		pipelined.calculateLayoutAsync();
+		a.setStyle(U"width", Pixel(300));
+		ASSERT_FALSE(pipelined.commitLayout());
+		ASSERT_EQ(a.rect()->w, 200);
+		pipelined.calculateLayout();
+		ASSERT_EQ(a.rect()->w, 300);
+
+		// 無効にすると最新の計算結果を参照する
+		a.setStyle(U"width", Pixel(150));
+		pipelined.setPipelinedLayout(false);
+		pipelined.calculateLayout();
+		ASSERT_EQ(a.rect()->w, 150);
+	}
+
+	TEST(LayoutTest, ParallelLayoutDuringPipelinedLayout)
+	{
+		// 部分木を並列に計算するダッシュボード
+		String panels;
+		for (size_t i = 0; i < 4; i++)
+		{
+			String rows;
+			for (size_t j = 0; j < 20; j++)
+			{
+				rows += U"<Box style=\"flex-direction: row\"><Label>Item {}-{}</Label></Box>"_fmt(i, j);
+			}
+			panels += U"<Box id=\"panel{}\" style=\"width: 300px; height: 400px; flex-shrink: 0; padding: 8px\">{}</Box>"_fmt(i, rows);
+		}
+		const String code = U"<Layout><Box style=\"flex-direction: row; flex-wrap: wrap\">{}</Box></Layout>"_fmt(panels);
+
+		Layout sequential{ Arg::code = code };
+		sequential.setConstraints(SizeF{ 1280, 1000 });
+		sequential.calculateLayout();
+
+		Layout pipelined{ Arg::code = code };
+		pipelined.setPipelinedLayout(true);
+
+		Layout other{ Arg::code = code };
+
+		for (auto* layout : { &pipelined, &other })
+		{
+			layout->setParallelSubtreeLayout(true);
+			layout->setConstraints(SizeF{ 1280, 1000 });
+		}
+
+		// 既定のワーカースレッドを使用する
+		Layout::SetParallelExecutor(nullptr);
+
+		// パイプライン化したレイアウトの計算中 (部分木の並列計算を含む) に、そのレイアウトを含めて並列に計算する
+		// ワーカーの処理がパイプラインの完了を待ち、パイプラインの計算がワーカーを待つ状況でも完了する
+		const std::array<Layout*, 2> targets{ &pipelined, &other };
+		for (size_t i = 0; i < 20; i++)
+		{
+			for (auto* layout : targets)
+			{
+				layout->document()->getElementById(U"panel{}"_fmt(i % 4))->setStyle(U"padding", Pixel(static_cast<float>(8 + i % 2)));
+			}
+
+			pipelined.calculateLayoutAsync();
+			Layout::CalculateLayoutParallel(targets);
+		}
+
+		// 変更を戻して結果を比較する
+		for (auto* layout : targets)
+		{
+			for (size_t i = 0; i < 4; i++)
+			{
+				layout->document()->getElementById(U"panel{}"_fmt(i))->setStyle(U"padding", Pixel(8));
+			}
+			layout->calculateLayout();
+		}
+
+		const auto sequentialRoot = *sequential.document();
+		for (auto* layout : targets)
+		{
+			const auto root = *layout->document();
+			const auto expected = Array<BoxRef>(sequentialRoot.descendants().begin(), sequentialRoot.descendants().end());
+			const auto actual = Array<BoxRef>(root.descendants().begin(), root.descendants().end());
+			ASSERT_EQ(expected.size(), actual.size());
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				ASSERT_EQ(expected[i].rect(), actual[i].rect());
+			}
+		}
+	}
+
+	TEST(LayoutTest, Snapshot)
+	{
+		Layout layout{ Arg::code = U"<Layout><Box style=\"padding: 4px; border: 2px\"><Box style=\"width: 100px; height: 50px; margin: 8px\" /><Box style=\"overflow: scroll; height: 20px\"><Label>Hello</Label></Box><Box style=\"display: none\"><Box /></Box></Box></Layout>" };
+		layout.setConstraints(SizeF{ 400, 300 });
+		layout.calculateLayout();
+
+		const auto root = *layout.document();
+		const auto boxes = Array<BoxRef>(root.descendants().begin(), root.descendants().end());
+
+		const auto equals = [](const Thickness& lhs, const Thickness& rhs)
+			{
+				return lhs.top == rhs.top && lhs.right == rhs.right && lhs.bottom == rhs.bottom && lhs.left == rhs.left;
+			};
+
+		const LayoutSnapshot& snapshot = layout.snapshot();
+		ASSERT_EQ(snapshot.size(), boxes.size() + 1);
+		ASSERT_EQ(snapshot.boxes[0], BoxRef{ root });
+		ASSERT_EQ(snapshot.parentIndices[0], LayoutSnapshot::NoParent);
+
+		// 要素ごとに取得した値と一致する
+		for (size_t i = 0; i < snapshot.size(); i++)
+		{
+			const BoxRef box = snapshot.boxes[i];
+			if (i > 0)
+			{
+				ASSERT_EQ(box, boxes[i - 1]);
+				ASSERT_LT(snapshot.parentIndices[i], i);
+				ASSERT_EQ(snapshot.boxes[snapshot.parentIndices[i]], *box.parent());
+			}
+
+			ASSERT_EQ(snapshot.hasLayout(i), box.rect().has_value());
+			if (snapshot.hasLayout(i))
+			{
+				ASSERT_EQ(snapshot.borderRects[i], *box.rect());
+				ASSERT_EQ(snapshot.offsets[i], *box.offset());
+			}
+			ASSERT_TRUE(equals(snapshot.margins[i], box.margin()));
+			ASSERT_TRUE(equals(snapshot.borders[i], box.border()));
+			ASSERT_TRUE(equals(snapshot.paddings[i], box.padding()));
+		}
+
+		ASSERT_TRUE(snapshot.flags[2] & LayoutSnapshot::Flags::ScrollContainer);
+		ASSERT_EQ(snapshot.marginRect(1), RectF(6, 6, 116, 66));
+		ASSERT_EQ(snapshot.contentRect(0), snapshot.paddingRect(0).stretched(-4));
+
+		// パイプライン化した場合は確定済みの結果を返す
+		layout.setPipelinedLayout(true);
+		ASSERT_TRUE(layout.snapshot().empty());
+		layout.calculateLayoutAsync();
+		layout.commitLayout();
+		ASSERT_EQ(layout.snapshot().size(), boxes.size() + 1);
+		ASSERT_EQ(layout.snapshot().borderRects[1], RectF(14, 14, 100, 50));
+	}
+
+	TEST(LayoutTest, DeferredDestruction)
+	{
+		String items;
+		for (size_t i = 0; i < 100; i++)
+		{
+			items += U"<Box/>";
+		}
+
+		Layout layout{ Arg::code = U"<Layout><Box><Box id=\"menu\">{}</Box></Box></Layout>"_fmt(items) };
+		layout.setDeferredDestruction(SecondsF{ 0 });
+
+		layout.document()->removeChildren();
+		ASSERT_EQ(layout.pendingDestructionCount(), 1);
+
+		// 時間の範囲を超えた時点で解放を中断する
+		layout.updateUI();
+		ASSERT_GT(layout.pendingDestructionCount(), 0);
+		ASSERT_LT(layout.pendingDestructionCount(), 100);
+
+		// 無効にすると残りをすべて解放する
+		layout.setDeferredDestruction(none);
+		ASSERT_EQ(layout.pendingDestructionCount(), 0);
+	}
+
+	TEST(LayoutTest, DeferredDestructionDetachesHeldSubtree)
+	{
+		Layout layout{ Arg::code = U"<Layout><Box><Box id=\"menu\"><Box><Box id=\"item\" /></Box></Box><Box id=\"other\" /></Box></Layout>" };
+		layout.setDeferredDestruction(SecondsF{ 1.0 });
+		layout.updateAll(SizeF{ 400, 300 });
+
+		auto root = *layout.document();
+		auto menu = *root.getElementById(U"menu");
+		const auto item = *root.getElementById(U"item");
+		ASSERT_TRUE(item.rect());
+
+		// 切り離した要素自体は直ちにレイアウトを失い、子孫は解放待ちリストの処理で切り離される
+		root.removeChild(menu);
+		ASSERT_FALSE(menu.rect());
+
+		// 解放待ちの子孫も直ちに元のツリーのコンテキストから外れる
+		const Internal::FlexBoxNode& itemNode = *Internal::Accessor::GetNode(item);
+		ASSERT_EQ(itemNode.context(), nullptr);
+
+		layout.updateUI();
+		ASSERT_EQ(layout.pendingDestructionCount(), 0);
+		ASSERT_FALSE(item.rect());
+		ASSERT_FALSE(root.getElementById(U"item"));
+
+		// 解放待ちの間にツリーへ戻された要素は切り離さない
+		root.appendChild(menu);
+		layout.updateAll(SizeF{ 400, 300 });
+		ASSERT_TRUE(item.rect());
+		root.removeChild(menu);
+		root.getElementById(U"other")->appendChild(menu);
+		layout.updateAll(SizeF{ 400, 300 });
+		ASSERT_EQ(layout.pendingDestructionCount(), 0);
+		ASSERT_TRUE(item.rect());
+	}
 }
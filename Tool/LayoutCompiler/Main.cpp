@@ -0,0 +1,69 @@
+﻿#include <cstdlib>
+#include <Siv3D.hpp>
+#include "FlexLayout/Layout.hpp"
+
+////////////////////////////////////////////////////
+//
+// レイアウトファイル(XML)をバイナリ形式へ変換するコマンドラインツール
+//
+// 使い方:
+//   LayoutCompiler <input.xml> [<input2.xml> ...]   各ファイルと同じ場所に.flbを出力
+//   LayoutCompiler <input.xml> -o <output.flb>      出力先を指定
+//
+// LayoutCompiler.vcxproj (FlexLayout.slnに含まれています) でビルドできます
+// CSSの解析にライブラリ本体 (Siv3D) を使用するため、Linux用のビルド設定は用意していません
+// 出力したファイルは`FlexLayout::Layout::load()`で読み込めます
+// 変換に失敗したファイルがある場合は終了コード1で終了します
+//
+////////////////////////////////////////////////////
+
+SIV3D_SET(EngineOption::Renderer::Headless)
+
+void Main()
+{
+	const auto& args = System::GetCommandLineArgs();
+
+	Array<std::pair<FilePath, FilePath>> jobs;
+
+	if (args.size() == 4 && args[2] == U"-o")
+	{
+		jobs.emplace_back(args[1], args[3]);
+	}
+	else
+	{
+		for (size_t i = 1; i < args.size(); i++)
+		{
+			const FilePath& input = args[i];
+			jobs.emplace_back(input, FileSystem::PathAppend(FileSystem::ParentPath(input), FileSystem::BaseName(input) + U".flb"));
+		}
+	}
+
+	if (jobs.isEmpty())
+	{
+		Console << U"Usage: LayoutCompiler <input.xml> [<input2.xml> ...]";
+		Console << U"       LayoutCompiler <input.xml> -o <output.flb>";
+		std::exit(EXIT_FAILURE);
+	}
+
+	size_t failed = 0;
+	for (const auto& [input, output] : jobs)
+	{
+		if (FlexLayout::Layout::Compile(input, output))
+		{
+			Console << U"{} -> {}"_fmt(input, output);
+		}
+		else
+		{
+			Console << U"Failed to compile: {}"_fmt(input);
+			failed++;
+		}
+	}
+
+	if (failed)
+	{
+		Console << U"{} file(s) failed"_fmt(failed);
+
+		// Main()の戻り値は終了コードに反映されないため、ここで終了する
+		std::exit(EXIT_FAILURE);
+	}
+}